@@ -1,13 +1,31 @@
 import { resolve } from 'path'
-import { defineConfig, externalizeDepsPlugin } from 'electron-vite'
+import { defineConfig, externalizeDepsPlugin, bytecodePlugin } from 'electron-vite'
 import react from '@vitejs/plugin-react'
 
 export default defineConfig({
   main: {
-    plugins: [externalizeDepsPlugin()]
+    // Ship main/preload as V8 bytecode so startup skips parsing and compiling them
+    plugins: [externalizeDepsPlugin(), bytecodePlugin()],
+    build: {
+      rollupOptions: {
+        input: {
+          index: resolve('src/main/index.ts'),
+          // Audio pipeline utility process entry (see src/main/pipeline.ts)
+          'pipeline-worker': resolve('src/main/pipeline-worker.ts'),
+          // Shared per-user transcription service (see src/main/engine-service.ts)
+          'engine-service': resolve('src/main/engine-service.ts'),
+          // Worker thread hosting one post-processing plugin (see src/main/postprocess.ts)
+          'plugin-host': resolve('src/main/plugin-host.ts'),
+          // Load generator for the daemon/engine protocol, not packaged (see src/main/engine-loadtest.ts)
+          'engine-loadtest': resolve('src/main/engine-loadtest.ts'),
+          // Wake phrase false-accept/false-reject benchmark, not packaged (see src/main/kws-bench.ts)
+          'kws-bench': resolve('src/main/kws-bench.ts')
+        }
+      }
+    }
   },
   preload: {
-    plugins: [externalizeDepsPlugin()]
+    plugins: [externalizeDepsPlugin(), bytecodePlugin()]
   },
   renderer: {
     resolve: {
@@ -15,6 +33,16 @@ export default defineConfig({
         '@renderer': resolve('src/renderer/src')
       }
     },
-    plugins: [react()]
+    plugins: [react()],
+    build: {
+      rollupOptions: {
+        input: {
+          // Settings, examples (lazy-loaded views)
+          index: resolve('src/renderer/index.html'),
+          // The resident flow pill, kept to what it shows (see src/renderer/src/FlowPill.tsx)
+          pill: resolve('src/renderer/pill.html')
+        }
+      }
+    }
   }
 })
@@ -0,0 +1,60 @@
+# Native audio/IO module for the Linux build (see src/main/native.ts for the JS facade)
+# Each system library is optional: features whose library is missing at build time
+# are compiled out and reported as unavailable by capabilities()
+{
+  "variables": {
+    "has_pulse%": "<!(pkg-config --exists libpulse-simple 2>/dev/null && echo 1 || echo 0)",
+    "has_alsa%": "<!(pkg-config --exists alsa 2>/dev/null && echo 1 || echo 0)",
+    "has_opus%": "<!(pkg-config --exists opus 2>/dev/null && echo 1 || echo 0)",
+    "has_xtest%": "<!(pkg-config --exists x11 xtst 2>/dev/null && echo 1 || echo 0)"
+  },
+  "targets": [
+    {
+      "target_name": "cloudkit",
+      "sources": [
+        "src/addon.cc",
+        "src/capture.cc",
+        "src/inject.cc",
+        "src/kws.cc",
+        "src/resampler.cc",
+        "src/shm.cc",
+        "src/webm_opus.cc"
+      ],
+      "include_dirs": ["<!(node -p \"require('node-addon-api').include_dir\")"],
+      "defines": ["NAPI_VERSION=8", "NAPI_CPP_EXCEPTIONS"],
+      "cflags!": ["-fno-exceptions"],
+      "cflags_cc!": ["-fno-exceptions"],
+      "cflags_cc": ["-std=c++17", "-O2"],
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17"
+      },
+      "conditions": [
+        ["OS=='linux'", {
+          "libraries": ["-lrt"]
+        }],
+        ["OS=='linux' and has_pulse==1", {
+          "defines": ["CLOUDKIT_HAVE_PULSE"],
+          "cflags": ["<!@(pkg-config --cflags libpulse-simple)"],
+          "libraries": ["<!@(pkg-config --libs libpulse-simple)"]
+        }],
+        ["OS=='linux' and has_alsa==1", {
+          "defines": ["CLOUDKIT_HAVE_ALSA"],
+          "cflags": ["<!@(pkg-config --cflags alsa)"],
+          "libraries": ["<!@(pkg-config --libs alsa)"]
+        }],
+        ["OS=='linux' and has_xtest==1", {
+          "defines": ["CLOUDKIT_HAVE_XTEST"],
+          "cflags": ["<!@(pkg-config --cflags x11 xtst)"],
+          "libraries": ["<!@(pkg-config --libs x11 xtst)"]
+        }],
+        ["has_opus==1", {
+          "defines": ["CLOUDKIT_HAVE_OPUS"],
+          "cflags": ["<!@(pkg-config --cflags opus)"],
+          "xcode_settings": { "OTHER_CFLAGS": ["<!@(pkg-config --cflags opus)"] },
+          "libraries": ["<!@(pkg-config --libs opus)"]
+        }]
+      ]
+    }
+  ]
+}
@@ -0,0 +1,539 @@
+// N-API entry point - thin bindings over capture, keyword spotting, decode, resample,
+// inject and shared memory
+// The JS facade (src/main/native.ts) is the only caller
+
+#include <napi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <thread>
+
+#include "capture.h"
+#include "inject.h"
+#include "kws.h"
+#include "resampler.h"
+#include "shm.h"
+#include "webm_opus.h"
+
+namespace {
+
+using cloudkit::CaptureOptions;
+using cloudkit::CaptureSource;
+using cloudkit::KeywordModel;
+using cloudkit::KeywordOptions;
+using cloudkit::KeywordSpotter;
+using cloudkit::SharedRegion;
+
+// One chunk handed from the capture thread to JS
+struct CaptureChunk {
+  std::vector<int16_t> samples;
+  std::string error;  // Set on the final chunk when the source fails
+  uint64_t sequence = 0;  // Gaps mean chunks were dropped on the way to JS
+  double elapsedMs = 0;    // When the read completed, since capture start (steady clock)
+  uint64_t overruns = 0;  // Device overruns so far
+  float keywordScore = -1;  // >= 0: not audio, the keyword fired with this score
+  uint64_t generation = 0;  // Session that produced it; stale chunks are dropped
+};
+
+// Audio kept while listening, so a dictation started by the keyword can include the
+// moments before it was recognised
+constexpr int kMaxPrerollMs = 2000;
+
+void DeliverChunk(Napi::Env env, Napi::Function onData, CaptureChunk* chunk);
+
+// Single capture session - dictation never records from two sources at once
+// With a keyword model the session starts out listening: audio stays on the capture
+// thread (spotter and pre-roll history) until resumeCapture switches it to delivery,
+// and pauseCapture switches it back without reopening the device
+struct CaptureSession {
+  std::unique_ptr<CaptureSource> source;
+  std::thread thread;
+  std::atomic<bool> running{false};
+  Napi::ThreadSafeFunction tsfn;
+  Napi::FunctionReference onError;
+  Napi::FunctionReference onKeyword;
+
+  std::unique_ptr<KeywordSpotter> spotter;
+  std::atomic<int> resumePrerollMs{-1};  // Pending resumeCapture, read by the capture thread
+  std::atomic<bool> pauseRequested{false};
+  uint64_t generation = 0;
+};
+
+CaptureSession* session = nullptr;
+// Chunks an earlier session left queued on its tsfn are delivered after a restart;
+// they carry their session's generation and are dropped instead of reaching the new one
+uint64_t sessionGeneration = 0;
+
+void StopSession() {
+  if (!session) return;
+  session->running = false;
+  if (session->thread.joinable()) session->thread.join();
+  session->tsfn.Release();
+  session->onError.Reset();
+  session->onKeyword.Reset();
+  delete session;
+  session = nullptr;
+}
+
+void DeliverChunk(Napi::Env env, Napi::Function onData, CaptureChunk* chunk) {
+  if (env != nullptr && onData != nullptr && session &&
+      chunk->generation == session->generation) {
+    if (chunk->keywordScore >= 0) {
+      if (!session->onKeyword.IsEmpty()) {
+        session->onKeyword.Call({Napi::Number::New(env, chunk->keywordScore)});
+      }
+    } else if (!chunk->error.empty()) {
+      if (!session->onError.IsEmpty()) {
+        session->onError.Call({Napi::String::New(env, chunk->error)});
+      }
+    } else {
+      const size_t bytes = chunk->samples.size() * sizeof(int16_t);
+      Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, bytes);
+      std::memcpy(buffer.Data(), chunk->samples.data(), bytes);
+      onData.Call({Napi::TypedArrayOf<int16_t>::New(env, chunk->samples.size(), buffer, 0,
+                                                     napi_int16_array),
+                   Napi::Number::New(env, static_cast<double>(chunk->sequence)),
+                   Napi::Number::New(env, chunk->elapsedMs),
+                   Napi::Number::New(env, static_cast<double>(chunk->overruns))});
+    }
+  }
+  delete chunk;
+}
+
+// capabilities(): what this build and this session can do
+Napi::Value Capabilities(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object result = Napi::Object::New(env);
+
+  Napi::Array backends = Napi::Array::New(env);
+  uint32_t index = 0;
+  for (const std::string& backend : cloudkit::AvailableCaptureBackends()) {
+    backends.Set(index++, Napi::String::New(env, backend));
+  }
+  result.Set("capture", backends);
+  result.Set("opus", Napi::Boolean::New(env, cloudkit::HasOpus()));
+  result.Set("keyword", Napi::Boolean::New(env, true));
+  result.Set("resample", Napi::Boolean::New(env, true));
+  result.Set("inject", Napi::Boolean::New(env, cloudkit::CanInject()));
+  result.Set("shm", Napi::Boolean::New(env, true));
+  return result;
+}
+
+std::shared_ptr<const KeywordModel> LoadKeywordModel(Napi::Env env, const std::string& path,
+                                                     int sampleRate) {
+  std::string error;
+  std::shared_ptr<const KeywordModel> model = KeywordModel::Load(path, &error);
+  if (!model) throw Napi::Error::New(env, error);
+  if (static_cast<int>(model->sampleRate) != sampleRate) {
+    throw Napi::RangeError::New(env, "Keyword model expects " +
+                                         std::to_string(model->sampleRate) + " Hz audio");
+  }
+  return model;
+}
+
+// startCapture(options, onData, onError?, onKeyword?): opens the source, then reads on a thread
+// onData(samples, sequence, elapsedMs, overruns) - the extra arguments feed capture health
+// options.keywordModel starts the session listening; onKeyword(score) reports detections
+Napi::Value StartCapture(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    throw Napi::TypeError::New(env, "startCapture(options, onData, onError?, onKeyword?)");
+  }
+  StopSession();
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  CaptureOptions capture;
+  if (options.Has("backend")) capture.backend = options.Get("backend").ToString();
+  if (options.Has("device")) capture.device = options.Get("device").ToString();
+  if (options.Has("sampleRate")) capture.sampleRate = options.Get("sampleRate").ToNumber();
+  if (options.Has("frameMs")) capture.frameMs = options.Get("frameMs").ToNumber();
+  if (capture.sampleRate <= 0 || capture.frameMs <= 0) {
+    throw Napi::RangeError::New(env, "sampleRate and frameMs must be positive");
+  }
+
+  std::unique_ptr<KeywordSpotter> spotter;
+  if (options.Has("keywordModel")) {
+    KeywordOptions keyword;
+    if (options.Has("keywordThreshold")) {
+      keyword.threshold = options.Get("keywordThreshold").ToNumber().FloatValue();
+    }
+    spotter = std::make_unique<KeywordSpotter>(
+        LoadKeywordModel(env, options.Get("keywordModel").ToString(), capture.sampleRate),
+        keyword);
+  }
+
+  std::string backend;
+  std::string error;
+  std::unique_ptr<CaptureSource> source = cloudkit::OpenCaptureSource(capture, &backend, &error);
+  if (!source) throw Napi::Error::New(env, error);
+
+  session = new CaptureSession();
+  session->source = std::move(source);
+  session->spotter = std::move(spotter);
+  session->generation = ++sessionGeneration;
+  session->running = true;
+  session->tsfn = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(),
+                                                "cloudkit capture", 0, 1);
+  if (info.Length() > 2 && info[2].IsFunction()) {
+    session->onError = Napi::Persistent(info[2].As<Napi::Function>());
+  }
+  if (info.Length() > 3 && info[3].IsFunction()) {
+    session->onKeyword = Napi::Persistent(info[3].As<Napi::Function>());
+  }
+
+  const size_t frameSamples = static_cast<size_t>(capture.sampleRate) * capture.frameMs / 1000;
+  const size_t historySamples = static_cast<size_t>(capture.sampleRate) * kMaxPrerollMs / 1000;
+  const int sampleRate = capture.sampleRate;
+  CaptureSession* current = session;
+  current->thread = std::thread([current, frameSamples, historySamples, sampleRate]() {
+    const uint64_t generation = current->generation;
+    auto newChunk = [generation]() {
+      auto* chunk = new CaptureChunk();
+      chunk->generation = generation;
+      return chunk;
+    };
+    auto started = std::chrono::steady_clock::now();
+    uint64_t sequence = 0;
+    bool delivering = !current->spotter;
+
+    // Listening state: one reusable frame, a ring of recent audio, and sample counts
+    // (totals while listening) for where listening resumed and the last detection
+    std::vector<int16_t> frame(frameSamples);
+    std::vector<int16_t> history(delivering ? 0 : historySamples);
+    uint64_t samplesRead = 0;
+    uint64_t listeningFrom = 0;
+    uint64_t keywordAt = 0;
+    bool heardKeyword = false;
+
+    while (current->running) {
+      if (current->pauseRequested.exchange(false) && current->spotter) {
+        delivering = false;
+        heardKeyword = false;
+        listeningFrom = samplesRead;  // History before the dictation is stale now
+        current->spotter->Reset();
+      }
+      const int prerollMs = current->resumePrerollMs.exchange(-1);
+      if (prerollMs >= 0 && !delivering) {
+        // Hand over the pre-roll as the first chunk of the dictation
+        const uint64_t wanted = static_cast<uint64_t>(sampleRate) * prerollMs / 1000;
+        const uint64_t oldest =
+            std::max(listeningFrom, samplesRead - std::min<uint64_t>(samplesRead, history.size()));
+        const uint64_t anchor = heardKeyword ? keywordAt : samplesRead;
+        const uint64_t from = std::max(oldest, anchor - std::min(anchor, wanted));
+        auto* chunk = newChunk();
+        chunk->samples.reserve(samplesRead - from);
+        for (uint64_t i = from; i < samplesRead; i++) {
+          chunk->samples.push_back(history[i % history.size()]);
+        }
+        delivering = true;
+        sequence = 0;
+        started = std::chrono::steady_clock::now();
+        chunk->overruns = current->source->Overruns();
+        if (chunk->samples.empty()) {
+          delete chunk;
+        } else {
+          sequence++;
+          if (current->tsfn.NonBlockingCall(chunk, DeliverChunk) != napi_ok) delete chunk;
+        }
+      }
+
+      if (!delivering) {
+        std::string readError;
+        if (!current->source->Read(frame.data(), frameSamples, &readError)) {
+          auto* chunk = newChunk();
+          chunk->error = readError;
+          current->running = false;
+          if (current->tsfn.NonBlockingCall(chunk, DeliverChunk) != napi_ok) delete chunk;
+          break;
+        }
+        for (size_t i = 0; i < frameSamples; i++) {
+          history[(samplesRead + i) % history.size()] = frame[i];
+        }
+        samplesRead += frameSamples;
+        if (current->spotter->Push(frame.data(), frameSamples)) {
+          heardKeyword = true;
+          keywordAt = samplesRead;
+          auto* event = newChunk();
+          event->keywordScore = current->spotter->Score();
+          if (current->tsfn.NonBlockingCall(event, DeliverChunk) != napi_ok) delete event;
+        }
+        continue;
+      }
+
+      auto* chunk = newChunk();
+      chunk->samples.resize(frameSamples);
+      if (!current->source->Read(chunk->samples.data(), frameSamples, &chunk->error)) {
+        chunk->samples.clear();
+        current->running = false;
+      }
+      chunk->sequence = sequence++;
+      chunk->elapsedMs = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - started)
+                             .count();
+      chunk->overruns = current->source->Overruns();
+      if (current->tsfn.NonBlockingCall(chunk, DeliverChunk) != napi_ok) delete chunk;
+    }
+  });
+
+  return Napi::String::New(env, backend);
+}
+
+// resumeCapture(prerollMs): a listening session starts delivering audio, beginning
+// prerollMs before the last detection (or before now when nothing was detected)
+Napi::Value ResumeCapture(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    throw Napi::TypeError::New(env, "resumeCapture(prerollMs)");
+  }
+  if (!session || !session->spotter) throw Napi::Error::New(env, "No listening capture session");
+  const int prerollMs = info[0].ToNumber().Int32Value();
+  session->resumePrerollMs = std::max(0, std::min(kMaxPrerollMs, prerollMs));
+  return env.Undefined();
+}
+
+// pauseCapture(): back to listening, keeping the device open
+Napi::Value PauseCapture(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!session || !session->spotter) throw Napi::Error::New(env, "No listening capture session");
+  session->pauseRequested = true;
+  return env.Undefined();
+}
+
+// Typed array arguments are read as one element type; any other kind (a Float32Array
+// passed to resample, say) would be reinterpreted with the wrong element count
+bool IsTypedArrayOf(const Napi::Value& value, napi_typedarray_type type) {
+  return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == type;
+}
+
+// spotKeywords(modelPath, samples: Int16Array, sampleRate, threshold): detection times (ms)
+// Runs the same streaming detector over a recording, synchronously - for benchmarks
+Napi::Value SpotKeywords(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 4 || !info[0].IsString() || !IsTypedArrayOf(info[1], napi_int16_array) ||
+      !info[2].IsNumber() || !info[3].IsNumber()) {
+    throw Napi::TypeError::New(env,
+                               "spotKeywords(modelPath, samples: Int16Array, sampleRate, threshold)");
+  }
+  const int sampleRate = info[2].ToNumber().Int32Value();
+  KeywordOptions options;
+  options.threshold = info[3].ToNumber().FloatValue();
+  KeywordSpotter spotter(LoadKeywordModel(env, info[0].ToString(), sampleRate), options);
+
+  Napi::TypedArrayOf<int16_t> samples = info[1].As<Napi::TypedArrayOf<int16_t>>();
+  // Fed in 10ms blocks, as the capture thread would
+  const size_t block = static_cast<size_t>(sampleRate) / 100;
+  Napi::Array detections = Napi::Array::New(env);
+  uint32_t index = 0;
+  for (size_t offset = 0; offset < samples.ElementLength(); offset += block) {
+    const size_t count = std::min(block, samples.ElementLength() - offset);
+    if (spotter.Push(samples.Data() + offset, count)) {
+      detections.Set(index++, Napi::Number::New(env, (offset + count) * 1000.0 / sampleRate));
+    }
+  }
+  return detections;
+}
+
+Napi::Value StopCapture(const Napi::CallbackInfo& info) {
+  StopSession();
+  return info.Env().Undefined();
+}
+
+// Decoding runs on the libuv pool so the caller's event loop stays free
+class DecodeWorker : public Napi::AsyncWorker {
+ public:
+  DecodeWorker(Napi::Env env, std::vector<uint8_t> input, int sampleRate)
+      : Napi::AsyncWorker(env),
+        deferred_(Napi::Promise::Deferred::New(env)),
+        input_(std::move(input)),
+        sampleRate_(sampleRate) {}
+
+  Napi::Promise Promise() { return deferred_.Promise(); }
+
+  void Execute() override {
+    std::string error;
+    if (!cloudkit::DecodeWebmOpus(input_.data(), input_.size(), sampleRate_, &pcm_, &error)) {
+      SetError(error);
+    }
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    const size_t bytes = pcm_.size() * sizeof(int16_t);
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, bytes);
+    std::memcpy(buffer.Data(), pcm_.data(), bytes);
+    deferred_.Resolve(
+        Napi::TypedArrayOf<int16_t>::New(env, pcm_.size(), buffer, 0, napi_int16_array));
+  }
+
+  void OnError(const Napi::Error& error) override { deferred_.Reject(error.Value()); }
+
+ private:
+  Napi::Promise::Deferred deferred_;
+  std::vector<uint8_t> input_;
+  int sampleRate_;
+  std::vector<int16_t> pcm_;
+};
+
+// decodeWebmOpus(data: Uint8Array, sampleRate): Promise<Int16Array>
+Napi::Value DecodeWebmOpus(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !IsTypedArrayOf(info[0], napi_uint8_array) || !info[1].IsNumber()) {
+    throw Napi::TypeError::New(env, "decodeWebmOpus(data: Uint8Array, sampleRate)");
+  }
+  Napi::Uint8Array data = info[0].As<Napi::Uint8Array>();
+  std::vector<uint8_t> input(data.Data(), data.Data() + data.ByteLength());
+
+  auto* worker = new DecodeWorker(env, std::move(input), info[1].ToNumber().Int32Value());
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+// resample(samples: Int16Array, fromRate, toRate): Int16Array
+Napi::Value Resample(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 3 || !IsTypedArrayOf(info[0], napi_int16_array)) {
+    throw Napi::TypeError::New(env, "resample(samples: Int16Array, fromRate, toRate)");
+  }
+  Napi::TypedArrayOf<int16_t> samples = info[0].As<Napi::TypedArrayOf<int16_t>>();
+  const int fromRate = info[1].ToNumber().Int32Value();
+  const int toRate = info[2].ToNumber().Int32Value();
+  if (fromRate <= 0 || toRate <= 0) throw Napi::RangeError::New(env, "Rates must be positive");
+
+  const std::vector<float> input = cloudkit::ToFloat(samples.Data(), samples.ElementLength());
+  const std::vector<int16_t> output =
+      cloudkit::ToInt16(cloudkit::Resample(input.data(), input.size(), fromRate, toRate));
+
+  const size_t bytes = output.size() * sizeof(int16_t);
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, bytes);
+  std::memcpy(buffer.Data(), output.data(), bytes);
+  return Napi::TypedArrayOf<int16_t>::New(env, output.size(), buffer, 0, napi_int16_array);
+}
+
+// sendPasteShortcut(): presses Ctrl+V, throws when injection is unavailable
+Napi::Value SendPasteShortcut(const Napi::CallbackInfo& info) {
+  std::string error;
+  if (!cloudkit::SendPasteShortcut(&error)) throw Napi::Error::New(info.Env(), error);
+  return info.Env().Undefined();
+}
+
+// Shared memory handles: the External owns a slot whose region shmClose (or env
+// teardown) releases early, so a closed handle fails instead of touching freed memory
+struct RegionSlot {
+  std::unique_ptr<SharedRegion> region;
+};
+
+std::set<RegionSlot*> liveSlots;
+
+// Tags region handles, so another addon's External is rejected rather than cast
+constexpr napi_type_tag kRegionTag = {0x6b1f3e2a9c4d5087ULL, 0xa3e7d2c1b0f94865ULL};
+
+void CloseAllRegions() {
+  for (RegionSlot* slot : liveSlots) slot->region.reset();
+}
+
+// shmCreate(name, bytes): handle for shmWrite/shmClose
+Napi::Value ShmCreate(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+    throw Napi::TypeError::New(env, "shmCreate(name, bytes)");
+  }
+  const double bytes = info[1].ToNumber().DoubleValue();
+  if (bytes <= 0) throw Napi::RangeError::New(env, "bytes must be positive");
+
+  std::string error;
+  auto* slot = new RegionSlot();
+  slot->region = SharedRegion::Create(info[0].ToString(), static_cast<size_t>(bytes), &error);
+  if (!slot->region) {
+    delete slot;
+    throw Napi::Error::New(env, error);
+  }
+  liveSlots.insert(slot);
+  auto handle = Napi::External<RegionSlot>::New(env, slot, [](Napi::Env, RegionSlot* s) {
+    liveSlots.erase(s);
+    delete s;
+  });
+  if (napi_type_tag_object(env, handle, &kRegionTag) != napi_ok) {
+    throw Napi::Error::New(env, "Cannot tag the shared memory handle");
+  }
+  return handle;
+}
+
+// The slot behind a handle from shmCreate, or null for anything else
+RegionSlot* SlotFromValue(Napi::Env env, Napi::Value value) {
+  if (!value.IsExternal()) return nullptr;
+  bool tagged = false;
+  if (napi_check_object_type_tag(env, value, &kRegionTag, &tagged) != napi_ok || !tagged) {
+    return nullptr;
+  }
+  return value.As<Napi::External<RegionSlot>>().Data();
+}
+
+SharedRegion* RegionFromHandle(const Napi::CallbackInfo& info) {
+  RegionSlot* slot = info.Length() < 1 ? nullptr : SlotFromValue(info.Env(), info[0]);
+  if (!slot) throw Napi::TypeError::New(info.Env(), "Expected a shared memory handle");
+  if (!slot->region) throw Napi::Error::New(info.Env(), "Shared memory handle is closed");
+  return slot->region.get();
+}
+
+// shmClose(handle): unmap and unlink now rather than at garbage collection
+Napi::Value ShmClose(const Napi::CallbackInfo& info) {
+  RegionSlot* slot = info.Length() < 1 ? nullptr : SlotFromValue(info.Env(), info[0]);
+  if (!slot) throw Napi::TypeError::New(info.Env(), "shmClose(handle)");
+  slot->region.reset();
+  return info.Env().Undefined();
+}
+
+// shmWrite(handle, byteOffset, samples: Int16Array)
+Napi::Value ShmWrite(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  SharedRegion* region = RegionFromHandle(info);
+  if (info.Length() < 3 || !info[1].IsNumber() || !IsTypedArrayOf(info[2], napi_int16_array)) {
+    throw Napi::TypeError::New(env, "shmWrite(handle, byteOffset, samples: Int16Array)");
+  }
+  Napi::TypedArray samples = info[2].As<Napi::TypedArray>();
+  const uint8_t* data =
+      static_cast<const uint8_t*>(samples.ArrayBuffer().Data()) + samples.ByteOffset();
+  if (!region->Write(static_cast<size_t>(info[1].ToNumber().DoubleValue()), data,
+                     samples.ByteLength())) {
+    throw Napi::RangeError::New(env, "Write outside the shared region");
+  }
+  return env.Undefined();
+}
+
+// shmUnlink(name): remove a stale region left by a dead process
+Napi::Value ShmUnlink(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) throw Napi::TypeError::New(env, "shmUnlink(name)");
+  return Napi::Boolean::New(env, cloudkit::UnlinkSharedRegion(info[0].ToString()));
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("capabilities", Napi::Function::New(env, Capabilities));
+  exports.Set("startCapture", Napi::Function::New(env, StartCapture));
+  exports.Set("stopCapture", Napi::Function::New(env, StopCapture));
+  exports.Set("resumeCapture", Napi::Function::New(env, ResumeCapture));
+  exports.Set("pauseCapture", Napi::Function::New(env, PauseCapture));
+  exports.Set("spotKeywords", Napi::Function::New(env, SpotKeywords));
+  exports.Set("decodeWebmOpus", Napi::Function::New(env, DecodeWebmOpus));
+  exports.Set("resample", Napi::Function::New(env, Resample));
+  exports.Set("sendPasteShortcut", Napi::Function::New(env, SendPasteShortcut));
+  exports.Set("shmCreate", Napi::Function::New(env, ShmCreate));
+  exports.Set("shmWrite", Napi::Function::New(env, ShmWrite));
+  exports.Set("shmClose", Napi::Function::New(env, ShmClose));
+  exports.Set("shmUnlink", Napi::Function::New(env, ShmUnlink));
+
+  // Stop the capture thread and drop shared regions before the environment goes away
+  napi_add_env_cleanup_hook(env, [](void*) {
+    StopSession();
+    CloseAllRegions();
+  }, nullptr);
+  return exports;
+}
+
+}  // namespace
+
+NODE_API_MODULE(cloudkit, Init)
@@ -0,0 +1,157 @@
+#include "capture.h"
+
+#ifdef CLOUDKIT_HAVE_PULSE
+#include <pulse/error.h>
+#include <pulse/simple.h>
+#endif
+
+#ifdef CLOUDKIT_HAVE_ALSA
+#include <alsa/asoundlib.h>
+
+#include <cerrno>
+#endif
+
+namespace cloudkit {
+
+#ifdef CLOUDKIT_HAVE_PULSE
+
+// PulseAudio simple API - also serves PipeWire through pipewire-pulse
+class PulseSource : public CaptureSource {
+ public:
+  explicit PulseSource(pa_simple* stream) : stream_(stream) {}
+  ~PulseSource() override { pa_simple_free(stream_); }
+
+  static std::unique_ptr<CaptureSource> Open(const CaptureOptions& options, std::string* error) {
+    pa_sample_spec spec;
+    spec.format = PA_SAMPLE_S16LE;
+    spec.rate = options.sampleRate;
+    spec.channels = 1;
+
+    // Small fragments keep the first samples flowing within one frame of the request
+    pa_buffer_attr attr;
+    attr.maxlength = static_cast<uint32_t>(-1);
+    attr.fragsize = options.sampleRate * options.frameMs / 1000 * sizeof(int16_t);
+    attr.tlength = attr.prebuf = attr.minreq = static_cast<uint32_t>(-1);
+
+    int status = 0;
+    pa_simple* stream =
+        pa_simple_new(nullptr, "Wispr Flow", PA_STREAM_RECORD,
+                      options.device.empty() ? nullptr : options.device.c_str(), "Dictation",
+                      &spec, nullptr, &attr, &status);
+    if (!stream) {
+      *error = std::string("PulseAudio: ") + pa_strerror(status);
+      return nullptr;
+    }
+    return std::make_unique<PulseSource>(stream);
+  }
+
+  bool Read(int16_t* samples, size_t count, std::string* error) override {
+    int status = 0;
+    if (pa_simple_read(stream_, samples, count * sizeof(int16_t), &status) < 0) {
+      *error = std::string("PulseAudio: ") + pa_strerror(status);
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  pa_simple* stream_;
+};
+
+#endif
+
+#ifdef CLOUDKIT_HAVE_ALSA
+
+class AlsaSource : public CaptureSource {
+ public:
+  explicit AlsaSource(snd_pcm_t* pcm) : pcm_(pcm) {}
+  ~AlsaSource() override { snd_pcm_close(pcm_); }
+
+  static std::unique_ptr<CaptureSource> Open(const CaptureOptions& options, std::string* error) {
+    snd_pcm_t* pcm = nullptr;
+    const char* device = options.device.empty() ? "default" : options.device.c_str();
+    int status = snd_pcm_open(&pcm, device, SND_PCM_STREAM_CAPTURE, 0);
+    if (status < 0) {
+      *error = std::string("ALSA: ") + snd_strerror(status);
+      return nullptr;
+    }
+
+    // Let ALSA's plug layer convert to mono 16-bit at the requested rate
+    const unsigned int latencyUs = options.frameMs * 2 * 1000;
+    status = snd_pcm_set_params(pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED, 1,
+                                options.sampleRate, 1, latencyUs);
+    if (status < 0) {
+      snd_pcm_close(pcm);
+      *error = std::string("ALSA: ") + snd_strerror(status);
+      return nullptr;
+    }
+    return std::make_unique<AlsaSource>(pcm);
+  }
+
+  bool Read(int16_t* samples, size_t count, std::string* error) override {
+    size_t done = 0;
+    while (done < count) {
+      snd_pcm_sframes_t frames = snd_pcm_readi(pcm_, samples + done, count - done);
+      if (frames < 0) {
+        if (frames == -EPIPE) overruns_++;
+        // Recover from overruns (-EPIPE) and suspends instead of ending the capture
+        frames = snd_pcm_recover(pcm_, static_cast<int>(frames), 1);
+        if (frames < 0) {
+          *error = std::string("ALSA: ") + snd_strerror(static_cast<int>(frames));
+          return false;
+        }
+        continue;
+      }
+      done += static_cast<size_t>(frames);
+    }
+    return true;
+  }
+
+  uint64_t Overruns() const override { return overruns_; }
+
+ private:
+  snd_pcm_t* pcm_;
+  uint64_t overruns_ = 0;
+};
+
+#endif
+
+std::vector<std::string> AvailableCaptureBackends() {
+  std::vector<std::string> backends;
+#ifdef CLOUDKIT_HAVE_PULSE
+  backends.push_back("pulse");
+#endif
+#ifdef CLOUDKIT_HAVE_ALSA
+  backends.push_back("alsa");
+#endif
+  return backends;
+}
+
+std::unique_ptr<CaptureSource> OpenCaptureSource(const CaptureOptions& options,
+                                                 std::string* backend, std::string* error) {
+  std::string lastError = "No capture backend compiled in";
+
+  for (const std::string& candidate : AvailableCaptureBackends()) {
+    if (!options.backend.empty() && options.backend != candidate) continue;
+
+    std::unique_ptr<CaptureSource> source;
+#ifdef CLOUDKIT_HAVE_PULSE
+    if (candidate == "pulse") source = PulseSource::Open(options, &lastError);
+#endif
+#ifdef CLOUDKIT_HAVE_ALSA
+    if (candidate == "alsa") source = AlsaSource::Open(options, &lastError);
+#endif
+    if (source) {
+      *backend = candidate;
+      return source;
+    }
+  }
+
+  if (!options.backend.empty() && lastError == "No capture backend compiled in") {
+    lastError = "Capture backend not available: " + options.backend;
+  }
+  *error = lastError;
+  return nullptr;
+}
+
+}  // namespace cloudkit
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cloudkit {
+
+struct CaptureOptions {
+  std::string backend;  // "pulse" or "alsa"; empty picks the first available
+  std::string device;   // Backend device name; empty is the default source
+  int sampleRate = 16000;
+  int frameMs = 10;  // Samples are delivered in blocks of this length
+};
+
+// Blocking PCM source (mono int16) read on the capture thread
+class CaptureSource {
+ public:
+  virtual ~CaptureSource() = default;
+  virtual bool Read(int16_t* samples, size_t count, std::string* error) = 0;
+  // Device buffer overruns (samples lost before Read) since the source was opened
+  virtual uint64_t Overruns() const { return 0; }
+};
+
+// Backends compiled into this build, in order of preference
+std::vector<std::string> AvailableCaptureBackends();
+
+// Open a source synchronously so configuration errors reach the caller
+std::unique_ptr<CaptureSource> OpenCaptureSource(const CaptureOptions& options,
+                                                 std::string* backend, std::string* error);
+
+}  // namespace cloudkit
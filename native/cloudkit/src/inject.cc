@@ -0,0 +1,69 @@
+#include "inject.h"
+
+#ifdef CLOUDKIT_HAVE_XTEST
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+#include <X11/keysym.h>
+#endif
+
+namespace cloudkit {
+
+#ifdef CLOUDKIT_HAVE_XTEST
+
+namespace {
+
+// Opened once and kept - reconnecting costs more than the paste itself
+Display* display = nullptr;
+bool probed = false;
+
+Display* GetDisplay() {
+  if (!probed) {
+    probed = true;
+    display = XOpenDisplay(nullptr);
+    int eventBase, errorBase, major, minor;
+    if (display && !XTestQueryExtension(display, &eventBase, &errorBase, &major, &minor)) {
+      XCloseDisplay(display);
+      display = nullptr;
+    }
+  }
+  return display;
+}
+
+}  // namespace
+
+bool CanInject() { return GetDisplay() != nullptr; }
+
+bool SendPasteShortcut(std::string* error) {
+  Display* dpy = GetDisplay();
+  if (!dpy) {
+    *error = "No X11 display with the XTest extension";
+    return false;
+  }
+
+  const KeyCode control = XKeysymToKeycode(dpy, XK_Control_L);
+  const KeyCode v = XKeysymToKeycode(dpy, XK_v);
+  if (!control || !v) {
+    *error = "Keyboard mapping has no Control or V key";
+    return false;
+  }
+
+  XTestFakeKeyEvent(dpy, control, True, CurrentTime);
+  XTestFakeKeyEvent(dpy, v, True, CurrentTime);
+  XTestFakeKeyEvent(dpy, v, False, CurrentTime);
+  XTestFakeKeyEvent(dpy, control, False, CurrentTime);
+  XFlush(dpy);
+  return true;
+}
+
+#else
+
+bool CanInject() { return false; }
+
+bool SendPasteShortcut(std::string* error) {
+  *error = "Built without XTest";
+  return false;
+}
+
+#endif
+
+}  // namespace cloudkit
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+namespace cloudkit {
+
+// Whether synthetic key events can be sent (X11 display with the XTest extension)
+bool CanInject();
+
+// Press Ctrl+V in the focused window - the clipboard is set by Electron beforehand
+bool SendPasteShortcut(std::string* error);
+
+}  // namespace cloudkit
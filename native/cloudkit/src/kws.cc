@@ -0,0 +1,318 @@
+#include "kws.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace cloudkit {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint32_t kVersion = 1;
+constexpr size_t kMaxFftSize = 4096;
+constexpr float kMinMelHz = 20.0f;
+constexpr float kLogFloor = 1e-6f;
+
+// Bounds-checked little-endian reader over the model file
+class Reader {
+ public:
+  explicit Reader(const std::vector<uint8_t>& data) : data_(data) {}
+
+  bool Bytes(void* out, size_t count) {
+    if (data_.size() - offset_ < count) return false;
+    std::memcpy(out, data_.data() + offset_, count);
+    offset_ += count;
+    return true;
+  }
+  bool U32(uint32_t* out) { return Bytes(out, sizeof(*out)); }
+  bool F32(float* out) { return Bytes(out, sizeof(*out)); }
+  bool AtEnd() const { return offset_ == data_.size(); }
+
+ private:
+  const std::vector<uint8_t>& data_;
+  size_t offset_ = 0;
+};
+
+float HzToMel(float hz) { return 2595.0f * std::log10(1.0f + hz / 700.0f); }
+float MelToHz(float mel) { return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f); }
+
+int8_t Saturate(float value) {
+  return static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, std::nearbyint(value))));
+}
+
+}  // namespace
+
+std::shared_ptr<const KeywordModel> KeywordModel::Load(const std::string& path,
+                                                       std::string* error) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    *error = "Cannot open keyword model " + path;
+    return nullptr;
+  }
+  const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+  Reader reader(data);
+
+  auto model = std::make_shared<KeywordModel>();
+  char magic[4];
+  uint32_t version = 0;
+  uint32_t layerCount = 0;
+  if (!reader.Bytes(magic, sizeof(magic)) || std::memcmp(magic, "CKWS", 4) != 0 ||
+      !reader.U32(&version) || version != kVersion) {
+    *error = "Not a version 1 keyword model: " + path;
+    return nullptr;
+  }
+  if (!reader.U32(&model->sampleRate) || !reader.U32(&model->windowMs) ||
+      !reader.U32(&model->hopMs) || !reader.U32(&model->melBands) ||
+      !reader.U32(&model->cepstra) || !reader.U32(&model->frames) ||
+      !reader.F32(&model->inputScale) || !reader.U32(&model->labelCount) ||
+      !reader.U32(&model->keywordLabel) || !reader.U32(&layerCount)) {
+    *error = "Truncated keyword model header";
+    return nullptr;
+  }
+
+  // Sizes in samples as the spotter computes them; a hop that rounds to 0 never advances
+  const size_t window = static_cast<size_t>(model->sampleRate) * model->windowMs / 1000;
+  const size_t hop = static_cast<size_t>(model->sampleRate) * model->hopMs / 1000;
+  if (hop == 0 || model->windowMs < model->hopMs || window == 0 ||
+      window > kMaxFftSize || model->melBands == 0 || model->cepstra > model->melBands ||
+      model->frames == 0 || !(model->inputScale > 0) || model->keywordLabel >= model->labelCount ||
+      layerCount == 0) {
+    *error = "Invalid keyword model header";
+    return nullptr;
+  }
+
+  uint32_t expectedInputs = model->frames * model->FeatureSize();
+  for (uint32_t i = 0; i < layerCount; i++) {
+    Layer layer;
+    uint32_t relu = 0;
+    if (!reader.U32(&layer.inputs) || !reader.U32(&layer.outputs) || !reader.U32(&relu) ||
+        !reader.F32(&layer.weightScale) || !reader.F32(&layer.outputScale)) {
+      *error = "Truncated keyword model layer";
+      return nullptr;
+    }
+    const bool last = i + 1 == layerCount;
+    if (layer.inputs != expectedInputs || layer.outputs == 0 || !(layer.weightScale > 0) ||
+        (last ? layer.outputs != model->labelCount : !(layer.outputScale > 0))) {
+      *error = "Keyword model layer " + std::to_string(i) + " does not fit the network";
+      return nullptr;
+    }
+    layer.relu = relu != 0;
+    layer.weights.resize(static_cast<size_t>(layer.inputs) * layer.outputs);
+    layer.bias.resize(layer.outputs);
+    if (!reader.Bytes(layer.weights.data(), layer.weights.size()) ||
+        !reader.Bytes(layer.bias.data(), layer.bias.size() * sizeof(int32_t))) {
+      *error = "Truncated keyword model weights";
+      return nullptr;
+    }
+    expectedInputs = layer.outputs;
+    model->layers.push_back(std::move(layer));
+  }
+  if (!reader.AtEnd()) {
+    *error = "Trailing data after the keyword model";
+    return nullptr;
+  }
+  return model;
+}
+
+KeywordSpotter::KeywordSpotter(std::shared_ptr<const KeywordModel> model,
+                               const KeywordOptions& options)
+    : model_(std::move(model)), options_(options) {
+  const KeywordModel& m = *model_;
+  window_ = static_cast<size_t>(m.sampleRate) * m.windowMs / 1000;
+  hop_ = static_cast<size_t>(m.sampleRate) * m.hopMs / 1000;
+  fftSize_ = 1;
+  while (fftSize_ < window_) fftSize_ <<= 1;
+  const size_t bins = fftSize_ / 2 + 1;
+
+  hann_.resize(window_);
+  for (size_t i = 0; i < window_; i++) {
+    hann_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / window_));
+  }
+
+  // Iterative radix-2 FFT tables
+  size_t bits = 0;
+  while ((size_t{1} << bits) < fftSize_) bits++;
+  bitReverse_.resize(fftSize_);
+  for (size_t i = 0; i < fftSize_; i++) {
+    uint32_t reversed = 0;
+    for (size_t b = 0; b < bits; b++) reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    bitReverse_[i] = reversed;
+  }
+  twiddles_.resize(fftSize_ / 2);
+  for (size_t i = 0; i < fftSize_ / 2; i++) {
+    twiddles_[i] = std::polar(1.0f, static_cast<float>(-2.0 * kPi * i / fftSize_));
+  }
+
+  // Triangular filters, equally spaced on the mel scale
+  melFilters_.assign(static_cast<size_t>(m.melBands) * bins, 0.0f);
+  const float lowMel = HzToMel(kMinMelHz);
+  const float highMel = HzToMel(m.sampleRate / 2.0f);
+  std::vector<float> edges(m.melBands + 2);
+  for (size_t i = 0; i < edges.size(); i++) {
+    edges[i] = MelToHz(lowMel + (highMel - lowMel) * i / (m.melBands + 1));
+  }
+  for (uint32_t band = 0; band < m.melBands; band++) {
+    for (size_t bin = 0; bin < bins; bin++) {
+      const float hz = static_cast<float>(bin) * m.sampleRate / fftSize_;
+      const float rising = (hz - edges[band]) / (edges[band + 1] - edges[band]);
+      const float falling = (edges[band + 2] - hz) / (edges[band + 2] - edges[band + 1]);
+      melFilters_[band * bins + bin] = std::max(0.0f, std::min(rising, falling));
+    }
+  }
+
+  if (m.cepstra > 0) {
+    dct_.resize(static_cast<size_t>(m.cepstra) * m.melBands);
+    for (uint32_t k = 0; k < m.cepstra; k++) {
+      const double scale = std::sqrt((k == 0 ? 1.0 : 2.0) / m.melBands);
+      for (uint32_t band = 0; band < m.melBands; band++) {
+        dct_[k * m.melBands + band] =
+            static_cast<float>(scale * std::cos(kPi * k * (band + 0.5) / m.melBands));
+      }
+    }
+  }
+
+  const int inferenceMs = std::max(1, options_.inferEveryHops) * static_cast<int>(m.hopMs);
+  posteriors_.assign(std::max(1, options_.smoothingMs / inferenceMs), 0.0f);
+  featureRing_.assign(static_cast<size_t>(m.frames) * m.FeatureSize(), 0);
+  input_.resize(featureRing_.size());
+  spectrum_.resize(fftSize_);
+  power_.resize(bins);
+  mel_.resize(m.melBands);
+
+  size_t widest = 0;
+  for (const KeywordModel::Layer& layer : m.layers) widest = std::max<size_t>(widest, layer.outputs);
+  hidden_[0].resize(widest);
+  hidden_[1].resize(widest);
+  accumulators_.resize(widest);
+  logits_.resize(m.labelCount);
+  pending_.reserve(window_ + 4096);
+}
+
+void KeywordSpotter::Reset() {
+  pending_.clear();
+  std::fill(featureRing_.begin(), featureRing_.end(), 0);
+  ringHead_ = 0;
+  framesSeen_ = 0;
+  std::fill(posteriors_.begin(), posteriors_.end(), 0.0f);
+  posteriorHead_ = 0;
+  posteriorCount_ = 0;
+  detected_ = false;
+}
+
+bool KeywordSpotter::Push(const int16_t* samples, size_t count) {
+  for (size_t i = 0; i < count; i++) pending_.push_back(samples[i] / 32768.0f);
+
+  bool fired = false;
+  const size_t everyHops = static_cast<size_t>(std::max(1, options_.inferEveryHops));
+  const size_t refractoryFrames = options_.refractoryMs / model_->hopMs;
+  while (pending_.size() >= window_) {
+    ComputeFrame();
+    pending_.erase(pending_.begin(), pending_.begin() + hop_);
+    framesSeen_++;
+    // Wait for a full context; until then the network would see zero padding
+    if (framesSeen_ < model_->frames || framesSeen_ % everyHops != 0) continue;
+
+    posteriors_[posteriorHead_] = Infer();
+    posteriorHead_ = (posteriorHead_ + 1) % posteriors_.size();
+    posteriorCount_ = std::min(posteriorCount_ + 1, posteriors_.size());
+    float sum = 0;
+    for (size_t p = 0; p < posteriorCount_; p++) sum += posteriors_[p];
+    const float smoothed = sum / posteriors_.size();
+
+    if (smoothed >= options_.threshold &&
+        (!detected_ || framesSeen_ - lastDetection_ >= refractoryFrames)) {
+      detected_ = true;
+      lastDetection_ = framesSeen_;
+      score_ = smoothed;
+      fired = true;
+    }
+  }
+  return fired;
+}
+
+void KeywordSpotter::ComputeFrame() {
+  const KeywordModel& m = *model_;
+  for (size_t i = 0; i < fftSize_; i++) {
+    spectrum_[bitReverse_[i]] = i < window_ ? pending_[i] * hann_[i] : 0.0f;
+  }
+  for (size_t size = 2; size <= fftSize_; size <<= 1) {
+    const size_t half = size / 2;
+    const size_t stride = fftSize_ / size;
+    for (size_t start = 0; start < fftSize_; start += size) {
+      for (size_t k = 0; k < half; k++) {
+        const std::complex<float> odd = twiddles_[k * stride] * spectrum_[start + k + half];
+        spectrum_[start + k + half] = spectrum_[start + k] - odd;
+        spectrum_[start + k] += odd;
+      }
+    }
+  }
+
+  const size_t bins = power_.size();
+  for (size_t bin = 0; bin < bins; bin++) power_[bin] = std::norm(spectrum_[bin]);
+  for (uint32_t band = 0; band < m.melBands; band++) {
+    const float* filter = &melFilters_[band * bins];
+    float energy = 0;
+    for (size_t bin = 0; bin < bins; bin++) energy += filter[bin] * power_[bin];
+    mel_[band] = std::log(energy + kLogFloor);
+  }
+
+  int8_t* row = &featureRing_[ringHead_ * m.FeatureSize()];
+  if (m.cepstra == 0) {
+    for (uint32_t band = 0; band < m.melBands; band++) row[band] = Saturate(mel_[band] / m.inputScale);
+  } else {
+    for (uint32_t k = 0; k < m.cepstra; k++) {
+      const float* basis = &dct_[k * m.melBands];
+      float value = 0;
+      for (uint32_t band = 0; band < m.melBands; band++) value += basis[band] * mel_[band];
+      row[k] = Saturate(value / m.inputScale);
+    }
+  }
+  ringHead_ = (ringHead_ + 1) % m.frames;
+}
+
+float KeywordSpotter::Infer() {
+  const KeywordModel& m = *model_;
+  // Oldest frame first - ringHead_ is the next slot to overwrite
+  const size_t rowBytes = m.FeatureSize();
+  const size_t older = (m.frames - ringHead_) * rowBytes;
+  std::memcpy(input_.data(), &featureRing_[ringHead_ * rowBytes], older);
+  std::memcpy(input_.data() + older, featureRing_.data(), ringHead_ * rowBytes);
+
+  const int8_t* x = input_.data();
+  float inputScale = m.inputScale;
+  for (size_t l = 0; l < m.layers.size(); l++) {
+    const KeywordModel::Layer& layer = m.layers[l];
+    for (uint32_t o = 0; o < layer.outputs; o++) {
+      const int8_t* w = &layer.weights[static_cast<size_t>(o) * layer.inputs];
+      int32_t acc = 0;
+      for (uint32_t i = 0; i < layer.inputs; i++) acc += int32_t{w[i]} * int32_t{x[i]};
+      accumulators_[o] = acc + layer.bias[o];
+    }
+
+    const float scale = inputScale * layer.weightScale;
+    if (l + 1 == m.layers.size()) {
+      for (uint32_t o = 0; o < layer.outputs; o++) logits_[o] = accumulators_[o] * scale;
+      break;
+    }
+    // Alternate between two buffers so a layer never overwrites its own input
+    std::vector<int8_t>& out = hidden_[l % 2];
+    const float requantize = scale / layer.outputScale;
+    for (uint32_t o = 0; o < layer.outputs; o++) {
+      const float value = accumulators_[o] * requantize;
+      out[o] = Saturate(layer.relu ? std::max(0.0f, value) : value);
+    }
+    x = out.data();
+    inputScale = layer.outputScale;
+  }
+
+  const float peak = *std::max_element(logits_.begin(), logits_.end());
+  float total = 0;
+  for (float& logit : logits_) total += (logit = std::exp(logit - peak));
+  return logits_[m.keywordLabel] / total;
+}
+
+}  // namespace cloudkit
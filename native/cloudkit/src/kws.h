@@ -0,0 +1,107 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cloudkit {
+
+// Keyword spotting for hands-free activation: a log-mel (or MFCC) front end feeding a
+// small int8 fully connected network over the last second or so of frames
+//
+// Model file (little-endian; trained and quantized offline, a few hundred KB):
+//   "CKWS", u32 version (1)
+//   u32 sampleRate, u32 windowMs, u32 hopMs, u32 melBands, u32 cepstra (0 = log-mel),
+//   u32 frames (context length), f32 inputScale (feature = int8 * inputScale)
+//   u32 labelCount, u32 keywordLabel, u32 layerCount
+//   per layer: u32 inputs, u32 outputs, u32 relu, f32 weightScale,
+//              f32 outputScale (0 on the last layer, whose outputs are float logits),
+//              i8 weights[outputs][inputs], i32 bias[outputs] (at input scale * weightScale)
+// Features: Hann window, power spectrum, HTK mel filters from 20 Hz to Nyquist,
+// natural log (+1e-6), then an orthonormal DCT-II when cepstra > 0
+struct KeywordModel {
+  struct Layer {
+    uint32_t inputs = 0;
+    uint32_t outputs = 0;
+    bool relu = false;
+    float weightScale = 0;
+    float outputScale = 0;
+    std::vector<int8_t> weights;
+    std::vector<int32_t> bias;
+  };
+
+  uint32_t sampleRate = 0;
+  uint32_t windowMs = 0;
+  uint32_t hopMs = 0;
+  uint32_t melBands = 0;
+  uint32_t cepstra = 0;
+  uint32_t frames = 0;
+  float inputScale = 0;
+  uint32_t labelCount = 0;
+  uint32_t keywordLabel = 0;
+  std::vector<Layer> layers;
+
+  static std::shared_ptr<const KeywordModel> Load(const std::string& path, std::string* error);
+
+  uint32_t FeatureSize() const { return cepstra > 0 ? cepstra : melBands; }
+};
+
+struct KeywordOptions {
+  float threshold = 0.8f;  // Smoothed keyword posterior that fires
+  int inferEveryHops = 2;  // Run the network every N feature frames
+  int smoothingMs = 200;   // Posterior averaging window
+  int refractoryMs = 1500; // No second detection within this long
+};
+
+// Streaming detector - fed on the capture thread, one instance per session
+class KeywordSpotter {
+ public:
+  KeywordSpotter(std::shared_ptr<const KeywordModel> model, const KeywordOptions& options);
+
+  // Feed samples at the model's rate; true when the keyword fires within them
+  bool Push(const int16_t* samples, size_t count);
+  // Smoothed posterior at the last detection
+  float Score() const { return score_; }
+  // Forget buffered audio (after a dictation, before listening again)
+  void Reset();
+
+ private:
+  void ComputeFrame();
+  float Infer();
+
+  std::shared_ptr<const KeywordModel> model_;
+  KeywordOptions options_;
+  size_t window_;
+  size_t hop_;
+  size_t fftSize_;
+  std::vector<float> hann_;
+  std::vector<std::complex<float>> twiddles_;
+  std::vector<uint32_t> bitReverse_;
+  std::vector<float> melFilters_;  // [melBands][fftSize / 2 + 1]
+  std::vector<float> dct_;         // [cepstra][melBands]
+
+  std::vector<float> pending_;           // Samples not yet consumed by a hop
+  std::vector<int8_t> featureRing_;      // [frames][featureSize]
+  size_t ringHead_ = 0;
+  size_t framesSeen_ = 0;
+  std::vector<float> posteriors_;        // Recent keyword posteriors (smoothing window)
+  size_t posteriorHead_ = 0;
+  size_t posteriorCount_ = 0;
+  size_t lastDetection_ = 0;
+  bool detected_ = false;
+  float score_ = 0;
+
+  // Scratch
+  std::vector<std::complex<float>> spectrum_;
+  std::vector<float> power_;
+  std::vector<float> mel_;
+  std::vector<int8_t> input_;
+  std::vector<int8_t> hidden_[2];
+  std::vector<int32_t> accumulators_;
+  std::vector<float> logits_;
+};
+
+}  // namespace cloudkit
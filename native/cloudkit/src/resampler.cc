@@ -0,0 +1,73 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cloudkit {
+
+namespace {
+
+// Zero crossings on each side of the kernel at the lower of the two rates
+constexpr int kHalfWidth = 16;
+constexpr double kPi = 3.14159265358979323846;
+
+double Sinc(double x) {
+  if (std::fabs(x) < 1e-9) return 1.0;
+  return std::sin(kPi * x) / (kPi * x);
+}
+
+// Blackman window over [-1, 1]
+double Window(double x) {
+  if (std::fabs(x) >= 1.0) return 0.0;
+  const double t = (x + 1.0) / 2.0;
+  return 0.42 - 0.5 * std::cos(2.0 * kPi * t) + 0.08 * std::cos(4.0 * kPi * t);
+}
+
+}  // namespace
+
+std::vector<float> Resample(const float* input, size_t length, int fromRate, int toRate) {
+  if (fromRate == toRate || length == 0) {
+    return std::vector<float>(input, input + length);
+  }
+
+  const double ratio = static_cast<double>(toRate) / fromRate;
+  // When downsampling, lower the cutoff to the new Nyquist and widen the kernel
+  const double cutoff = std::min(1.0, ratio) * 0.97;
+  const double halfWidth = kHalfWidth / cutoff;
+  const size_t outLength = static_cast<size_t>(std::floor(length * ratio));
+
+  std::vector<float> output(outLength);
+  for (size_t i = 0; i < outLength; i++) {
+    const double center = i / ratio;
+    const long first = std::max(0L, static_cast<long>(std::ceil(center - halfWidth)));
+    const long last =
+        std::min(static_cast<long>(length) - 1, static_cast<long>(std::floor(center + halfWidth)));
+
+    double sum = 0.0;
+    for (long k = first; k <= last; k++) {
+      const double offset = center - k;
+      sum += input[k] * cutoff * Sinc(cutoff * offset) * Window(offset / halfWidth);
+    }
+    output[i] = static_cast<float>(sum);
+  }
+  return output;
+}
+
+std::vector<float> ToFloat(const int16_t* input, size_t length) {
+  std::vector<float> output(length);
+  for (size_t i = 0; i < length; i++) {
+    output[i] = input[i] / 32768.0f;
+  }
+  return output;
+}
+
+std::vector<int16_t> ToInt16(const std::vector<float>& input) {
+  std::vector<int16_t> output(input.size());
+  for (size_t i = 0; i < input.size(); i++) {
+    const float clamped = std::max(-1.0f, std::min(1.0f, input[i]));
+    output[i] = static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+  }
+  return output;
+}
+
+}  // namespace cloudkit
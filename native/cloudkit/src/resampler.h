@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cloudkit {
+
+// Band-limited (windowed-sinc) sample rate conversion of a mono signal
+// Used to bring 44.1/48 kHz capture and Opus output down to Whisper's 16 kHz
+std::vector<float> Resample(const float* input, size_t length, int fromRate, int toRate);
+
+// int16 <-> float helpers shared by capture and decoding
+std::vector<float> ToFloat(const int16_t* input, size_t length);
+std::vector<int16_t> ToInt16(const std::vector<float>& input);
+
+}  // namespace cloudkit
@@ -0,0 +1,53 @@
+#include "shm.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace cloudkit {
+
+std::unique_ptr<SharedRegion> SharedRegion::Create(const std::string& name, size_t bytes,
+                                                   std::string* error) {
+  // Exclusive create: never attach to (or truncate) a region someone else made
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    *error = "shm_open(" + name + "): " + std::strerror(errno);
+    return nullptr;
+  }
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    *error = std::string("ftruncate: ") + std::strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);  // The mapping keeps the object alive
+  if (base == MAP_FAILED) {
+    *error = std::string("mmap: ") + std::strerror(errno);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  return std::unique_ptr<SharedRegion>(new SharedRegion(name, base, bytes));
+}
+
+SharedRegion::~SharedRegion() {
+  munmap(base_, size_);
+  shm_unlink(name_.c_str());
+}
+
+bool SharedRegion::Write(size_t offset, const void* data, size_t bytes) {
+  if (offset > size_ || bytes > size_ - offset) return false;
+  std::memcpy(static_cast<uint8_t*>(base_) + offset, data, bytes);
+  return true;
+}
+
+bool UnlinkSharedRegion(const std::string& name) {
+  return shm_unlink(name.c_str()) == 0;
+}
+
+}  // namespace cloudkit
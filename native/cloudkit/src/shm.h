@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace cloudkit {
+
+// Named POSIX shared-memory region written by this process and read by the
+// transcription daemon (which opens it by name, read-only)
+// The creator owns the name: destroying the region unmaps and unlinks it
+class SharedRegion {
+ public:
+  static std::unique_ptr<SharedRegion> Create(const std::string& name, size_t bytes,
+                                              std::string* error);
+  ~SharedRegion();
+
+  SharedRegion(const SharedRegion&) = delete;
+  SharedRegion& operator=(const SharedRegion&) = delete;
+
+  // Copy `bytes` into the region at `offset`; false when out of bounds
+  bool Write(size_t offset, const void* data, size_t bytes);
+
+  const std::string& name() const { return name_; }
+  size_t size() const { return size_; }
+
+ private:
+  SharedRegion(std::string name, void* base, size_t size)
+      : name_(std::move(name)), base_(base), size_(size) {}
+
+  std::string name_;
+  void* base_;
+  size_t size_;
+};
+
+// Remove a region left behind by a process that died without cleaning up
+bool UnlinkSharedRegion(const std::string& name);
+
+}  // namespace cloudkit
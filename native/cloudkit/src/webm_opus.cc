@@ -0,0 +1,204 @@
+#include "webm_opus.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "resampler.h"
+
+#ifdef CLOUDKIT_HAVE_OPUS
+#include <opus.h>
+#endif
+
+namespace cloudkit {
+
+#ifdef CLOUDKIT_HAVE_OPUS
+
+namespace {
+
+// Matroska element IDs (with their length markers, as they appear on disk)
+constexpr uint32_t kSegment = 0x18538067;
+constexpr uint32_t kTracks = 0x1654AE6B;
+constexpr uint32_t kTrackEntry = 0xAE;
+constexpr uint32_t kTrackNumber = 0xD7;
+constexpr uint32_t kCodecId = 0x86;
+constexpr uint32_t kCodecPrivate = 0x63A2;
+constexpr uint32_t kCluster = 0x1F43B675;
+constexpr uint32_t kBlockGroup = 0xA0;
+constexpr uint32_t kBlock = 0xA1;
+constexpr uint32_t kSimpleBlock = 0xA3;
+
+constexpr int kOpusRate = 48000;
+constexpr int kMaxFrameSamples = 5760;  // 120 ms at 48 kHz
+
+struct Reader {
+  const uint8_t* data;
+  size_t length;
+  size_t pos = 0;
+
+  // Element ID: variable length, marker bits kept
+  bool ReadId(uint32_t* id) {
+    if (pos >= length) return false;
+    const uint8_t first = data[pos];
+    int width = 1;
+    while (width <= 4 && !(first & (0x80 >> (width - 1)))) width++;
+    if (width > 4 || pos + width > length) return false;
+    *id = 0;
+    for (int i = 0; i < width; i++) *id = (*id << 8) | data[pos + i];
+    pos += width;
+    return true;
+  }
+
+  // Data size: variable length, marker bit stripped; all ones means unknown
+  bool ReadSize(uint64_t* size, bool* unknown) {
+    if (pos >= length) return false;
+    const uint8_t first = data[pos];
+    int width = 1;
+    while (width <= 8 && !(first & (0x80 >> (width - 1)))) width++;
+    if (width > 8 || pos + width > length) return false;
+    uint64_t value = first & (0xFF >> width);
+    bool allOnes = value == (0xFFu >> width);
+    for (int i = 1; i < width; i++) {
+      value = (value << 8) | data[pos + i];
+      allOnes = allOnes && data[pos + i] == 0xFF;
+    }
+    pos += width;
+    *size = value;
+    *unknown = allOnes;
+    return true;
+  }
+};
+
+uint64_t ReadUnsigned(const uint8_t* data, uint64_t size) {
+  uint64_t value = 0;
+  for (uint64_t i = 0; i < size && i < 8; i++) value = (value << 8) | data[i];
+  return value;
+}
+
+bool IsMaster(uint32_t id) {
+  return id == kSegment || id == kTracks || id == kTrackEntry || id == kCluster ||
+         id == kBlockGroup;
+}
+
+struct Track {
+  uint64_t number = 0;
+  std::string codec;
+  std::vector<uint8_t> codecPrivate;
+};
+
+}  // namespace
+
+bool HasOpus() { return true; }
+
+bool DecodeWebmOpus(const uint8_t* data, size_t length, int sampleRate, std::vector<int16_t>* pcm,
+                    std::string* error) {
+  Reader reader{data, length};
+  std::vector<Track> tracks;
+  uint64_t opusTrack = 0;
+  int channels = 0;
+  int preSkip = 0;
+  OpusDecoder* decoder = nullptr;
+  std::vector<float> mono;
+  std::vector<int16_t> frame;
+
+  // MediaRecorder writes live WebM with unknown-size Segment and Cluster elements, so
+  // the tree is walked flat: masters are entered in place, other elements skipped
+  while (reader.pos < reader.length) {
+    uint32_t id;
+    uint64_t size;
+    bool unknown;
+    if (!reader.ReadId(&id) || !reader.ReadSize(&size, &unknown)) break;
+
+    if (IsMaster(id)) {
+      if (id == kTrackEntry) tracks.emplace_back();
+      continue;
+    }
+    if (unknown || size > reader.length - reader.pos) break;  // Truncated tail
+
+    const uint8_t* payload = reader.data + reader.pos;
+    reader.pos += size;
+
+    if (!tracks.empty() && id == kTrackNumber) {
+      tracks.back().number = ReadUnsigned(payload, size);
+    } else if (!tracks.empty() && id == kCodecId) {
+      tracks.back().codec.assign(reinterpret_cast<const char*>(payload), size);
+    } else if (!tracks.empty() && id == kCodecPrivate) {
+      tracks.back().codecPrivate.assign(payload, payload + size);
+    } else if (id == kSimpleBlock || id == kBlock) {
+      if (!decoder) {
+        // First block: the track headers are complete, set up the decoder
+        for (const Track& track : tracks) {
+          if (track.codec == "A_OPUS" && track.codecPrivate.size() >= 19 &&
+              std::memcmp(track.codecPrivate.data(), "OpusHead", 8) == 0) {
+            opusTrack = track.number;
+            channels = track.codecPrivate[9];
+            preSkip = track.codecPrivate[10] | (track.codecPrivate[11] << 8);
+            break;
+          }
+        }
+        if (opusTrack == 0 || channels < 1 || channels > 2) {
+          *error = "No mono or stereo Opus track found";
+          return false;
+        }
+        int status;
+        decoder = opus_decoder_create(kOpusRate, channels, &status);
+        if (status != OPUS_OK) {
+          *error = std::string("opus_decoder_create failed: ") + opus_strerror(status);
+          return false;
+        }
+        frame.resize(kMaxFrameSamples * channels);
+      }
+
+      // Block header: track number (vint), int16 timecode, flags
+      Reader block{payload, size};
+      uint64_t trackNumber;
+      bool trackUnknown;
+      if (!block.ReadSize(&trackNumber, &trackUnknown) || block.pos + 3 > size) continue;
+      const uint8_t flags = payload[block.pos + 2];
+      block.pos += 3;
+      if (trackNumber != opusTrack) continue;
+      if (flags & 0x06) {
+        // Chromium never laces Opus blocks; bail out rather than mis-decode
+        opus_decoder_destroy(decoder);
+        *error = "Laced blocks are not supported";
+        return false;
+      }
+
+      const int samples = opus_decode(decoder, payload + block.pos,
+                                      static_cast<opus_int32>(size - block.pos), frame.data(),
+                                      kMaxFrameSamples, 0);
+      if (samples < 0) continue;  // Skip a corrupt packet, keep the rest
+
+      for (int i = 0; i < samples; i++) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) sum += frame[i * channels + c];
+        mono.push_back(sum / (channels * 32768.0f));
+      }
+    }
+  }
+
+  if (decoder) opus_decoder_destroy(decoder);
+  if (opusTrack == 0) {
+    *error = "No Opus audio in recording";
+    return false;
+  }
+
+  // Drop the encoder's pre-skip (priming) samples
+  const size_t skip = std::min(mono.size(), static_cast<size_t>(preSkip));
+  const std::vector<float> resampled =
+      Resample(mono.data() + skip, mono.size() - skip, kOpusRate, sampleRate);
+  *pcm = ToInt16(resampled);
+  return true;
+}
+
+#else
+
+bool HasOpus() { return false; }
+
+bool DecodeWebmOpus(const uint8_t*, size_t, int, std::vector<int16_t>*, std::string* error) {
+  *error = "Built without libopus";
+  return false;
+}
+
+#endif
+
+}  // namespace cloudkit
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cloudkit {
+
+// Decode a MediaRecorder WebM/Opus recording to mono PCM at `sampleRate`
+// Replaces the ffmpeg round trip on the transcription path
+// Returns false and fills `error` when the container or codec is unsupported
+bool DecodeWebmOpus(const uint8_t* data, size_t length, int sampleRate, std::vector<int16_t>* pcm,
+                    std::string* error);
+
+// Whether Opus support was compiled in
+bool HasOpus();
+
+}  // namespace cloudkit
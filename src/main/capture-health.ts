@@ -0,0 +1,161 @@
+import { createLogger } from './logger'
+import type { CaptureBackend, CaptureChunkInfo } from './native'
+
+// Per-utterance capture health
+// Both capture paths report the same record: how long the hotkey took to produce
+// audio, whether audio went missing on the way (dropped chunks, late chunks, device
+// overruns, wall-clock time the samples don't cover) and how the input level looked
+// (peak, RMS, clipping). Records are logged, kept in a bounded list for the
+// diagnostics panel and export, and pushed to subscribers as they arrive
+
+export interface CaptureHealth {
+  source: CaptureBackend | 'renderer'
+  startLatencyMs: number | null // Hotkey -> first audio delivered (null if none arrived)
+  durationMs: number // Audio captured
+  chunks: number
+  droppedChunks: number // Chunks lost between the capture thread and JS
+  discontinuities: number // Chunks arriving more than two periods after the previous one
+  longestGapMs: number
+  overruns: number | null // Device buffer overruns (null when the backend can't tell)
+  sampleDeficitMs: number | null // Wall-clock time not covered by samples
+  peakDbfs: number
+  rmsDbfs: number
+  clippedRatio: number // Share of samples at full scale
+}
+
+export interface CaptureHealthRecord extends CaptureHealth {
+  timestamp: number
+}
+
+const HISTORY_LENGTH = 100
+const GAP_PERIODS = 2 // A chunk this many periods late counts as a discontinuity
+const WARN_START_LATENCY_MS = 300
+const WARN_DEFICIT_MS = 50
+const WARN_CLIPPED_RATIO = 0.001
+const SILENT_DBFS = -120
+
+const log = createLogger('CaptureHealth')
+
+const records: CaptureHealthRecord[] = []
+let onRecord: ((record: CaptureHealthRecord) => void) | null = null
+
+export const toDbfs = (level: number): number =>
+  level > 0 ? Math.max(SILENT_DBFS, Math.round(20 * Math.log10(level) * 10) / 10 + 0) : SILENT_DBFS
+
+/**
+ * Accumulates one native capture session from its chunks
+ */
+export class CaptureHealthTracker {
+  private readonly requestedAt: number
+  private readonly periodMs: number
+  private readonly sampleRate: number
+  private readonly source: CaptureBackend
+  private firstChunkAt: number | null = null
+  private firstElapsedMs = 0
+  private lastElapsedMs = 0
+  private nextSequence = 0
+  private chunks = 0
+  private samples = 0
+  private droppedChunks = 0
+  private discontinuities = 0
+  private longestGapMs = 0
+  private overruns = 0
+  private peak = 0
+  private sumSquares = 0
+  private clipped = 0
+
+  /**
+   * @param requestedAt performance.now() when the hotkey fired
+   */
+  constructor(source: CaptureBackend, sampleRate: number, periodMs: number, requestedAt: number) {
+    this.source = source
+    this.sampleRate = sampleRate
+    this.periodMs = periodMs
+    this.requestedAt = requestedAt
+  }
+
+  addChunk(samples: Int16Array, info: CaptureChunkInfo): void {
+    if (this.firstChunkAt === null) {
+      this.firstChunkAt = performance.now()
+      this.firstElapsedMs = info.elapsedMs
+    } else {
+      const gap = info.elapsedMs - this.lastElapsedMs
+      if (gap > this.periodMs * GAP_PERIODS) this.discontinuities++
+      this.longestGapMs = Math.max(this.longestGapMs, gap)
+    }
+    if (info.sequence > this.nextSequence) this.droppedChunks += info.sequence - this.nextSequence
+    this.nextSequence = info.sequence + 1
+    this.lastElapsedMs = info.elapsedMs
+    this.overruns = info.overruns
+    this.chunks++
+    this.samples += samples.length
+
+    for (let i = 0; i < samples.length; i++) {
+      const sample = samples[i]
+      const magnitude = sample < 0 ? -sample : sample
+      if (magnitude > this.peak) this.peak = magnitude
+      if (magnitude >= 32767) this.clipped++
+      this.sumSquares += sample * sample
+    }
+  }
+
+  finish(): CaptureHealth {
+    const durationMs = (this.samples / this.sampleRate) * 1000
+    // The first chunk's read completed one period after its first sample
+    const coveredMs = this.chunks > 0 ? this.lastElapsedMs - this.firstElapsedMs + this.periodMs : 0
+    return {
+      source: this.source,
+      startLatencyMs: this.firstChunkAt === null ? null : Math.round(this.firstChunkAt - this.requestedAt),
+      durationMs: Math.round(durationMs),
+      chunks: this.chunks,
+      droppedChunks: this.droppedChunks,
+      discontinuities: this.discontinuities,
+      longestGapMs: Math.round(this.longestGapMs),
+      overruns: this.source === 'alsa' ? this.overruns : null,
+      sampleDeficitMs: Math.max(0, Math.round(coveredMs - durationMs)),
+      peakDbfs: toDbfs(this.peak / 32768),
+      rmsDbfs: toDbfs(Math.sqrt(this.sumSquares / Math.max(1, this.samples)) / 32768),
+      clippedRatio: this.samples > 0 ? this.clipped / this.samples : 0
+    }
+  }
+}
+
+const problems = (health: CaptureHealth): string[] => {
+  const found: string[] = []
+  if (health.startLatencyMs === null) found.push('no audio')
+  else if (health.startLatencyMs > WARN_START_LATENCY_MS) found.push('slow start')
+  if (health.droppedChunks > 0) found.push('dropped chunks')
+  if (health.overruns) found.push('overruns')
+  if ((health.sampleDeficitMs ?? 0) > WARN_DEFICIT_MS) found.push('missing audio')
+  if (health.clippedRatio > WARN_CLIPPED_RATIO) found.push('clipping')
+  return found
+}
+
+/**
+ * Publish new records as they arrive (the diagnostics store topic)
+ */
+export function onCaptureHealth(listener: ((record: CaptureHealthRecord) => void) | null): void {
+  onRecord = listener
+}
+
+/**
+ * Log and keep one utterance's capture health
+ */
+export function recordCaptureHealth(health: CaptureHealth): CaptureHealthRecord {
+  const record: CaptureHealthRecord = { timestamp: Date.now(), ...health }
+  records.push(record)
+  if (records.length > HISTORY_LENGTH) records.shift()
+
+  const found = problems(health)
+  if (found.length > 0) {
+    log.warn(() => `Capture problems: ${found.join(', ')}`, () => ({ ...health }))
+  } else {
+    log.info('Capture health', () => ({ ...health }))
+  }
+  onRecord?.(record)
+  return record
+}
+
+export function getCaptureHealthRecords(): CaptureHealthRecord[] {
+  return [...records]
+}
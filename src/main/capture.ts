@@ -0,0 +1,250 @@
+import {
+  getNativeCapabilities,
+  startNativeCapture,
+  stopNativeCapture,
+  resumeNativeCapture,
+  pauseNativeCapture,
+  CaptureBackend,
+  CaptureChunkInfo
+} from './native'
+import { CaptureHealth, CaptureHealthTracker } from './capture-health'
+import { createLogger, errorFields } from './logger'
+
+// Main-process microphone capture through the native module (PulseAudio/PipeWire/ALSA)
+// Started straight from the hotkey handler, so a dictation no longer waits for the
+// pill renderer to run getUserMedia and MediaRecorder. With hands-free activation the
+// device stays open listening for the keyword (wake-word.ts), and a dictation switches
+// that session to delivery instead of opening the device again
+
+export const CAPTURE_SAMPLE_RATE = 16000 // What Whisper wants - no resampling later
+const CAPTURE_FRAME_MS = 10 // Period size: first samples arrive within ~10ms
+const MAX_RECORDING_SECONDS = 300
+const TRAILING_CAPTURE_MS = 100 // Keep recording briefly after release (matches the renderer)
+const LEVEL_INTERVAL_MS = 33 // ~30 level updates per second for the pill visualizer
+
+const log = createLogger('Capture')
+
+/**
+ * Fixed-size ring of 16-bit samples
+ * Allocated once; a recording longer than the capacity keeps its most recent audio
+ */
+export class PcmRingBuffer {
+  private samples: Int16Array
+  private writeIndex = 0
+  private length = 0
+
+  constructor(capacity: number) {
+    this.samples = new Int16Array(capacity)
+  }
+
+  get size(): number {
+    return this.length
+  }
+
+  write(chunk: Int16Array): void {
+    const capacity = this.samples.length
+    // Only the tail of an oversized chunk can survive
+    const source = chunk.length > capacity ? chunk.subarray(chunk.length - capacity) : chunk
+
+    const firstPart = Math.min(source.length, capacity - this.writeIndex)
+    this.samples.set(source.subarray(0, firstPart), this.writeIndex)
+    this.samples.set(source.subarray(firstPart), 0)
+
+    this.writeIndex = (this.writeIndex + source.length) % capacity
+    this.length = Math.min(capacity, this.length + source.length)
+  }
+
+  /**
+   * Copy out the buffered samples in order and empty the ring
+   */
+  drain(): Int16Array {
+    const capacity = this.samples.length
+    const start = (this.writeIndex - this.length + capacity) % capacity
+    const out = new Int16Array(this.length)
+
+    const firstPart = Math.min(this.length, capacity - start)
+    out.set(this.samples.subarray(start, start + firstPart), 0)
+    out.set(this.samples.subarray(0, this.length - firstPart), firstPart)
+
+    this.reset()
+    return out
+  }
+
+  reset(): void {
+    this.writeIndex = 0
+    this.length = 0
+  }
+}
+
+export interface CaptureCallbacks {
+  onLevel?: (level: number) => void // RMS in 0..1
+  onError?: (message: string) => void
+}
+
+export interface CapturedAudio {
+  samples: Int16Array
+  health: CaptureHealth
+}
+
+export interface KeywordListenOptions {
+  modelPath: string
+  threshold: number
+  onKeyword: (score: number) => void
+  onError: (message: string) => void
+}
+
+let ringBuffer: PcmRingBuffer | null = null
+let capturing = false
+let lastLevelAt = 0
+let health: CaptureHealthTracker | null = null
+let callbacks: CaptureCallbacks = {}
+// The open listening session, if any
+let listening: { backend: CaptureBackend; onError: (message: string) => void } | null = null
+
+// Chunks only arrive while delivering, so always for the current dictation
+const handleChunk = (samples: Int16Array, info: CaptureChunkInfo): void => {
+  if (!capturing) return
+  ringBuffer?.write(samples)
+  health?.addChunk(samples, info)
+
+  const now = Date.now()
+  if (callbacks.onLevel && now - lastLevelAt >= LEVEL_INTERVAL_MS) {
+    lastLevelAt = now
+    let sum = 0
+    for (let i = 0; i < samples.length; i++) sum += samples[i] * samples[i]
+    callbacks.onLevel(Math.sqrt(sum / Math.max(1, samples.length)) / 32768)
+  }
+}
+
+const handleError = (message: string): void => {
+  log.error(() => `Native capture failed: ${message}`)
+  // The capture thread has exited - the device is closed either way
+  const listener = listening
+  listening = null
+  if (capturing) callbacks.onError?.(message)
+  listener?.onError(message)
+}
+
+/**
+ * Whether the native capture backend can be used on this machine
+ */
+export function isMainCaptureAvailable(): boolean {
+  return getNativeCapabilities().capture.length > 0
+}
+
+export function isMainCaptureActive(): boolean {
+  return capturing
+}
+
+/**
+ * Start recording into the ring buffer; returns the backend, or null if capture failed
+ * requestedAt (performance.now() of the hotkey) is where start latency is measured from.
+ * When listening, the recording starts prerollMs before the last keyword detection
+ */
+export function startMainCapture(
+  captureCallbacks: CaptureCallbacks = {},
+  requestedAt = performance.now(),
+  prerollMs = 0
+): CaptureBackend | null {
+  if (capturing) return null
+
+  ringBuffer ??= new PcmRingBuffer(CAPTURE_SAMPLE_RATE * MAX_RECORDING_SECONDS)
+  ringBuffer.reset()
+  callbacks = captureCallbacks
+
+  try {
+    let backend: CaptureBackend
+    if (listening) {
+      resumeNativeCapture(prerollMs)
+      backend = listening.backend
+    } else {
+      backend = startNativeCapture(
+        { sampleRate: CAPTURE_SAMPLE_RATE, frameMs: CAPTURE_FRAME_MS },
+        handleChunk,
+        handleError
+      )
+    }
+    // The capture thread only starts delivering once this call has returned
+    health = new CaptureHealthTracker(backend, CAPTURE_SAMPLE_RATE, CAPTURE_FRAME_MS, requestedAt)
+    capturing = true
+    log.info(() => `Recording via ${backend}`)
+    return backend
+  } catch (error) {
+    log.error('Failed to start native capture', () => errorFields(error))
+    return null
+  }
+}
+
+/**
+ * Stop recording (after a short trailing window) and return the captured PCM and its health
+ */
+export async function stopMainCapture(trailingMs = TRAILING_CAPTURE_MS): Promise<CapturedAudio | null> {
+  if (!capturing) return null
+
+  await new Promise((resolve) => setTimeout(resolve, trailingMs))
+  releaseDevice()
+  capturing = false
+
+  const tracker = health
+  health = null
+  if (!ringBuffer || !tracker) return null
+  return { samples: ringBuffer.drain(), health: tracker.finish() }
+}
+
+/**
+ * Stop without keeping the audio (Escape / app quit)
+ */
+export function cancelMainCapture(): void {
+  if (!capturing) return
+  releaseDevice()
+  capturing = false
+  health = null
+  ringBuffer?.reset()
+}
+
+// After a dictation: back to listening, or close the device
+const releaseDevice = (): void => {
+  if (listening) pauseNativeCapture()
+  else stopNativeCapture()
+}
+
+/**
+ * Open the device listening for the keyword; returns the backend, or null if it failed
+ * Audio stays in the native module until a detection starts a dictation
+ */
+export function startKeywordListening(options: KeywordListenOptions): CaptureBackend | null {
+  if (capturing) return null // The caller retries once the dictation is over
+  stopKeywordListening()
+  try {
+    const backend = startNativeCapture(
+      {
+        sampleRate: CAPTURE_SAMPLE_RATE,
+        frameMs: CAPTURE_FRAME_MS,
+        keywordModel: options.modelPath,
+        keywordThreshold: options.threshold
+      },
+      handleChunk,
+      handleError,
+      options.onKeyword
+    )
+    listening = { backend, onError: options.onError }
+    log.info(() => `Listening for the keyword via ${backend}`)
+    return backend
+  } catch (error) {
+    log.error('Failed to start keyword listening', () => errorFields(error))
+    return null
+  }
+}
+
+/**
+ * Stop listening; a dictation in progress keeps recording and closes the device when done
+ */
+export function stopKeywordListening(): void {
+  if (!listening) return
+  listening = null
+  if (!capturing) stopNativeCapture()
+}
+
+export function isKeywordListening(): boolean {
+  return listening !== null
+}
@@ -0,0 +1,383 @@
+// Streaming speaker diarization for long-form notes
+// Audio is pushed in arbitrary chunks and never kept: each 10ms frame becomes a
+// cepstral vector (MFCC), each second of speech becomes a speaker embedding (mean and
+// spread of its cepstra, standardized against the recording so far), and embeddings
+// are clustered online against at most MAX_SPEAKERS centroids. State is bounded by the
+// speaker count plus one turn per speaker change, whatever the recording length.
+// Cost is one 512-point FFT per frame - about 0.5% of real time
+
+export interface SpeakerTurn {
+  speaker: number // 0-based, in order of first appearance
+  startMs: number
+  endMs: number
+}
+
+export interface DiarizationResult {
+  speakers: number
+  turns: SpeakerTurn[]
+  processingMs: number // CPU spent in push()/finish(), to compare against the audio length
+}
+
+const SAMPLE_RATE = 16000
+const FRAME_LENGTH = 400 // 25ms analysis window
+const FRAME_HOP = 160 // 10ms
+const FFT_SIZE = 512
+const MEL_FILTERS = 26
+const CEPSTRA = 12 // c1..c12; c0 is loudness, not voice
+const MEL_LOW_HZ = 80
+const MEL_HIGH_HZ = 7600
+const PRE_EMPHASIS = 0.97
+
+const BLOCK_FRAMES = 100 // One embedding per second of audio
+const MIN_SPEECH_FRAMES = 40 // Blocks with less speech than this are not embedded
+const SPEECH_MARGIN_DB = 12 // Over the running noise floor
+const MIN_SPEECH_DBFS = -55
+
+const MAX_SPEAKERS = 6
+const NEW_SPEAKER_SIMILARITY = 0 // Below this (cosine) against every centroid -> new speaker
+const MERGE_SIMILARITY = 0.5 // Centroids this close are one speaker split early on
+// Standardization stretches whatever variation there is - with a single voice that is
+// just phonetic content. Two speakers also have to be this far apart in raw cepstra
+const MIN_SPEAKER_DISTANCE = 20
+const WARMUP_BLOCKS = 3 // Standardization stats settle before new speakers are opened
+const MIN_TURN_MS = 2000 // Shorter turns fold into their neighbour
+
+// Shared analysis tables
+const window = Float64Array.from({ length: FRAME_LENGTH }, (_, i) => 0.54 - 0.46 * Math.cos((2 * Math.PI * i) / (FRAME_LENGTH - 1)))
+
+const hzToMel = (hz: number): number => 2595 * Math.log10(1 + hz / 700)
+const melToHz = (mel: number): number => 700 * (10 ** (mel / 2595) - 1)
+
+// Triangular filters over FFT bins: [firstBin, weights[]] each
+const melFilters: { first: number; weights: Float64Array }[] = (() => {
+  const low = hzToMel(MEL_LOW_HZ)
+  const high = hzToMel(MEL_HIGH_HZ)
+  const bins = Array.from({ length: MEL_FILTERS + 2 }, (_, i) =>
+    Math.floor(((FFT_SIZE + 1) * melToHz(low + ((high - low) * i) / (MEL_FILTERS + 1))) / SAMPLE_RATE)
+  )
+  return Array.from({ length: MEL_FILTERS }, (_, m) => {
+    const [left, center, right] = [bins[m], bins[m + 1], bins[m + 2]]
+    const weights = new Float64Array(Math.max(1, right - left))
+    for (let k = left; k < right; k++) {
+      weights[k - left] = k < center ? (k - left) / Math.max(1, center - left) : (right - k) / Math.max(1, right - center)
+    }
+    return { first: left, weights }
+  })
+})()
+
+const dct = Float64Array.from({ length: CEPSTRA * MEL_FILTERS }, (_, index) => {
+  const c = Math.floor(index / MEL_FILTERS) + 1
+  const m = index % MEL_FILTERS
+  return Math.cos((Math.PI * c * (m + 0.5)) / MEL_FILTERS)
+})
+
+const bitReversed = Uint16Array.from({ length: FFT_SIZE }, (_, i) => {
+  let reversed = 0
+  for (let bit = 1, shift = FFT_SIZE >> 1; bit < FFT_SIZE; bit <<= 1, shift >>= 1) {
+    if (i & bit) reversed |= shift
+  }
+  return reversed
+})
+
+const twiddleCos = Float64Array.from({ length: FFT_SIZE / 2 }, (_, k) => Math.cos((-2 * Math.PI * k) / FFT_SIZE))
+const twiddleSin = Float64Array.from({ length: FFT_SIZE / 2 }, (_, k) => Math.sin((-2 * Math.PI * k) / FFT_SIZE))
+
+// In-place radix-2 FFT
+const fft = (re: Float64Array, im: Float64Array): void => {
+  for (let i = 0; i < FFT_SIZE; i++) {
+    const j = bitReversed[i]
+    if (j > i) {
+      ;[re[i], re[j]] = [re[j], re[i]]
+      ;[im[i], im[j]] = [im[j], im[i]]
+    }
+  }
+  for (let size = 2; size <= FFT_SIZE; size <<= 1) {
+    const half = size >> 1
+    const stride = FFT_SIZE / size
+    for (let start = 0; start < FFT_SIZE; start += size) {
+      for (let k = 0; k < half; k++) {
+        const cos = twiddleCos[k * stride]
+        const sin = twiddleSin[k * stride]
+        const a = start + k
+        const b = a + half
+        const tr = re[b] * cos - im[b] * sin
+        const ti = re[b] * sin + im[b] * cos
+        re[b] = re[a] - tr
+        im[b] = im[a] - ti
+        re[a] += tr
+        im[a] += ti
+      }
+    }
+  }
+}
+
+const distance = (a: Float64Array, b: Float64Array): number => {
+  let sum = 0
+  for (let i = 0; i < a.length; i++) sum += (a[i] - b[i]) ** 2
+  return Math.sqrt(sum)
+}
+
+const cosine = (a: Float64Array, b: Float64Array): number => {
+  let dot = 0
+  let normA = 0
+  let normB = 0
+  for (let i = 0; i < a.length; i++) {
+    dot += a[i] * b[i]
+    normA += a[i] * a[i]
+    normB += b[i] * b[i]
+  }
+  return normA > 0 && normB > 0 ? dot / Math.sqrt(normA * normB) : 0
+}
+
+export class StreamingDiarizer {
+  // Frame assembly (one frame of carry-over between pushes)
+  private pending = new Float64Array(FRAME_LENGTH)
+  private pendingLength = 0
+  private previousSample = 0
+  private re = new Float64Array(FFT_SIZE)
+  private im = new Float64Array(FFT_SIZE)
+  private logMel = new Float64Array(MEL_FILTERS)
+  private frames = 0
+
+  // Current block
+  private blockFrames = 0
+  private blockSpeech = 0
+  private blockSum = new Float64Array(CEPSTRA)
+  private blockSquares = new Float64Array(CEPSTRA)
+  private noiseFloorDb = MIN_SPEECH_DBFS
+
+  // Running standardization of embeddings (Welford)
+  private embeddings = 0
+  private embeddingMean = new Float64Array(CEPSTRA * 2)
+  private embeddingM2 = new Float64Array(CEPSTRA * 2)
+
+  // A merged centroid keeps its slot and points at the one it joined
+  private centroids: { sum: Float64Array; count: number; mergedInto: number | null }[] = []
+  private turns: SpeakerTurn[] = []
+  private processingMs = 0
+
+  push(samples: Int16Array): void {
+    const started = performance.now()
+    for (let i = 0; i < samples.length; i++) {
+      const sample = samples[i] / 32768
+      this.pending[this.pendingLength++] = sample - PRE_EMPHASIS * this.previousSample
+      this.previousSample = sample
+      if (this.pendingLength === FRAME_LENGTH) {
+        this.analyzeFrame()
+        // Keep the overlap for the next frame
+        this.pending.copyWithin(0, FRAME_HOP)
+        this.pendingLength = FRAME_LENGTH - FRAME_HOP
+      }
+    }
+    this.processingMs += performance.now() - started
+  }
+
+  finish(): DiarizationResult {
+    const started = performance.now()
+    if (this.blockFrames > 0) this.closeBlock()
+    this.mergeCentroids()
+    const turns = this.smoothTurns()
+    this.processingMs += performance.now() - started
+
+    // Renumber by first appearance after smoothing dropped some speakers
+    const order = new Map<number, number>()
+    for (const turn of turns) if (!order.has(turn.speaker)) order.set(turn.speaker, order.size)
+    return {
+      speakers: order.size,
+      turns: turns.map((turn) => ({ ...turn, speaker: order.get(turn.speaker)! })),
+      processingMs: Math.round(this.processingMs)
+    }
+  }
+
+  private analyzeFrame(): void {
+    const { re, im } = this
+    let energy = 0
+    for (let i = 0; i < FRAME_LENGTH; i++) {
+      re[i] = this.pending[i] * window[i]
+      energy += this.pending[i] * this.pending[i]
+    }
+    re.fill(0, FRAME_LENGTH)
+    im.fill(0)
+
+    const levelDb = energy > 0 ? 10 * Math.log10(energy / FRAME_LENGTH) : -120
+    // Floor falls immediately and rises slowly, so it tracks pauses rather than speech
+    this.noiseFloorDb = levelDb < this.noiseFloorDb ? levelDb : this.noiseFloorDb + 0.01 * (levelDb - this.noiseFloorDb)
+    const speech = levelDb > Math.max(MIN_SPEECH_DBFS, this.noiseFloorDb + SPEECH_MARGIN_DB)
+
+    if (speech) {
+      fft(re, im)
+      const logMel = this.logMel
+      for (let m = 0; m < MEL_FILTERS; m++) {
+        const { first, weights } = melFilters[m]
+        let power = 0
+        for (let k = 0; k < weights.length; k++) {
+          const bin = first + k
+          power += weights[k] * (re[bin] * re[bin] + im[bin] * im[bin])
+        }
+        logMel[m] = Math.log(power + 1e-10)
+      }
+      for (let c = 0; c < CEPSTRA; c++) {
+        let value = 0
+        for (let m = 0; m < MEL_FILTERS; m++) value += dct[c * MEL_FILTERS + m] * logMel[m]
+        this.blockSum[c] += value
+        this.blockSquares[c] += value * value
+      }
+      this.blockSpeech++
+    }
+
+    this.frames++
+    if (++this.blockFrames === BLOCK_FRAMES) this.closeBlock()
+  }
+
+  private closeBlock(): void {
+    const endMs = this.frames * (FRAME_HOP / SAMPLE_RATE) * 1000
+    const startMs = endMs - this.blockFrames * (FRAME_HOP / SAMPLE_RATE) * 1000
+
+    if (this.blockSpeech >= MIN_SPEECH_FRAMES) {
+      const embedding = new Float64Array(CEPSTRA * 2)
+      for (let c = 0; c < CEPSTRA; c++) {
+        const mean = this.blockSum[c] / this.blockSpeech
+        embedding[c] = mean
+        embedding[CEPSTRA + c] = Math.sqrt(Math.max(0, this.blockSquares[c] / this.blockSpeech - mean * mean))
+      }
+      this.addTurn(this.assign(embedding), startMs, endMs)
+    }
+
+    this.blockFrames = 0
+    this.blockSpeech = 0
+    this.blockSum.fill(0)
+    this.blockSquares.fill(0)
+  }
+
+  private standardize(embedding: Float64Array): Float64Array {
+    return embedding.map((value, i) => {
+      const variance = this.embeddings > 1 ? this.embeddingM2[i] / (this.embeddings - 1) : 1
+      return (value - this.embeddingMean[i]) / Math.sqrt(variance || 1)
+    })
+  }
+
+  // Nearest centroid, or a new speaker when nothing is close
+  private assign(embedding: Float64Array): number {
+    this.embeddings++
+    for (let i = 0; i < embedding.length; i++) {
+      const delta = embedding[i] - this.embeddingMean[i]
+      this.embeddingMean[i] += delta / this.embeddings
+      this.embeddingM2[i] += delta * (embedding[i] - this.embeddingMean[i])
+    }
+
+    const standardized = this.standardize(embedding)
+    let best = -1
+    let bestSimilarity = -Infinity
+    let nearestDistance = Infinity
+    this.centroids.forEach((centroid, index) => {
+      if (centroid.mergedInto !== null) return
+      const mean = centroid.sum.map((v) => v / centroid.count)
+      const similarity = cosine(standardized, this.standardize(mean))
+      if (similarity > bestSimilarity) {
+        best = index
+        bestSimilarity = similarity
+      }
+      nearestDistance = Math.min(nearestDistance, distance(embedding, mean))
+    })
+
+    const active = this.centroids.filter((centroid) => centroid.mergedInto === null).length
+    const canOpen =
+      active < MAX_SPEAKERS && this.embeddings > WARMUP_BLOCKS && nearestDistance > MIN_SPEAKER_DISTANCE
+    if (best < 0 || (canOpen && bestSimilarity < NEW_SPEAKER_SIMILARITY)) {
+      this.centroids.push({ sum: Float64Array.from(embedding), count: 1, mergedInto: null })
+      this.mergeCentroids()
+      return this.centroids.length - 1
+    }
+    const centroid = this.centroids[best]
+    for (let i = 0; i < embedding.length; i++) centroid.sum[i] += embedding[i]
+    centroid.count++
+    return best
+  }
+
+  // Standardization stats keep moving as more voices are heard, so speakers opened
+  // early can turn out to be one; fold them together
+  private mergeCentroids(): void {
+    for (let a = 0; a < this.centroids.length; a++) {
+      const keep = this.centroids[a]
+      if (keep.mergedInto !== null) continue
+      for (let b = a + 1; b < this.centroids.length; b++) {
+        const other = this.centroids[b]
+        if (other.mergedInto !== null) continue
+        const keepMean = keep.sum.map((v) => v / keep.count)
+        const otherMean = other.sum.map((v) => v / other.count)
+        const similarity = cosine(this.standardize(keepMean), this.standardize(otherMean))
+        if (similarity < MERGE_SIMILARITY && distance(keepMean, otherMean) > MIN_SPEAKER_DISTANCE) continue
+        for (let i = 0; i < keep.sum.length; i++) keep.sum[i] += other.sum[i]
+        keep.count += other.count
+        other.mergedInto = a
+      }
+    }
+  }
+
+  private resolve(speaker: number): number {
+    let current = speaker
+    while (this.centroids[current]?.mergedInto != null) current = this.centroids[current].mergedInto!
+    return current
+  }
+
+  private addTurn(speaker: number, startMs: number, endMs: number): void {
+    const last = this.turns[this.turns.length - 1]
+    if (last && this.resolve(last.speaker) === this.resolve(speaker)) {
+      last.endMs = endMs
+    } else {
+      // Pauses between turns belong to the earlier speaker
+      if (last) last.endMs = startMs
+      this.turns.push({ speaker, startMs, endMs })
+    }
+  }
+
+  // Fold turns too short to be a real change into the previous (or next) turn
+  private smoothTurns(): SpeakerTurn[] {
+    const turns: SpeakerTurn[] = []
+    for (const raw of this.turns) {
+      const turn = { ...raw, speaker: this.resolve(raw.speaker) }
+      const last = turns[turns.length - 1]
+      if (last && (last.speaker === turn.speaker || turn.endMs - turn.startMs < MIN_TURN_MS)) {
+        last.endMs = turn.endMs
+      } else if (last && last.endMs - last.startMs < MIN_TURN_MS) {
+        // A short opening turn takes the next speaker
+        last.speaker = turn.speaker
+        last.endMs = turn.endMs
+      } else {
+        turns.push(turn)
+      }
+    }
+    return turns
+  }
+}
+
+// Transcript text with its position in the recording
+export interface TimedText {
+  startMs: number
+  endMs: number
+  text: string
+}
+
+/**
+ * Label a transcript by speaker: each segment goes to the turn it overlaps most (or
+ * the nearest one), and consecutive segments of one speaker become one paragraph
+ */
+export function labelTranscript(segments: TimedText[], turns: SpeakerTurn[]): string {
+  const paragraphs: { speaker: number; text: string[] }[] = []
+  for (const segment of segments) {
+    if (!segment.text) continue
+    let best = turns[0]
+    let bestScore = -Infinity
+    for (const turn of turns) {
+      const overlap = Math.min(segment.endMs, turn.endMs) - Math.max(segment.startMs, turn.startMs)
+      if (overlap > bestScore) {
+        best = turn
+        bestScore = overlap
+      }
+    }
+    const last = paragraphs[paragraphs.length - 1]
+    if (last && last.speaker === best.speaker) last.text.push(segment.text)
+    else paragraphs.push({ speaker: best.speaker, text: [segment.text] })
+  }
+  return paragraphs.map((p) => `Speaker ${p.speaker + 1}: ${p.text.join(' ')}`).join('\n\n')
+}
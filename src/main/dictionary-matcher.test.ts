@@ -0,0 +1,57 @@
+import { test } from 'node:test'
+import assert from 'node:assert/strict'
+import { DictionaryMatcher, normalizeTerm } from './dictionary-matcher'
+import type { DictionaryEntry } from './dictionary-matcher'
+
+const entry = (term: string, replacement = term): DictionaryEntry => ({
+  key: normalizeTerm(term),
+  term,
+  replacement
+})
+
+const terms = (entries: DictionaryEntry[]): string[] => entries.map((e) => e.term).sort()
+
+test('terms normalize to lowercase words without punctuation', () => {
+  assert.equal(normalizeTerm('Wisp  Err!'), 'wisp err')
+})
+
+test('multi-word terms match only as whole-word sequences', () => {
+  const matcher = new DictionaryMatcher()
+  matcher.apply({ op: 'reset', entries: [entry('Kubernetes'), entry('New York'), entry('York')] })
+
+  assert.deepEqual(terms(matcher.match('Deploying to kubernetes in New York.')), [
+    'Kubernetes',
+    'New York',
+    'York'
+  ])
+  assert.deepEqual(terms(matcher.match('A new yorkshire terrier')), [])
+})
+
+test('upserts and deletes update the match set incrementally', () => {
+  const matcher = new DictionaryMatcher()
+  matcher.apply({ op: 'upsert', entries: [entry('GraphQL'), entry('gRPC')] })
+  assert.equal(matcher.entryCount, 2)
+
+  matcher.apply({ op: 'upsert', entries: [entry('GraphQL', 'GraphQL!')] })
+  assert.equal(matcher.entryCount, 2)
+  assert.equal(matcher.match('graphql please')[0].replacement, 'GraphQL!')
+
+  matcher.apply({ op: 'delete', keys: [normalizeTerm('gRPC')] })
+  assert.equal(matcher.entryCount, 1)
+  assert.equal(matcher.match('grpc and graphql').length, 1)
+})
+
+test('a reset replaces every earlier entry', () => {
+  const matcher = new DictionaryMatcher()
+  matcher.apply({ op: 'upsert', entries: [entry('Postgres')] })
+  matcher.apply({ op: 'reset', entries: [entry('Redis')] })
+  assert.deepEqual(terms(matcher.match('postgres or redis')), ['Redis'])
+})
+
+test('text in unspaced scripts matches by substring', () => {
+  const matcher = new DictionaryMatcher()
+  matcher.apply({ op: 'reset', entries: [entry('東京タワー'), entry('กรุงเทพ'), entry('大阪')] })
+
+  assert.deepEqual(terms(matcher.match('明日は東京タワーに行きます')), ['東京タワー'])
+  assert.deepEqual(terms(matcher.match('ฉันอยู่ที่กรุงเทพมหานคร')), ['กรุงเทพ'])
+})
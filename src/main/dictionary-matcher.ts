@@ -0,0 +1,131 @@
+import { UNSPACED_SCRIPT } from './text-segmentation'
+
+// Personal dictionary matcher - finds which dictionary terms occur in a transcript
+// Pure module (no Electron) so it runs in the pipeline utility process
+// Entries are bucketed by their first token, so a mutation only touches one bucket
+// and matching costs one lookup per transcript token regardless of dictionary size
+// Text in a script written without spaces (CJK, Thai...) has no word tokens to look up,
+// so it falls back to substring matching against every entry
+
+export interface DictionaryEntry {
+  key: string // Normalized term - the store is indexed by this
+  term: string
+  replacement: string
+}
+
+// Change events pushed to subscribed windows and the pipeline worker
+export type DictionaryChange =
+  | { op: 'upsert'; entries: DictionaryEntry[] }
+  | { op: 'delete'; keys: string[] }
+  | { op: 'reset'; entries: DictionaryEntry[] }
+
+const TOKEN_PATTERN = /[\p{L}\p{N}']+/gu
+
+/**
+ * Split text into lowercase word tokens (punctuation and spacing are ignored)
+ */
+export const tokenize = (text: string): string[] => {
+  return text.normalize('NFKC').toLowerCase().match(TOKEN_PATTERN) ?? []
+}
+
+/**
+ * Normalized form of a term, used as its key ("Wisp  Err!" -> "wisp err")
+ */
+export const normalizeTerm = (term: string): string => tokenize(term).join(' ')
+
+interface IndexedEntry {
+  tokens: string[]
+  compact: string // Tokens without separators, for substring matching
+  entry: DictionaryEntry
+}
+
+export class DictionaryMatcher {
+  // first token -> (key -> entry)
+  private buckets: Map<string, Map<string, IndexedEntry>> = new Map()
+  private size = 0
+
+  get entryCount(): number {
+    return this.size
+  }
+
+  upsert(entry: DictionaryEntry): void {
+    const tokens = entry.key.split(' ')
+    if (!tokens[0]) return
+
+    let bucket = this.buckets.get(tokens[0])
+    if (!bucket) {
+      bucket = new Map()
+      this.buckets.set(tokens[0], bucket)
+    }
+    if (!bucket.has(entry.key)) this.size++
+    bucket.set(entry.key, { tokens, compact: tokens.join(''), entry })
+  }
+
+  delete(key: string): void {
+    const first = key.split(' ')[0]
+    const bucket = this.buckets.get(first)
+    if (!bucket?.delete(key)) return
+
+    this.size--
+    if (bucket.size === 0) this.buckets.delete(first)
+  }
+
+  apply(change: DictionaryChange): void {
+    switch (change.op) {
+      case 'reset':
+        this.buckets.clear()
+        this.size = 0
+        change.entries.forEach((entry) => this.upsert(entry))
+        break
+      case 'upsert':
+        change.entries.forEach((entry) => this.upsert(entry))
+        break
+      case 'delete':
+        change.keys.forEach((key) => this.delete(key))
+        break
+    }
+  }
+
+  /**
+   * Entries whose term appears in the text as a whole-word sequence (or as a substring,
+   * when the text is in an unspaced script)
+   */
+  match(text: string): DictionaryEntry[] {
+    if (this.size === 0) return []
+    if (UNSPACED_SCRIPT.test(text)) return this.matchSubstrings(text)
+
+    const tokens = tokenize(text)
+    const found: Map<string, DictionaryEntry> = new Map()
+
+    for (let i = 0; i < tokens.length; i++) {
+      const bucket = this.buckets.get(tokens[i])
+      if (!bucket) continue
+
+      for (const { tokens: termTokens, entry } of bucket.values()) {
+        if (found.has(entry.key) || i + termTokens.length > tokens.length) continue
+
+        let matches = true
+        for (let j = 1; j < termTokens.length; j++) {
+          if (tokens[i + j] !== termTokens[j]) {
+            matches = false
+            break
+          }
+        }
+        if (matches) found.set(entry.key, entry)
+      }
+    }
+
+    return [...found.values()]
+  }
+
+  private matchSubstrings(text: string): DictionaryEntry[] {
+    const compact = tokenize(text).join('')
+    const found: DictionaryEntry[] = []
+    for (const bucket of this.buckets.values()) {
+      for (const { compact: term, entry } of bucket.values()) {
+        if (compact.includes(term)) found.push(entry)
+      }
+    }
+    return found
+  }
+}
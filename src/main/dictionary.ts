@@ -0,0 +1,285 @@
+import { app } from 'electron'
+import { join, extname } from 'path'
+import { readFileSync, writeFileSync, existsSync, copyFileSync, createReadStream } from 'fs'
+import { createInterface } from 'readline'
+import { EventEmitter } from 'events'
+import { encryptData, decryptData, detectStorageVersion } from './encryption'
+import { normalizeTerm } from './dictionary-matcher'
+import type { DictionaryEntry, DictionaryChange } from './dictionary-matcher'
+import { createLogger, errorFields } from './logger'
+
+export type { DictionaryEntry, DictionaryChange } from './dictionary-matcher'
+
+// Personal dictionary store, indexed by normalized term
+// Kept out of settings.json so a single edit doesn't rewrite every setting
+
+const DICTIONARY_FILE = 'dictionary.json'
+const IMPORT_BATCH_SIZE = 5000 // Rows per change event during a bulk import
+
+const log = createLogger('Dictionary')
+
+export interface DictionaryImportResult {
+  added: number
+  updated: number
+  skipped: number
+}
+
+// Emits 'change' with a DictionaryChange after every successful mutation
+export const dictionaryEvents = new EventEmitter()
+
+// Decrypted dictionary kept in memory (insertion order is display order)
+let dictionaryCache: Map<string, DictionaryEntry> | null = null
+
+// Serializes read-modify-write cycles so concurrent edits don't drop entries
+let mutationQueue: Promise<unknown> = Promise.resolve()
+const enqueueMutation = <T>(mutation: () => Promise<T>): Promise<T> => {
+  const run = mutationQueue.then(mutation)
+  mutationQueue = run.catch(() => undefined)
+  return run
+}
+
+const getDictionaryPath = (): string => {
+  return join(app.getPath('userData'), DICTIONARY_FILE)
+}
+
+const createEntry = (term: string, replacement: string): DictionaryEntry | null => {
+  const key = normalizeTerm(term)
+  const trimmedReplacement = replacement.trim()
+  if (!key || !trimmedReplacement) return null
+  return { key, term: term.trim(), replacement: trimmedReplacement }
+}
+
+const toMap = (entries: DictionaryEntry[]): Map<string, DictionaryEntry> => {
+  return new Map(entries.map((entry) => [entry.key, entry]))
+}
+
+const loadDictionaryMap = async (): Promise<Map<string, DictionaryEntry>> => {
+  if (dictionaryCache) return dictionaryCache
+
+  const path = getDictionaryPath()
+  if (!existsSync(path)) {
+    dictionaryCache = new Map()
+    return dictionaryCache
+  }
+  try {
+    const parsed = JSON.parse(readFileSync(path, 'utf-8'))
+    if (detectStorageVersion(parsed) === 1) {
+      dictionaryCache = toMap(Array.isArray(parsed) ? parsed : [])
+    } else {
+      try {
+        dictionaryCache = toMap(await decryptData(parsed.data))
+      } catch (error) {
+        log.error('Decryption failed', () => errorFields(error))
+
+        // Create backup of corrupted file
+        const backupPath = path + '.corrupted.' + Date.now()
+        copyFileSync(path, backupPath)
+        log.error('Corrupted file backed up', { backupPath })
+
+        dictionaryCache = new Map()
+      }
+    }
+  } catch (error) {
+    log.error('Failed to load dictionary', () => errorFields(error))
+    dictionaryCache = new Map()
+  }
+  return dictionaryCache
+}
+
+// Throws when the write fails, so no change is published for it; the unsaved edit is
+// dropped from memory along with the cache, which reloads from disk
+const saveDictionary = async (dictionary: Map<string, DictionaryEntry>): Promise<void> => {
+  try {
+    const encrypted = await encryptData([...dictionary.values()])
+    const wrapper = { version: 2 as const, data: encrypted }
+    writeFileSync(getDictionaryPath(), JSON.stringify(wrapper), 'utf-8')
+    log.debug(() => `Saved ${dictionary.size} encrypted entries`)
+  } catch (error) {
+    log.error('Failed to save dictionary', () => errorFields(error))
+    dictionaryCache = null
+    throw error
+  }
+}
+
+export const loadDictionary = async (): Promise<DictionaryEntry[]> => {
+  return [...(await loadDictionaryMap()).values()]
+}
+
+/**
+ * Add an entry, replacing any entry with the same normalized term
+ */
+export const addDictionaryEntry = (
+  term: string,
+  replacement: string
+): Promise<DictionaryEntry | null> =>
+  enqueueMutation(async () => {
+    const entry = createEntry(term, replacement)
+    if (!entry) return null
+
+    const dictionary = await loadDictionaryMap()
+    dictionary.set(entry.key, entry)
+    await saveDictionary(dictionary)
+
+    const change: DictionaryChange = { op: 'upsert', entries: [entry] }
+    dictionaryEvents.emit('change', change)
+    return entry
+  })
+
+/**
+ * Replace the entry stored under `key` (the term itself may change)
+ */
+export const updateDictionaryEntry = (
+  key: string,
+  term: string,
+  replacement: string
+): Promise<DictionaryEntry | null> =>
+  enqueueMutation(async () => {
+    const entry = createEntry(term, replacement)
+    const dictionary = await loadDictionaryMap()
+    if (!entry || !dictionary.has(key)) return null
+
+    const renamed = entry.key !== key
+    if (renamed) dictionary.delete(key)
+    dictionary.set(entry.key, entry)
+    await saveDictionary(dictionary)
+
+    if (renamed) {
+      const removed: DictionaryChange = { op: 'delete', keys: [key] }
+      dictionaryEvents.emit('change', removed)
+    }
+    const change: DictionaryChange = { op: 'upsert', entries: [entry] }
+    dictionaryEvents.emit('change', change)
+    return entry
+  })
+
+export const deleteDictionaryEntry = (key: string): Promise<void> =>
+  enqueueMutation(async () => {
+    const dictionary = await loadDictionaryMap()
+    if (!dictionary.delete(key)) return
+
+    await saveDictionary(dictionary)
+
+    const change: DictionaryChange = { op: 'delete', keys: [key] }
+    dictionaryEvents.emit('change', change)
+  })
+
+/**
+ * Split one CSV/TSV line into fields (quoted fields with "" escapes are supported,
+ * fields spanning several lines are not)
+ */
+const parseDelimitedLine = (line: string, delimiter: string): string[] => {
+  const fields: string[] = []
+  let field = ''
+  let quoted = false
+
+  for (let i = 0; i < line.length; i++) {
+    const char = line[i]
+    if (quoted) {
+      if (char === '"' && line[i + 1] === '"') {
+        field += '"'
+        i++
+      } else if (char === '"') {
+        quoted = false
+      } else {
+        field += char
+      }
+    } else if (char === '"' && field === '') {
+      quoted = true
+    } else if (char === delimiter) {
+      fields.push(field)
+      field = ''
+    } else {
+      field += char
+    }
+  }
+  fields.push(field)
+  return fields
+}
+
+/**
+ * Stream a CSV or TSV file of `term,replacement` rows into the dictionary
+ * Rows are read line by line, so memory stays flat regardless of file size;
+ * the file is written once at the end, and only then are changes published in batches
+ */
+export const importDictionaryFile = (filePath: string): Promise<DictionaryImportResult> =>
+  enqueueMutation(async () => {
+    const dictionary = await loadDictionaryMap()
+    const result: DictionaryImportResult = { added: 0, updated: 0, skipped: 0 }
+
+    let delimiter = extname(filePath).toLowerCase() === '.tsv' ? '\t' : null
+    let batch: DictionaryEntry[] = []
+    const batches: DictionaryEntry[][] = [] // Entries are shared with the dictionary map
+    let firstRow = true
+
+    const flushBatch = (): void => {
+      if (batch.length === 0) return
+      batches.push(batch)
+      batch = []
+    }
+
+    const lines = createInterface({
+      input: createReadStream(filePath, { encoding: 'utf-8' }),
+      crlfDelay: Infinity
+    })
+
+    for await (const line of lines) {
+      if (!line.trim()) continue
+
+      // Sniff the delimiter from the first row when the extension doesn't say
+      if (!delimiter) delimiter = line.includes('\t') ? '\t' : ','
+
+      const [term = '', replacement = ''] = parseDelimitedLine(line.replace(/^\uFEFF/, ''), delimiter)
+
+      // Skip a "term,replacement" style header row
+      if (firstRow) {
+        firstRow = false
+        if (/^(term|word|phrase)$/i.test(term.trim())) continue
+      }
+
+      const entry = createEntry(term, replacement)
+      if (!entry) {
+        result.skipped++
+        continue
+      }
+
+      if (dictionary.has(entry.key)) {
+        result.updated++
+      } else {
+        result.added++
+      }
+      dictionary.set(entry.key, entry)
+      batch.push(entry)
+      if (batch.length >= IMPORT_BATCH_SIZE) flushBatch()
+    }
+
+    flushBatch()
+    await saveDictionary(dictionary)
+    for (const entries of batches) {
+      const change: DictionaryChange = { op: 'upsert', entries }
+      dictionaryEvents.emit('change', change)
+    }
+
+    log.info(() => `Imported ${filePath}`, () => ({ ...result }))
+    return result
+  })
+
+/**
+ * One-time move of entries that used to live in settings.dictionaryEntries
+ */
+export const migrateDictionaryFromSettings = (
+  legacyEntries: { term: string; replacement: string }[]
+): Promise<void> =>
+  enqueueMutation(async () => {
+    const dictionary = await loadDictionaryMap()
+    const entries = legacyEntries
+      .map((legacy) => createEntry(legacy.term || '', legacy.replacement || ''))
+      .filter((entry): entry is DictionaryEntry => entry !== null && !dictionary.has(entry.key))
+    if (entries.length === 0) return
+
+    entries.forEach((entry) => dictionary.set(entry.key, entry))
+    await saveDictionary(dictionary)
+    log.info(() => `Migrated ${entries.length} entries from settings`)
+
+    const change: DictionaryChange = { op: 'upsert', entries }
+    dictionaryEvents.emit('change', change)
+  })
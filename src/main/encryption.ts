@@ -2,7 +2,10 @@ import { app, safeStorage } from 'electron'
 import crypto from 'crypto'
 import { machineId } from 'node-machine-id'
 import { join } from 'path'
-import { readFileSync, writeFileSync, existsSync } from 'fs'
+import { readFileSync, writeFileSync, existsSync, unlinkSync } from 'fs'
+import { promisify } from 'util'
+import { compress, decompress, DEFAULT_CODEC, StorageCodec } from './storage-codec'
+import { createLogger, errorFields } from './logger'
 
 // Encryption configuration
 const ALGORITHM = 'aes-256-gcm'
@@ -10,14 +13,20 @@ const KEY_LENGTH = 32 // 256 bits
 const IV_LENGTH = 16 // 128 bits for GCM
 const PBKDF2_ITERATIONS = 100000
 const KEY_STORAGE_FILE = 'encryption-key.enc'
+const PREVIOUS_KEY_STORAGE_FILE = 'encryption-key.prev.enc' // Kept only while a key rotation runs
+
+const log = createLogger('Encryption')
 
 // Encrypted payload format
 export interface EncryptedPayload {
   version: 2
-  encrypted: string // hex-encoded ciphertext
+  encrypted: string // ciphertext, hex-encoded unless `encoding` says otherwise
   iv: string // hex-encoded initialization vector
   tag: string // hex-encoded auth tag
   timestamp: number
+  keyId?: string // fingerprint of the key used (absent on payloads written before key rotation)
+  codec?: StorageCodec // compression applied before encryption (absent = none)
+  encoding?: 'hex' | 'base64' // ciphertext encoding (absent = hex)
 }
 
 // Storage wrapper for version detection
@@ -26,9 +35,14 @@ export interface StorageWrapper<T> {
   data: T | EncryptedPayload
 }
 
+const pbkdf2 = promisify(crypto.pbkdf2)
+
 // Master key cache
 let masterKeyCache: Buffer | null = null
 
+// Previous master key, only set while a key rotation is in progress
+let previousKeyCache: Buffer | null = null
+
 /**
  * Get the path to the encryption key storage file
  */
@@ -36,6 +50,20 @@ const getKeyStoragePath = (): string => {
   return join(app.getPath('userData'), KEY_STORAGE_FILE)
 }
 
+/**
+ * Get the path to the previous (pre-rotation) key storage file
+ */
+const getPreviousKeyStoragePath = (): string => {
+  return join(app.getPath('userData'), PREVIOUS_KEY_STORAGE_FILE)
+}
+
+/**
+ * Short fingerprint of a key, stored in payloads so reads can pick the right key
+ */
+export const getKeyId = (key: Buffer): string => {
+  return crypto.createHash('sha256').update(key).digest('hex').slice(0, 16)
+}
+
 /**
  * Generate a master encryption key from machine ID
  * Uses PBKDF2 with machine ID + platform as input
@@ -45,7 +73,8 @@ const generateMasterKey = async (): Promise<Buffer> => {
     const id = await machineId()
     const salt = crypto.createHash('sha256').update(id + process.platform).digest()
 
-    return crypto.pbkdf2Sync(
+    // Async so first-run key derivation doesn't block the main thread during startup
+    return await pbkdf2(
       id + process.platform, // input
       salt.slice(0, 16), // salt (first 16 bytes)
       PBKDF2_ITERATIONS,
@@ -53,7 +82,7 @@ const generateMasterKey = async (): Promise<Buffer> => {
       'sha256'
     )
   } catch (error) {
-    console.error('[Encryption] Failed to generate master key:', error)
+    log.error('Failed to generate master key', () => errorFields(error))
     throw new Error('Failed to generate encryption key')
   }
 }
@@ -61,23 +90,24 @@ const generateMasterKey = async (): Promise<Buffer> => {
 /**
  * Store master key in OS keychain using safeStorage
  */
-export const storeMasterKey = async (key: Buffer): Promise<void> => {
+export const storeMasterKey = async (
+  key: Buffer,
+  keyPath: string = getKeyStoragePath()
+): Promise<void> => {
   try {
     if (!safeStorage.isEncryptionAvailable()) {
-      console.warn('[Encryption] safeStorage not available, storing key in file')
+      log.warn('safeStorage not available, storing key in file')
       // Fallback: store encrypted key in file
-      const keyPath = getKeyStoragePath()
       writeFileSync(keyPath, key.toString('base64'), 'utf-8')
       return
     }
 
     const encrypted = safeStorage.encryptString(key.toString('base64'))
-    const keyPath = getKeyStoragePath()
     writeFileSync(keyPath, encrypted)
 
-    console.log('[Encryption] Master key stored securely')
+    log.info('Master key stored securely')
   } catch (error) {
-    console.error('[Encryption] Failed to store master key:', error)
+    log.error('Failed to store master key', () => errorFields(error))
     throw error
   }
 }
@@ -85,10 +115,10 @@ export const storeMasterKey = async (key: Buffer): Promise<void> => {
 /**
  * Retrieve master key from OS keychain
  */
-const retrieveStoredKey = async (): Promise<Buffer | null> => {
+const retrieveStoredKey = async (
+  keyPath: string = getKeyStoragePath()
+): Promise<Buffer | null> => {
   try {
-    const keyPath = getKeyStoragePath()
-
     if (!existsSync(keyPath)) {
       return null
     }
@@ -104,7 +134,7 @@ const retrieveStoredKey = async (): Promise<Buffer | null> => {
     const decrypted = safeStorage.decryptString(encrypted)
     return Buffer.from(decrypted, 'base64')
   } catch (error) {
-    console.error('[Encryption] Failed to retrieve stored key:', error)
+    log.error('Failed to retrieve stored key', () => errorFields(error))
     return null
   }
 }
@@ -124,12 +154,12 @@ export const getMasterKey = async (): Promise<Buffer> => {
 
   if (storedKey) {
     masterKeyCache = storedKey
-    console.log('[Encryption] Using stored master key')
+    log.info('Using stored master key')
     return storedKey
   }
 
   // Generate new key
-  console.log('[Encryption] Generating new master key')
+  log.info('Generating new master key')
   const newKey = await generateMasterKey()
 
   // Store the key
@@ -141,6 +171,38 @@ export const getMasterKey = async (): Promise<Buffer> => {
   return newKey
 }
 
+/**
+ * Get the previous master key if a key rotation is in progress
+ */
+export const getPreviousKey = async (): Promise<Buffer | null> => {
+  if (previousKeyCache) {
+    return previousKeyCache
+  }
+
+  if (!existsSync(getPreviousKeyStoragePath())) {
+    return null
+  }
+
+  previousKeyCache = await retrieveStoredKey(getPreviousKeyStoragePath())
+  return previousKeyCache
+}
+
+/**
+ * Forget the previous master key once every store has been re-encrypted
+ */
+export const discardPreviousKey = (): void => {
+  previousKeyCache = null
+  try {
+    const keyPath = getPreviousKeyStoragePath()
+    if (existsSync(keyPath)) {
+      unlinkSync(keyPath)
+    }
+    log.info('Previous master key discarded')
+  } catch (error) {
+    log.error('Failed to discard previous key', () => errorFields(error))
+  }
+}
+
 /**
  * Encrypt data using AES-256-GCM
  */
@@ -150,67 +212,98 @@ export const encryptData = async (data: any): Promise<EncryptedPayload> => {
     const iv = crypto.randomBytes(IV_LENGTH)
     const cipher = crypto.createCipheriv(ALGORITHM, key, iv)
 
-    // Convert data to JSON string
-    const plaintext = JSON.stringify(data)
+    // Serialize and compress before encrypting - ciphertext doesn't compress
+    const plaintext = compress(Buffer.from(JSON.stringify(data), 'utf8'), DEFAULT_CODEC)
 
     // Encrypt
-    let encrypted = cipher.update(plaintext, 'utf8', 'hex')
-    encrypted += cipher.final('hex')
+    const encrypted = Buffer.concat([cipher.update(plaintext), cipher.final()])
 
     // Get authentication tag
     const tag = cipher.getAuthTag()
 
     return {
       version: 2,
-      encrypted,
+      encrypted: encrypted.toString('base64'),
       iv: iv.toString('hex'),
       tag: tag.toString('hex'),
-      timestamp: Date.now()
+      timestamp: Date.now(),
+      keyId: getKeyId(key),
+      codec: DEFAULT_CODEC,
+      encoding: 'base64'
     }
   } catch (error) {
-    console.error('[Encryption] Encryption failed:', error)
+    log.error('Encryption failed', () => errorFields(error))
     throw new Error('Failed to encrypt data')
   }
 }
 
+/**
+ * Decrypt a payload with a single key (throws on auth failure)
+ */
+const decryptWithKey = (payload: EncryptedPayload, key: Buffer): any => {
+  const decipher = crypto.createDecipheriv(ALGORITHM, key, Buffer.from(payload.iv, 'hex'))
+
+  // Set authentication tag
+  decipher.setAuthTag(Buffer.from(payload.tag, 'hex'))
+
+  // Decrypt
+  const ciphertext = Buffer.from(payload.encrypted, payload.encoding || 'hex')
+  const decrypted = Buffer.concat([decipher.update(ciphertext), decipher.final()])
+
+  // Decompress and parse JSON
+  return JSON.parse(decompress(decrypted, payload.codec).toString('utf8'))
+}
+
 /**
  * Decrypt data using AES-256-GCM
+ * During a key rotation both the current and the previous key are accepted
  */
 export const decryptData = async (payload: EncryptedPayload): Promise<any> => {
   try {
     const key = await getMasterKey()
-    const decipher = crypto.createDecipheriv(
-      ALGORITHM,
-      key,
-      Buffer.from(payload.iv, 'hex')
-    )
-
-    // Set authentication tag
-    decipher.setAuthTag(Buffer.from(payload.tag, 'hex'))
+    const previousKey = await getPreviousKey()
 
-    // Decrypt
-    let decrypted = decipher.update(payload.encrypted, 'hex', 'utf8')
-    decrypted += decipher.final('utf8')
+    // Pick the key recorded in the payload, otherwise try current then previous
+    let candidates = previousKey ? [key, previousKey] : [key]
+    if (payload.keyId) {
+      const matching = candidates.filter((k) => getKeyId(k) === payload.keyId)
+      if (matching.length > 0) candidates = matching
+    }
 
-    // Parse JSON
-    return JSON.parse(decrypted)
+    let lastError: unknown = null
+    for (const candidate of candidates) {
+      try {
+        return decryptWithKey(payload, candidate)
+      } catch (error) {
+        lastError = error
+      }
+    }
+    throw lastError
   } catch (error) {
-    console.error('[Encryption] Decryption failed:', error)
+    log.error('Decryption failed', () => errorFields(error))
     throw new Error('Failed to decrypt data - data may be corrupted or key is incorrect')
   }
 }
 
+/**
+ * Check whether a payload was written with the current master key
+ */
+export const isEncryptedWithCurrentKey = async (payload: EncryptedPayload): Promise<boolean> => {
+  const key = await getMasterKey()
+  return payload.keyId === getKeyId(key)
+}
+
 /**
  * Initialize encryption system
  * Call this on app startup
  */
 export const initializeEncryption = async (): Promise<void> => {
   try {
-    console.log('[Encryption] Initializing encryption system')
+    log.info('Initializing encryption system')
     await getMasterKey()
-    console.log('[Encryption] Encryption system ready')
+    log.info('Encryption system ready')
   } catch (error) {
-    console.error('[Encryption] Failed to initialize encryption:', error)
+    log.error('Failed to initialize encryption', () => errorFields(error))
     throw error
   }
 }
@@ -223,13 +316,21 @@ export const exportMasterKey = async (): Promise<string> => {
     const key = await getMasterKey()
     return key.toString('base64')
   } catch (error) {
-    console.error('[Encryption] Failed to export key:', error)
+    log.error('Failed to export key', () => errorFields(error))
     throw new Error('Failed to export encryption key')
   }
 }
 
+// The stores still hold the previous key; reported as such rather than as a bad key
+export class KeyRotationInProgressError extends Error {
+  constructor() {
+    super('A key rotation is still in progress. Try again once it finishes')
+  }
+}
+
 /**
  * Import a master key from a base64 string
+ * False for an invalid key; throws KeyRotationInProgressError while a rotation runs
  */
 export const importMasterKey = async (keyString: string): Promise<boolean> => {
   try {
@@ -240,16 +341,32 @@ export const importMasterKey = async (keyString: string): Promise<boolean> => {
       throw new Error(`Invalid key length: expected ${KEY_LENGTH} bytes, got ${key.length}`)
     }
 
+    const currentKey = await getMasterKey()
+    if (currentKey.equals(key)) {
+      log.info('Imported key matches the current key')
+      return true
+    }
+
+    // Only one rotation at a time - the stores may still hold the previous key
+    if (await getPreviousKey()) {
+      throw new KeyRotationInProgressError()
+    }
+
+    // Keep the old key around so existing stores stay readable while they are re-encrypted
+    await storeMasterKey(currentKey, getPreviousKeyStoragePath())
+    previousKeyCache = currentKey
+
     // Store the key
     await storeMasterKey(key)
 
     // Update cache
     masterKeyCache = key
 
-    console.log('[Encryption] Master key imported successfully')
+    log.info('Master key imported successfully')
     return true
   } catch (error) {
-    console.error('[Encryption] Key import failed:', error)
+    log.error('Key import failed', () => errorFields(error))
+    if (error instanceof KeyRotationInProgressError) throw error
     return false
   }
 }
@@ -0,0 +1,205 @@
+import net from 'net'
+import path from 'path'
+import { spawn } from 'child_process'
+import { createLogger, errorFields } from './logger'
+import {
+  ENGINE_PROTOCOL_VERSION,
+  FrameDecoder,
+  assertPrivateDirectory,
+  encodeFrame,
+  getEngineSocketPath
+} from './engine-protocol'
+import type { EngineRequest, EngineResponse } from './engine-protocol'
+import { SharedPcmUnsupportedError } from './whisper-daemon'
+import type { DaemonInput } from './whisper-daemon'
+
+// Client of the shared transcription service (engine-service.ts)
+// Connects over the per-user socket and launches the service when nobody is
+// listening yet. Callers fall back to the in-process daemon on EngineUnavailableError
+
+const CONNECT_TIMEOUT_MS = 5000 // Waiting for a freshly launched service to listen
+const CONNECT_RETRY_MS = 100
+
+const log = createLogger('EngineClient')
+
+export interface EngineClientConfig {
+  servicePath: string // Built engine-service.js
+  isPackaged: boolean
+  resourcesPath: string
+  logDir?: string
+  clientName: string
+  onDownloadProgress?: (model: string, progress: number) => void
+  onDaemonPid?: (pid: number | null) => void
+}
+
+export class EngineUnavailableError extends Error {}
+
+let config: EngineClientConfig | null = null
+let connection: Promise<net.Socket> | null = null
+let nextRequestId = 1
+const pendingRequests: Map<
+  number,
+  { resolve: (text: string) => void; reject: (reason: Error) => void }
+> = new Map()
+
+export function configureEngineClient(options: EngineClientConfig): void {
+  config = options
+}
+
+const launchService = (): void => {
+  const args = [config!.servicePath]
+  if (config!.isPackaged) args.push('--packaged')
+  args.push('--resources-path', config!.resourcesPath)
+  if (config!.logDir) args.push('--log-dir', config!.logDir)
+
+  log.info('Launching shared engine service')
+  // Detached: the service outlives this process and serves other clients
+  spawn(process.execPath, args, {
+    detached: true,
+    stdio: 'ignore',
+    cwd: process.cwd(),
+    env: { ...process.env, ELECTRON_RUN_AS_NODE: '1' }
+  }).unref()
+}
+
+const tryConnect = (socketPath: string): Promise<net.Socket> => {
+  return new Promise((resolve, reject) => {
+    const socket = net.connect(socketPath)
+    socket.once('connect', () => {
+      socket.off('error', reject)
+      resolve(socket)
+    })
+    socket.once('error', reject)
+  })
+}
+
+const handleResponse = (message: EngineResponse): void => {
+  switch (message.type) {
+    case 'result': {
+      const request = pendingRequests.get(message.id)
+      pendingRequests.delete(message.id)
+      request?.resolve(message.text)
+      break
+    }
+    case 'error': {
+      const request = pendingRequests.get(message.id)
+      pendingRequests.delete(message.id)
+      request?.reject(
+        message.code === 'pcm-unsupported'
+          ? new SharedPcmUnsupportedError(message.message)
+          : new Error(message.message)
+      )
+      break
+    }
+    case 'model-download-progress':
+      config?.onDownloadProgress?.(message.model, message.progress)
+      break
+    case 'daemon-pid':
+      config?.onDaemonPid?.(message.pid)
+      break
+  }
+}
+
+const connect = async (): Promise<net.Socket> => {
+  if (!config) throw new EngineUnavailableError('Engine client is not configured')
+  const socketPath = getEngineSocketPath()
+
+  let socket: net.Socket
+  try {
+    assertPrivateDirectory(path.dirname(socketPath))
+    socket = await tryConnect(socketPath)
+  } catch (error) {
+    // Someone else's socket directory: never connect (or launch) there
+    if ((error as NodeJS.ErrnoException).code === undefined) {
+      throw new EngineUnavailableError((error as Error).message)
+    }
+    launchService()
+    const deadline = Date.now() + CONNECT_TIMEOUT_MS
+    for (;;) {
+      await new Promise((resolve) => setTimeout(resolve, CONNECT_RETRY_MS))
+      try {
+        socket = await tryConnect(socketPath)
+        break
+      } catch (error) {
+        if (Date.now() > deadline) {
+          throw new EngineUnavailableError(`Engine service did not start: ${(error as Error).message}`)
+        }
+      }
+    }
+  }
+
+  const decoder = new FrameDecoder<EngineResponse>()
+  await new Promise<void>((resolve, reject) => {
+    const timer = setTimeout(() => reject(new EngineUnavailableError('Engine handshake timed out')), CONNECT_TIMEOUT_MS)
+    socket.on('data', (chunk) => {
+      for (const { header } of decoder.push(chunk)) {
+        if (header.type === 'hello') {
+          clearTimeout(timer)
+          if (header.version !== ENGINE_PROTOCOL_VERSION) {
+            reject(new EngineUnavailableError(`Engine protocol ${header.version} is not supported`))
+          } else {
+            log.info('Connected to engine service', () => ({ pid: header.pid }))
+            resolve()
+          }
+        } else {
+          handleResponse(header)
+        }
+      }
+    })
+    socket.once('close', () => reject(new EngineUnavailableError('Engine service closed the connection')))
+    const hello: EngineRequest = { type: 'hello', version: ENGINE_PROTOCOL_VERSION, client: config!.clientName }
+    socket.write(encodeFrame(hello))
+  }).catch((error) => {
+    socket.destroy()
+    throw error
+  })
+
+  socket.on('error', (error) => log.warn('Engine connection error', () => errorFields(error)))
+  socket.on('close', () => {
+    connection = null
+    for (const request of pendingRequests.values()) {
+      request.reject(new EngineUnavailableError('Engine service disconnected'))
+    }
+    pendingRequests.clear()
+  })
+  return socket
+}
+
+const getConnection = (): Promise<net.Socket> => {
+  if (!connection) {
+    connection = connect()
+    connection.catch(() => {
+      connection = null
+    })
+  }
+  return connection
+}
+
+/**
+ * Transcribe a 16kHz WAV file or shared-memory PCM with the shared service
+ * The caller keeps any PCM lease until this settles (input.release is not called)
+ */
+export async function transcribeViaEngine(
+  model: string,
+  input: DaemonInput,
+  language?: string
+): Promise<string> {
+  const socket = await getConnection()
+  const id = nextRequestId++
+  return new Promise((resolve, reject) => {
+    pendingRequests.set(id, { resolve, reject })
+    const request: EngineRequest =
+      'pcm' in input
+        ? { type: 'transcribe', id, model, language, pcm: input.pcm }
+        : { type: 'transcribe', id, model, language, audioFile: input.audioFile }
+    socket.write(encodeFrame(request))
+  })
+}
+
+/**
+ * Drop the connection (the service keeps running for other clients)
+ */
+export function closeEngineClient(): void {
+  connection?.then((socket) => socket.end()).catch(() => undefined)
+  connection = null
+}
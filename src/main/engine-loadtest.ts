@@ -0,0 +1,516 @@
+import net from 'net'
+import fs from 'fs'
+import os from 'os'
+import path from 'path'
+import { spawn } from 'child_process'
+import type { ChildProcess } from 'child_process'
+import { configureWhisperLocal, stopDaemon } from './whisper-local'
+import { configureWhisperDaemon, transcribeWithDaemon } from './whisper-daemon'
+import { configureLogger, flushLogs } from './logger'
+import {
+  ENGINE_PROTOCOL_VERSION,
+  FrameDecoder,
+  encodeFrame,
+  getEngineSocketPath
+} from './engine-protocol'
+import type { EngineRequest, EngineResponse } from './engine-protocol'
+
+// Load generator for the transcription daemon and the shared engine service
+// Answers "how many concurrent dictations can one engine sustain at p95 < SLO?" by
+// replaying corpus WAV files from N simulated clients, either open-loop (Poisson
+// arrivals at a fixed offered rate, independent of completions) or closed-loop
+// (each client waits for its answer, thinks, and sends again). Each level of a sweep
+// reports throughput, latency and queueing percentiles; the JSON export is meant to
+// be diffed across engine versions
+//
+// Not shipped (excluded in electron-builder.yml). Build, then run with:
+//   ELECTRON_RUN_AS_NODE=1 electron out/main/engine-loadtest.js --corpus <dir|wav...> [options]
+//
+//   --target daemon|engine   In-process daemon supervisor, or the per-user service (default engine)
+//   --mode open|closed       Arrival model (default closed)
+//   --clients 1,2,4          Concurrent clients per level (closed) / connections (open)
+//   --rate 0.5,1,2           Offered requests per second per level (open)
+//   --think <ms>             Mean exponential think time between requests (closed, default 0)
+//   --duration <s>           Measured seconds per level (default 30), after --warmup <s> (default 5)
+//   --model <name>           WhisperKit model (default base); --language <code>
+//   --binary <path>          whisper-cli for --target daemon (default: the dev build)
+//   --slo-ms <ms>            p95 target used to find the saturation point (default 1000)
+//   --label <text>           Stored in the export, e.g. the engine version under test
+//   --out <file.json>        Write results as JSON
+
+const RESULT_VERSION = 1
+const CONNECT_TIMEOUT_MS = 5000
+
+interface Options {
+  target: 'daemon' | 'engine'
+  mode: 'open' | 'closed'
+  levels: number[]
+  thinkMs: number
+  durationMs: number
+  warmupMs: number
+  model: string
+  language?: string
+  binary?: string
+  sloMs: number
+  label?: string
+  out?: string
+  corpus: string[]
+}
+
+interface CorpusFile {
+  path: string
+  audioMs: number
+}
+
+interface Sample {
+  arrivedAt: number // Scheduled arrival (open-loop) or send time (closed-loop)
+  completedAt: number
+  audioMs: number
+  error?: string
+}
+
+interface Percentiles {
+  p50: number
+  p90: number
+  p95: number
+  p99: number
+  max: number
+}
+
+interface LevelResult {
+  level: number // Clients (closed) or offered requests/s (open)
+  offeredRps: number | null
+  completed: number
+  errors: number
+  throughputRps: number
+  audioSecondsPerSecond: number // Throughput in audio time; > 1 means faster than real time
+  latencyMs: Percentiles
+  queueingMs: Percentiles
+  serviceMs: Percentiles
+  meetsSlo: boolean
+}
+
+// Sends one request and resolves when it is answered
+type Transport = {
+  transcribe: (file: string) => Promise<string>
+  close: () => void
+}
+
+const parseOptions = (argv: string[]): Options => {
+  const values = new Map<string, string>()
+  const corpus: string[] = []
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--corpus') {
+      while (argv[i + 1] && !argv[i + 1].startsWith('--')) corpus.push(argv[++i])
+    } else if (argv[i].startsWith('--')) {
+      values.set(argv[i].slice(2), argv[i + 1])
+      i++
+    }
+  }
+
+  const numbers = (value: string | undefined, fallback: number[]): number[] =>
+    value ? value.split(',').map(Number).filter((n) => n > 0) : fallback
+  const mode = values.get('mode') === 'open' ? 'open' : 'closed'
+  return {
+    target: values.get('target') === 'daemon' ? 'daemon' : 'engine',
+    mode,
+    levels: mode === 'open' ? numbers(values.get('rate'), [0.5, 1, 2]) : numbers(values.get('clients'), [1, 2, 4]),
+    thinkMs: Number(values.get('think') ?? 0),
+    durationMs: Number(values.get('duration') ?? 30) * 1000,
+    warmupMs: Number(values.get('warmup') ?? 5) * 1000,
+    model: values.get('model') ?? 'base',
+    language: values.get('language'),
+    binary: values.get('binary'),
+    sloMs: Number(values.get('slo-ms') ?? 1000),
+    label: values.get('label'),
+    out: values.get('out'),
+    corpus
+  }
+}
+
+/**
+ * Duration of a PCM WAV file from its fmt and data chunks
+ */
+const readWavDurationMs = (file: string): number => {
+  const header = Buffer.alloc(4096)
+  const fd = fs.openSync(file, 'r')
+  const length = fs.readSync(fd, header, 0, header.length, 0)
+  fs.closeSync(fd)
+
+  let byteRate = 0
+  for (let offset = 12; offset + 8 <= length; ) {
+    const id = header.toString('ascii', offset, offset + 4)
+    const size = header.readUInt32LE(offset + 4)
+    if (id === 'fmt ') byteRate = header.readUInt32LE(offset + 16)
+    if (id === 'data' && byteRate > 0) return (size / byteRate) * 1000
+    offset += 8 + size + (size % 2)
+  }
+  throw new Error(`${file} is not a PCM WAV file`)
+}
+
+const loadCorpus = (entries: string[]): CorpusFile[] => {
+  const files = entries.flatMap((entry) =>
+    fs.statSync(entry).isDirectory()
+      ? fs.readdirSync(entry).filter((name) => name.endsWith('.wav')).map((name) => path.join(entry, name))
+      : [entry]
+  )
+  return files.map((file) => ({ path: path.resolve(file), audioMs: readWavDurationMs(file) }))
+}
+
+/**
+ * Hands out distinct paths (symlinks) for the same corpus file
+ * The supervisor keys in-flight jobs by path, so replaying one file concurrently
+ * needs a separate name per outstanding request
+ */
+class AliasPool {
+  private directory = fs.mkdtempSync(path.join(os.tmpdir(), 'wispr-loadtest-'))
+  private free: Map<string, string[]> = new Map()
+  private created = 0
+
+  acquire(file: string): string {
+    const alias = this.free.get(file)?.pop()
+    if (alias) return alias
+    const created = path.join(this.directory, `${this.created++}.wav`)
+    fs.symlinkSync(file, created)
+    return created
+  }
+
+  release(file: string, alias: string): void {
+    const list = this.free.get(file) ?? []
+    list.push(alias)
+    this.free.set(file, list)
+  }
+
+  dispose(): void {
+    fs.rmSync(this.directory, { recursive: true, force: true })
+  }
+}
+
+const daemonTransport = (options: Options): Transport => {
+  if (options.binary) {
+    configureWhisperDaemon({ resolveBinary: () => options.binary! })
+  } else {
+    configureWhisperLocal({ isPackaged: false, resourcesPath: process.cwd() })
+  }
+  return {
+    transcribe: (file) => transcribeWithDaemon(options.model, { audioFile: file }, options.language),
+    close: () => stopDaemon()
+  }
+}
+
+/**
+ * One socket per simulated client, so the service sees N distinct clients
+ */
+const connectEngine = async (options: Options, name: string): Promise<Transport> => {
+  const socket = await new Promise<net.Socket>((resolve, reject) => {
+    const connection = net.connect(getEngineSocketPath())
+    connection.once('connect', () => resolve(connection))
+    connection.once('error', reject)
+  })
+
+  const pending: Map<number, { resolve: (text: string) => void; reject: (reason: Error) => void }> = new Map()
+  const decoder = new FrameDecoder<EngineResponse>()
+  let nextId = 1
+  const ready = new Promise<void>((resolve, reject) => {
+    socket.on('data', (chunk) => {
+      for (const { header } of decoder.push(chunk)) {
+        if (header.type === 'hello') {
+          if (header.version === ENGINE_PROTOCOL_VERSION) resolve()
+          else reject(new Error(`Engine protocol ${header.version} is not supported`))
+        } else if (header.type === 'result' || header.type === 'error') {
+          const request = pending.get(header.id)
+          pending.delete(header.id)
+          if (header.type === 'result') request?.resolve(header.text)
+          else request?.reject(new Error(header.message))
+        }
+      }
+    })
+  })
+  socket.on('error', () => undefined) // 'close' follows
+  socket.on('close', () => {
+    for (const request of pending.values()) request.reject(new Error('Engine service disconnected'))
+    pending.clear()
+  })
+
+  const hello: EngineRequest = { type: 'hello', version: ENGINE_PROTOCOL_VERSION, client: name }
+  socket.write(encodeFrame(hello))
+  await ready
+
+  return {
+    transcribe: (file) =>
+      new Promise((resolve, reject) => {
+        const id = nextId++
+        pending.set(id, { resolve, reject })
+        const request: EngineRequest = {
+          type: 'transcribe',
+          id,
+          model: options.model,
+          language: options.language,
+          audioFile: file
+        }
+        socket.write(encodeFrame(request))
+      }),
+    close: () => socket.end()
+  }
+}
+
+// Started only when no service is listening; stopped again at the end
+let launchedService: ChildProcess | null = null
+
+const ensureEngineService = async (options: Options): Promise<void> => {
+  try {
+    const probe = await connectEngine(options, 'loadtest-probe')
+    probe.close()
+    return
+  } catch {
+    // Not running
+  }
+
+  launchedService = spawn(process.execPath, [path.join(__dirname, 'engine-service.js'), '--resources-path', process.cwd()], {
+    stdio: 'ignore',
+    env: { ...process.env, ELECTRON_RUN_AS_NODE: '1' }
+  })
+  const deadline = Date.now() + CONNECT_TIMEOUT_MS
+  for (;;) {
+    await new Promise((resolve) => setTimeout(resolve, 100))
+    try {
+      const probe = await connectEngine(options, 'loadtest-probe')
+      probe.close()
+      return
+    } catch (error) {
+      if (Date.now() > deadline) throw new Error(`Engine service did not start: ${(error as Error).message}`)
+    }
+  }
+}
+
+const percentiles = (values: number[]): Percentiles => {
+  if (values.length === 0) return { p50: 0, p90: 0, p95: 0, p99: 0, max: 0 }
+  const sorted = [...values].sort((a, b) => a - b)
+  const at = (q: number): number => sorted[Math.min(sorted.length - 1, Math.ceil(q * sorted.length) - 1)]
+  const round = (n: number): number => Math.round(n * 10) / 10
+  return {
+    p50: round(at(0.5)),
+    p90: round(at(0.9)),
+    p95: round(at(0.95)),
+    p99: round(at(0.99)),
+    max: round(sorted[sorted.length - 1])
+  }
+}
+
+// Exponential variate: Poisson inter-arrival gaps and think times
+const exponential = (meanMs: number): number => (meanMs > 0 ? -Math.log(1 - Math.random()) * meanMs : 0)
+
+const sleep = (ms: number): Promise<void> => new Promise((resolve) => setTimeout(resolve, ms))
+
+/**
+ * Run one level and collect a sample per request
+ * Requests arriving during warm-up are sent but not measured
+ */
+const runLevel = async (
+  options: Options,
+  level: number,
+  transports: Transport[],
+  corpus: CorpusFile[],
+  aliases: AliasPool
+): Promise<{ samples: Sample[]; measureStart: number; measureEnd: number }> => {
+  const samples: Sample[] = []
+  const inFlight: Promise<void>[] = []
+  const start = performance.now()
+  const measureStart = start + options.warmupMs
+  const measureEnd = measureStart + options.durationMs
+  let next = 0
+
+  const issue = async (transport: Transport, arrivedAt: number): Promise<void> => {
+    const file = corpus[next++ % corpus.length]
+    const alias = aliases.acquire(file.path)
+    const sample: Sample = { arrivedAt, completedAt: 0, audioMs: file.audioMs }
+    try {
+      await transport.transcribe(alias)
+    } catch (error) {
+      sample.error = (error as Error).message
+    } finally {
+      aliases.release(file.path, alias)
+    }
+    sample.completedAt = performance.now()
+    if (arrivedAt >= measureStart && arrivedAt < measureEnd) samples.push(sample)
+  }
+
+  if (options.mode === 'open') {
+    // Arrivals don't wait for completions, so a saturated engine shows up as growing queueing delay
+    const meanGapMs = 1000 / level
+    let arrival = start + exponential(meanGapMs)
+    for (let i = 0; arrival < measureEnd; i++) {
+      const wait = arrival - performance.now()
+      if (wait > 0) await sleep(wait)
+      inFlight.push(issue(transports[i % transports.length], arrival))
+      arrival += exponential(meanGapMs)
+    }
+  } else {
+    for (const transport of transports.slice(0, level)) {
+      inFlight.push(
+        (async () => {
+          while (performance.now() < measureEnd) {
+            await issue(transport, performance.now())
+            await sleep(exponential(options.thinkMs))
+          }
+        })()
+      )
+    }
+  }
+
+  await Promise.all(inFlight)
+  return { samples, measureStart, measureEnd }
+}
+
+/**
+ * Split each latency into queueing and service time
+ * The engine runs one daemon that decodes requests one at a time in arrival order,
+ * so a request starts when it arrives or when the previous one finishes. Exact only
+ * while this harness is the engine's sole client
+ */
+const summarize = (
+  options: Options,
+  level: number,
+  run: { samples: Sample[]; measureStart: number; measureEnd: number }
+): LevelResult => {
+  const ok = run.samples.filter((sample) => !sample.error).sort((a, b) => a.completedAt - b.completedAt)
+  const queueing: number[] = []
+  const service: number[] = []
+  let previousCompletion = 0
+  for (const sample of ok) {
+    const startedAt = Math.max(sample.arrivedAt, previousCompletion)
+    queueing.push(startedAt - sample.arrivedAt)
+    service.push(sample.completedAt - startedAt)
+    previousCompletion = sample.completedAt
+  }
+
+  // Completions of measured requests over the time they took to drain
+  const last = ok.length ? ok[ok.length - 1].completedAt : run.measureEnd
+  const seconds = Math.max(run.measureEnd, last) - run.measureStart
+  const latency = percentiles(ok.map((sample) => sample.completedAt - sample.arrivedAt))
+  return {
+    level,
+    offeredRps: options.mode === 'open' ? level : null,
+    completed: ok.length,
+    errors: run.samples.length - ok.length,
+    throughputRps: Math.round((ok.length / (seconds / 1000)) * 100) / 100,
+    audioSecondsPerSecond:
+      Math.round((ok.reduce((total, sample) => total + sample.audioMs, 0) / seconds) * 100) / 100,
+    latencyMs: latency,
+    queueingMs: percentiles(queueing),
+    serviceMs: percentiles(service),
+    meetsSlo: ok.length > 0 && run.samples.length === ok.length && latency.p95 <= options.sloMs
+  }
+}
+
+/**
+ * Saturation: the first level that misses the SLO, or (open-loop) where throughput
+ * falls clearly behind the offered rate; capacity is the last level before it
+ */
+const findSaturation = (
+  options: Options,
+  results: LevelResult[]
+): { capacity: number | null; saturatedAt: number | null } => {
+  let capacity: number | null = null
+  for (const result of results) {
+    const fallingBehind = result.offeredRps !== null && result.throughputRps < result.offeredRps * 0.9
+    if (!result.meetsSlo || fallingBehind) return { capacity, saturatedAt: result.level }
+    capacity = result.level
+  }
+  return { capacity, saturatedAt: null }
+}
+
+const printLevel = (options: Options, result: LevelResult): void => {
+  const unit = options.mode === 'open' ? 'rps' : 'clients'
+  console.log(
+    `${String(result.level).padStart(5)} ${unit.padEnd(8)}` +
+      ` done ${String(result.completed).padStart(5)}  err ${String(result.errors).padStart(3)}` +
+      `  tput ${result.throughputRps.toFixed(2).padStart(6)}/s` +
+      `  p50 ${result.latencyMs.p50.toFixed(0).padStart(6)}  p95 ${result.latencyMs.p95.toFixed(0).padStart(6)}` +
+      `  p99 ${result.latencyMs.p99.toFixed(0).padStart(6)} ms` +
+      `  queue p95 ${result.queueingMs.p95.toFixed(0).padStart(6)} ms` +
+      `  ${result.meetsSlo ? 'ok' : 'SLO miss'}`
+  )
+}
+
+const main = async (): Promise<void> => {
+  const options = parseOptions(process.argv.slice(2))
+  if (options.corpus.length === 0) {
+    console.error('Usage: engine-loadtest.js --corpus <dir|wav...> [--target daemon|engine] [--mode open|closed] ...')
+    process.exit(2)
+  }
+  configureLogger({ level: 'warn', consoleEcho: true })
+
+  const corpus = loadCorpus(options.corpus)
+  if (corpus.length === 0) throw new Error('Corpus has no WAV files')
+  const audioSeconds = corpus.reduce((total, file) => total + file.audioMs, 0) / 1000
+  console.log(
+    `${options.target} / ${options.mode}-loop / ${options.model}: ${corpus.length} files, ${audioSeconds.toFixed(1)}s of audio, SLO p95 <= ${options.sloMs}ms`
+  )
+
+  // Open-loop reuses a few connections; closed-loop needs one per client
+  const connections = options.mode === 'open' ? 4 : Math.max(...options.levels)
+  const transports: Transport[] = []
+  if (options.target === 'daemon') {
+    const transport = daemonTransport(options)
+    for (let i = 0; i < connections; i++) transports.push(transport)
+  } else {
+    await ensureEngineService(options)
+    for (let i = 0; i < connections; i++) transports.push(await connectEngine(options, `loadtest-${i}`))
+  }
+
+  const aliases = new AliasPool()
+  const results: LevelResult[] = []
+  try {
+    // Load the model before measuring anything
+    await transports[0].transcribe(aliases.acquire(corpus[0].path))
+
+    for (const level of options.levels) {
+      const result = summarize(options, level, await runLevel(options, level, transports, corpus, aliases))
+      results.push(result)
+      printLevel(options, result)
+    }
+  } finally {
+    new Set(transports).forEach((transport) => transport.close())
+    launchedService?.kill('SIGTERM')
+    aliases.dispose()
+  }
+
+  const saturation = findSaturation(options, results)
+  console.log(
+    saturation.saturatedAt === null
+      ? `No saturation up to ${options.levels[options.levels.length - 1]}`
+      : `Saturated at ${saturation.saturatedAt}; capacity at SLO: ${saturation.capacity ?? 'none'}`
+  )
+
+  if (options.out) {
+    const exported = {
+      version: RESULT_VERSION,
+      label: options.label ?? null,
+      startedAt: new Date().toISOString(),
+      host: { platform: process.platform, arch: process.arch, cpus: os.cpus().length },
+      options: {
+        target: options.target,
+        mode: options.mode,
+        model: options.model,
+        language: options.language ?? null,
+        thinkMs: options.thinkMs,
+        durationMs: options.durationMs,
+        warmupMs: options.warmupMs,
+        sloMs: options.sloMs
+      },
+      corpus: { files: corpus.length, audioSeconds },
+      levels: results,
+      saturation
+    }
+    fs.writeFileSync(options.out, JSON.stringify(exported, null, 2))
+    console.log(`Results written to ${options.out}`)
+  }
+}
+
+main()
+  .catch((error) => {
+    console.error(error instanceof Error ? error.message : error)
+    process.exitCode = 1
+  })
+  .finally(() => flushLogs().finally(() => process.exit()))
@@ -0,0 +1,56 @@
+import { test } from 'node:test'
+import assert from 'node:assert/strict'
+import { FrameDecoder, encodeFrame } from './engine-protocol'
+import type { EngineRequest } from './engine-protocol'
+
+const hello: EngineRequest = { type: 'hello', version: 1, client: 'test' }
+const transcribe: EngineRequest = { type: 'transcribe', id: 7, model: 'base' }
+
+test('a frame round-trips its header, without a payload', () => {
+  const frames = new FrameDecoder<EngineRequest>().push(encodeFrame(hello))
+  assert.deepEqual(frames, [{ header: hello, payload: null }])
+})
+
+test('a frame round-trips its header and payload', () => {
+  const payload = Buffer.from([1, 2, 3, 4, 5])
+  const [frame] = new FrameDecoder<EngineRequest>().push(encodeFrame(transcribe, payload))
+  assert.deepEqual(frame.header, transcribe)
+  assert.deepEqual(frame.payload, payload)
+})
+
+test('one chunk may carry several frames', () => {
+  const chunk = Buffer.concat([encodeFrame(hello), encodeFrame(transcribe, Buffer.from('wav'))])
+  const frames = new FrameDecoder<EngineRequest>().push(chunk)
+  assert.deepEqual(frames.map((frame) => frame.header), [hello, transcribe])
+})
+
+test('a frame split across chunks is reassembled', () => {
+  const payload = Buffer.alloc(1000, 9)
+  const encoded = Buffer.concat([encodeFrame(transcribe, payload), encodeFrame(hello)])
+  const decoder = new FrameDecoder<EngineRequest>()
+
+  const frames = []
+  for (let i = 0; i < encoded.length; i++) {
+    frames.push(...decoder.push(encoded.subarray(i, i + 1)))
+  }
+  assert.equal(frames.length, 2)
+  assert.deepEqual(frames[0].header, transcribe)
+  assert.deepEqual(frames[0].payload, payload)
+  assert.deepEqual(frames[1].header, hello)
+})
+
+test('an impossible frame length is rejected', () => {
+  const tooShort = Buffer.alloc(8)
+  tooShort.writeUInt32BE(3, 0)
+  assert.throws(() => new FrameDecoder().push(tooShort), /Invalid frame length/)
+
+  const tooLong = Buffer.alloc(4)
+  tooLong.writeUInt32BE(0xffffffff, 0)
+  assert.throws(() => new FrameDecoder().push(tooLong), /Invalid frame length/)
+})
+
+test('a header longer than its frame is rejected', () => {
+  const frame = encodeFrame(hello)
+  frame.writeUInt32BE(frame.length, 4)
+  assert.throws(() => new FrameDecoder().push(frame), /Invalid header length/)
+})
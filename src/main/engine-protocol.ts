@@ -0,0 +1,123 @@
+import fs from 'fs'
+import os from 'os'
+import path from 'path'
+import type { PcmDescriptor } from './pcm-slab'
+
+/**
+ * Framed protocol of the shared transcription service (engine-service.ts)
+ *
+ * Every frame is `[u32 frame length][u32 header length][JSON header][binary payload]`
+ * (big-endian lengths; the frame length excludes its own 4 bytes). The payload is
+ * optional and only used to send audio inline - local clients normally pass a
+ * shared-memory descriptor (pcm-slab.ts) or a path
+ */
+
+export const ENGINE_PROTOCOL_VERSION = 1
+const MAX_FRAME_BYTES = 64 * 1024 * 1024
+
+// Client -> service
+export type EngineRequest =
+  | { type: 'hello'; version: number; client: string }
+  // Audio is 16kHz PCM in the client's shared-memory slab, a 16kHz WAV file readable
+  // by the service, or the frame payload. The client keeps the PCM lease until answered
+  | {
+      type: 'transcribe'
+      id: number
+      model: string
+      language?: string
+      audioFile?: string
+      pcm?: PcmDescriptor
+    }
+  | { type: 'status'; id: number }
+
+// Service -> client
+export type EngineResponse =
+  | { type: 'hello'; version: number; pid: number }
+  | { type: 'result'; id: number; text: string }
+  // 'pcm-unsupported': the daemon can't read shared memory, resend as a file
+  | { type: 'error'; id: number; message: string; code?: 'pcm-unsupported' }
+  | { type: 'status'; id: number; clients: number; activeJobs: number; uptimeMs: number }
+  // Broadcast to every client
+  | { type: 'model-download-progress'; model: string; progress: number }
+  | { type: 'daemon-pid'; pid: number | null }
+
+export interface Frame<T> {
+  header: T
+  payload: Buffer | null
+}
+
+/**
+ * Socket of the per-user service. The parent directory is private to the user
+ * (0700) and the socket itself is 0600, so only the same user can connect
+ */
+export function getEngineSocketPath(): string {
+  if (process.platform === 'linux' && process.env.XDG_RUNTIME_DIR) {
+    return path.join(process.env.XDG_RUNTIME_DIR, 'wispr', 'engine.sock')
+  }
+  // macOS tmpdir is already per-user; elsewhere the uid keeps users apart
+  const uid = typeof process.getuid === 'function' ? process.getuid() : 0
+  return path.join(os.tmpdir(), `wispr-${uid}`, 'engine.sock')
+}
+
+/**
+ * Refuse a socket directory someone else created (e.g. squatting in a shared /tmp)
+ */
+export function assertPrivateDirectory(directory: string): void {
+  if (typeof process.getuid !== 'function') return
+  const stat = fs.statSync(directory)
+  if (stat.uid !== process.getuid() || (stat.mode & 0o077) !== 0) {
+    throw new Error(`Engine socket directory ${directory} is not private to this user`)
+  }
+}
+
+export function encodeFrame(header: EngineRequest | EngineResponse, payload?: Buffer): Buffer {
+  const json = Buffer.from(JSON.stringify(header), 'utf-8')
+  const prefix = Buffer.alloc(8)
+  prefix.writeUInt32BE(4 + json.length + (payload?.length ?? 0), 0)
+  prefix.writeUInt32BE(json.length, 4)
+  return payload ? Buffer.concat([prefix, json, payload]) : Buffer.concat([prefix, json])
+}
+
+/**
+ * Reassembles frames from stream chunks (a chunk may hold several frames or part of one)
+ */
+export class FrameDecoder<T> {
+  private chunks: Buffer[] = []
+  private buffered = 0
+
+  push(chunk: Buffer): Frame<T>[] {
+    this.chunks.push(chunk)
+    this.buffered += chunk.length
+
+    const frames: Frame<T>[] = []
+    while (this.buffered >= 4) {
+      const head = this.peek(4)
+      const frameLength = head.readUInt32BE(0)
+      if (frameLength < 4 || frameLength > MAX_FRAME_BYTES) {
+        throw new Error(`Invalid frame length ${frameLength}`)
+      }
+      if (this.buffered < 4 + frameLength) break
+
+      const frame = this.take(4 + frameLength)
+      const headerLength = frame.readUInt32BE(4)
+      if (headerLength > frameLength - 4) throw new Error('Invalid header length')
+      const header = JSON.parse(frame.toString('utf-8', 8, 8 + headerLength)) as T
+      const payload = frame.length > 8 + headerLength ? frame.subarray(8 + headerLength) : null
+      frames.push({ header, payload })
+    }
+    return frames
+  }
+
+  private peek(length: number): Buffer {
+    if (this.chunks[0].length < length) this.chunks = [Buffer.concat(this.chunks)]
+    return this.chunks[0].subarray(0, length)
+  }
+
+  private take(length: number): Buffer {
+    const all = this.chunks.length === 1 ? this.chunks[0] : Buffer.concat(this.chunks)
+    const rest = all.subarray(length)
+    this.chunks = rest.length ? [rest] : []
+    this.buffered = rest.length
+    return all.subarray(0, length)
+  }
+}
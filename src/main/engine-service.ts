@@ -0,0 +1,230 @@
+import net from 'net'
+import fs from 'fs'
+import os from 'os'
+import path from 'path'
+import { configureWhisperLocal, stopDaemon } from './whisper-local'
+import { SharedPcmUnsupportedError, transcribeWithDaemon } from './whisper-daemon'
+import { configureLogger, createLogger, errorFields, flushLogs } from './logger'
+import {
+  ENGINE_PROTOCOL_VERSION,
+  FrameDecoder,
+  assertPrivateDirectory,
+  encodeFrame,
+  getEngineSocketPath
+} from './engine-protocol'
+import type { EngineRequest, EngineResponse } from './engine-protocol'
+
+// Shared local transcription service
+// One process per user owns the WhisperKit daemon and serves every client (the
+// dictation pipeline, the Notes window, other app instances, CLI tools) over a Unix
+// domain socket, so the model is resident only once. Started on demand by
+// engine-client.ts and shuts itself down once no client has been connected for a while
+//
+// Run with ELECTRON_RUN_AS_NODE=1:
+//   engine-service.js [--packaged] [--resources-path <dir>] [--log-dir <dir>]
+
+const IDLE_SHUTDOWN_MS = 5 * 60 * 1000
+
+const log = createLogger('EngineService')
+
+interface Client {
+  socket: net.Socket
+  name: string
+  activeJobs: number
+}
+
+const clients = new Set<Client>()
+const startedAt = Date.now()
+let idleTimer: NodeJS.Timeout | null = null
+let server: net.Server | null = null
+let daemonPid: number | null = null // Sent to late joiners for their resource monitor
+
+const argValue = (name: string): string | undefined => {
+  const index = process.argv.indexOf(name)
+  return index >= 0 ? process.argv[index + 1] : undefined
+}
+
+const send = (client: Client, message: EngineResponse): void => {
+  if (!client.socket.destroyed) client.socket.write(encodeFrame(message))
+}
+
+const broadcast = (message: EngineResponse): void => {
+  const frame = encodeFrame(message)
+  for (const client of clients) {
+    if (!client.socket.destroyed) client.socket.write(frame)
+  }
+}
+
+const activeJobs = (): number => {
+  let total = 0
+  for (const client of clients) total += client.activeJobs
+  return total
+}
+
+const scheduleIdleShutdown = (): void => {
+  if (idleTimer) clearTimeout(idleTimer)
+  idleTimer = null
+  if (clients.size > 0) return
+  idleTimer = setTimeout(() => {
+    log.info('No clients, shutting down')
+    shutdown(0)
+  }, IDLE_SHUTDOWN_MS)
+}
+
+const handleTranscribe = async (
+  client: Client,
+  request: Extract<EngineRequest, { type: 'transcribe' }>,
+  payload: Buffer | null
+): Promise<void> => {
+  client.activeJobs++
+  // Inline audio is spooled to a private temp file for the daemon
+  let spooled: string | null = null
+  try {
+    let audioFile = request.audioFile
+    if (payload) {
+      spooled = path.join(os.tmpdir(), `wispr_engine_${process.pid}_${Date.now()}_${request.id}.wav`)
+      await fs.promises.writeFile(spooled, payload, { mode: 0o600 })
+      audioFile = spooled
+    }
+
+    // The daemon maps the client's region directly; the client frees it on our reply
+    const input = request.pcm ? { pcm: request.pcm } : audioFile ? { audioFile } : null
+    if (!input) throw new Error('No audio in request')
+
+    const text = await transcribeWithDaemon(request.model, input, request.language)
+    send(client, { type: 'result', id: request.id, text })
+  } catch (error) {
+    send(client, {
+      type: 'error',
+      id: request.id,
+      message: error instanceof Error ? error.message : String(error),
+      code: error instanceof SharedPcmUnsupportedError ? 'pcm-unsupported' : undefined
+    })
+  } finally {
+    client.activeJobs--
+    if (spooled) fs.promises.unlink(spooled).catch(() => undefined)
+  }
+}
+
+const handleConnection = (socket: net.Socket): void => {
+  const client: Client = { socket, name: 'unknown', activeJobs: 0 }
+  const decoder = new FrameDecoder<EngineRequest>()
+  clients.add(client)
+  scheduleIdleShutdown()
+
+  socket.on('data', (chunk) => {
+    let frames
+    try {
+      frames = decoder.push(chunk)
+    } catch (error) {
+      log.warn('Dropping client with a malformed frame', () => errorFields(error))
+      socket.destroy()
+      return
+    }
+
+    for (const { header, payload } of frames) {
+      switch (header.type) {
+        case 'hello':
+          client.name = header.client
+          log.info(() => `Client connected: ${client.name}`, () => ({ clients: clients.size }))
+          send(client, { type: 'hello', version: ENGINE_PROTOCOL_VERSION, pid: process.pid })
+          send(client, { type: 'daemon-pid', pid: daemonPid })
+          break
+        case 'transcribe':
+          handleTranscribe(client, header, payload)
+          break
+        case 'status':
+          send(client, {
+            type: 'status',
+            id: header.id,
+            clients: clients.size,
+            activeJobs: activeJobs(),
+            uptimeMs: Date.now() - startedAt
+          })
+          break
+      }
+    }
+  })
+
+  socket.on('error', () => undefined) // 'close' follows
+  socket.on('close', () => {
+    clients.delete(client)
+    log.info(() => `Client disconnected: ${client.name}`, () => ({ clients: clients.size }))
+    scheduleIdleShutdown()
+  })
+}
+
+const shutdown = (code: number): void => {
+  // Only the instance that owns the socket removes it
+  if (server?.listening) {
+    server.close()
+    try {
+      fs.unlinkSync(getEngineSocketPath())
+    } catch {
+      // Already gone
+    }
+  }
+  stopDaemon()
+  flushLogs().finally(() => process.exit(code))
+}
+
+// Another instance may own the socket; a socket nobody answers on is stale
+const isServiceRunning = (socketPath: string): Promise<boolean> => {
+  return new Promise((resolve) => {
+    const probe = net.connect(socketPath)
+    probe.once('connect', () => {
+      probe.destroy()
+      resolve(true)
+    })
+    probe.once('error', () => resolve(false))
+  })
+}
+
+const start = async (): Promise<void> => {
+  const logDir = argValue('--log-dir')
+  configureLogger({ directory: logDir, consoleEcho: !logDir })
+
+  configureWhisperLocal({
+    isPackaged: process.argv.includes('--packaged'),
+    resourcesPath: argValue('--resources-path') ?? process.resourcesPath,
+    onDownloadProgress: (model, progress) => broadcast({ type: 'model-download-progress', model, progress }),
+    onDaemonPid: (pid) => {
+      daemonPid = pid
+      broadcast({ type: 'daemon-pid', pid })
+    }
+  })
+
+  const socketPath = getEngineSocketPath()
+  fs.mkdirSync(path.dirname(socketPath), { recursive: true, mode: 0o700 })
+  assertPrivateDirectory(path.dirname(socketPath))
+
+  if (await isServiceRunning(socketPath)) {
+    log.info('Service already running')
+    process.exit(0)
+  }
+  try {
+    fs.unlinkSync(socketPath)
+  } catch {
+    // No stale socket
+  }
+
+  // Created 0600 from the start - no window where another user could connect
+  process.umask(0o177)
+  server = net.createServer(handleConnection)
+  server.on('error', (error) => {
+    log.error('Server error', () => errorFields(error))
+    shutdown(1)
+  })
+  server.listen(socketPath, () => {
+    log.info(() => `Listening on ${socketPath}`, () => ({ pid: process.pid }))
+    scheduleIdleShutdown()
+  })
+}
+
+process.on('SIGTERM', () => shutdown(0))
+process.on('SIGINT', () => shutdown(0))
+
+start().catch((error) => {
+  log.error('Failed to start', () => errorFields(error))
+  shutdown(1)
+})
@@ -0,0 +1,94 @@
+import { createLogger } from './logger'
+import { countWords } from './text-segmentation'
+
+// Picks the formatting model per utterance
+// Short, plain dictations go to a small fast model; long ones, ones with structure
+// (lists, emails) and ones with custom instructions keep the large model. Latency is
+// tracked per tier so the split can be checked against real traffic
+
+export type FormattingTier = 'fast' | 'large'
+
+export const DEFAULT_FORMATTING_MODELS: Record<FormattingTier, string> = {
+  fast: 'llama-3.1-8b-instant',
+  large: 'moonshotai/kimi-k2-instruct-0905'
+}
+
+const FAST_MAX_WORDS = 30
+const STATS_WINDOW = 200 // Most recent calls per tier
+const STATS_LOG_EVERY = 25
+
+// Spoken cues that the text wants lists or letter/email structure
+const STRUCTURE_CUES: { reason: string; pattern: RegExp }[] = [
+  {
+    reason: 'list',
+    pattern:
+      /\b(first(ly)?|second(ly)?|third(ly)?|next point|bullet( point)?s?|number (one|two|three)|new line|new paragraph|to-?do list|the following)\b/i
+  },
+  {
+    reason: 'email',
+    pattern: /\b(dear|hi|hello|hey) [a-z]+\b|\b(best regards|kind regards|sincerely|cheers|thanks again|subject line|sign(ed)? off)\b/i
+  },
+  // Several sentences already spoken - worth structuring properly
+  { reason: 'multi-sentence', pattern: /([.!?]\s+\S+.*){3,}/ }
+]
+
+export interface FormattingRoute {
+  tier: FormattingTier
+  model: string
+  reason: string
+}
+
+export interface FormattingRouteInput {
+  text: string
+  style: string
+  customInstructions?: string
+  routing?: 'auto' | 'large'
+  models?: Partial<Record<FormattingTier, string>>
+}
+
+const log = createLogger('FormatRouter')
+
+const latencies: Record<FormattingTier, number[]> = { fast: [], large: [] }
+const calls: Record<FormattingTier, number> = { fast: 0, large: 0 }
+
+export function routeFormatting(input: FormattingRouteInput): FormattingRoute {
+  const models = { ...DEFAULT_FORMATTING_MODELS, ...input.models }
+  const large = (reason: string): FormattingRoute => ({ tier: 'large', model: models.large, reason })
+
+  if (input.routing === 'large' || !models.fast) return large('configured')
+  // Custom instructions need the stronger instruction-follower
+  if (input.customInstructions?.trim()) return large('custom-instructions')
+
+  const words = countWords(input.text)
+  if (words > FAST_MAX_WORDS) return large('length')
+
+  const cue = STRUCTURE_CUES.find(({ pattern }) => pattern.test(input.text))
+  if (cue) return large(cue.reason)
+
+  return { tier: 'fast', model: models.fast, reason: 'short' }
+}
+
+const percentile = (sorted: number[], q: number): number =>
+  sorted.length ? Math.round(sorted[Math.min(sorted.length - 1, Math.ceil(q * sorted.length) - 1)]) : 0
+
+export function getFormattingStats(): Record<FormattingTier, { calls: number; p50Ms: number; p95Ms: number }> {
+  const summarize = (tier: FormattingTier): { calls: number; p50Ms: number; p95Ms: number } => {
+    const sorted = [...latencies[tier]].sort((a, b) => a - b)
+    return { calls: calls[tier], p50Ms: percentile(sorted, 0.5), p95Ms: percentile(sorted, 0.95) }
+  }
+  return { fast: summarize('fast'), large: summarize('large') }
+}
+
+/**
+ * Record a completed formatting call (failed calls are not timed)
+ */
+export function recordFormattingLatency(tier: FormattingTier, ms: number): void {
+  const window = latencies[tier]
+  window.push(ms)
+  if (window.length > STATS_WINDOW) window.shift()
+  calls[tier]++
+
+  if ((calls.fast + calls.large) % STATS_LOG_EVERY === 0) {
+    log.info('Formatting latency by tier', () => getFormattingStats())
+  }
+}
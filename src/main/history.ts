@@ -1,8 +1,13 @@
 import { app } from 'electron'
 import { join } from 'path'
 import { readFileSync, writeFileSync, existsSync, copyFileSync } from 'fs'
+import { EventEmitter } from 'events'
 import { v4 as uuidv4 } from 'uuid'
 import { encryptData, decryptData, detectStorageVersion } from './encryption'
+import { summarizeUsage } from './usage'
+import { countWords } from './text-segmentation'
+import type { UsageRecord, UsageSummary } from './usage'
+import { createLogger, errorFields } from './logger'
 
 export interface HistoryItem {
   id: string
@@ -10,6 +15,8 @@ export interface HistoryItem {
   timestamp: number
   duration: number // in seconds
   wpm: number
+  words?: number // Script-aware count (text-segmentation.ts); filled in on load for older entries
+  usage?: UsageRecord // Cost of the pipeline run (usage.ts); absent on older entries
 }
 
 export interface Stats {
@@ -18,15 +25,60 @@ export interface Stats {
   averageWpm: number
 }
 
+// Change events pushed to subscribed windows (see subscriptions.ts)
+export type HistoryChange = { op: 'add'; item: HistoryItem } | { op: 'delete'; id: string }
+
 const HISTORY_FILE = 'history.json'
+export const MAX_HISTORY_ENTRIES = 1000
+const WEEK_MS = 7 * 24 * 60 * 60 * 1000
+
+const log = createLogger('History')
+
+// Emits 'change' with a HistoryChange after every successful mutation
+export const historyEvents = new EventEmitter()
+
+// Decrypted history kept in memory so reads don't re-decrypt the file
+let historyCache: HistoryItem[] | null = null
+
+// Totals over historyCache, rebuilt whenever the cache is replaced so stats queries
+// don't walk (or re-segment) the whole history. Each entry is segmented once: its
+// count is stored on the entry
+let totals = { words: 0, wpmSum: 0, wpmCount: 0 }
+
+const wordsOf = (item: HistoryItem): number => (item.words ??= countWords(item.text))
+
+const resetTotals = (items: HistoryItem[]): void => {
+  totals = { words: 0, wpmSum: 0, wpmCount: 0 }
+  for (const item of items) {
+    totals.words += wordsOf(item)
+    if (item.wpm > 0) {
+      totals.wpmSum += item.wpm
+      totals.wpmCount++
+    }
+  }
+}
+
+// Serializes read-modify-write cycles so concurrent adds/deletes don't drop entries
+let mutationQueue: Promise<unknown> = Promise.resolve()
+const enqueueMutation = <T>(mutation: () => Promise<T>): Promise<T> => {
+  const run = mutationQueue.then(mutation)
+  mutationQueue = run.catch(() => undefined)
+  return run
+}
 
 const getHistoryPath = (): string => {
   return join(app.getPath('userData'), HISTORY_FILE)
 }
 
 export const loadHistory = async (): Promise<HistoryItem[]> => {
+  if (historyCache) {
+    return [...historyCache]
+  }
+
   const path = getHistoryPath()
   if (!existsSync(path)) {
+    historyCache = []
+    resetTotals(historyCache)
     return []
   }
   try {
@@ -38,30 +90,35 @@ export const loadHistory = async (): Promise<HistoryItem[]> => {
 
     if (version === 1) {
       // Old plaintext format - return as-is, will encrypt on next save
-      console.log('[History] Detected plaintext format, will migrate on next save')
-      return Array.isArray(parsed) ? parsed : []
+      log.info('Detected plaintext format, will migrate on next save')
+      historyCache = Array.isArray(parsed) ? parsed : []
+      resetTotals(historyCache)
+      return [...historyCache]
     } else {
       // Version 2 - encrypted format
       try {
         const decrypted = await decryptData(parsed.data)
-        return decrypted
+        historyCache = decrypted
+        resetTotals(decrypted)
+        return [...decrypted]
       } catch (error) {
-        console.error('[History] Decryption failed:', error)
+        log.error('Decryption failed', () => errorFields(error))
 
         // Create backup of corrupted file
         const backupPath = path + '.corrupted.' + Date.now()
         copyFileSync(path, backupPath)
-        console.error('[History] Corrupted file backed up to:', backupPath)
+        log.error('Corrupted file backed up', { backupPath })
 
         return []
       }
     }
   } catch (error) {
-    console.error('[History] Failed to load history:', error)
+    log.error('Failed to load history', () => errorFields(error))
     return []
   }
 }
 
+// Throws when the write fails, so callers only publish changes that persisted
 export const saveHistory = async (history: HistoryItem[]): Promise<void> => {
   const path = getHistoryPath()
   try {
@@ -70,74 +127,80 @@ export const saveHistory = async (history: HistoryItem[]): Promise<void> => {
     const wrapper = { version: 2 as const, data: encrypted }
 
     // Write encrypted data
-    writeFileSync(path, JSON.stringify(wrapper, null, 2), 'utf-8')
-    console.log('[History] Saved encrypted history')
+    writeFileSync(path, JSON.stringify(wrapper), 'utf-8')
+    historyCache = [...history]
+    resetTotals(historyCache)
+    log.debug('Saved encrypted history')
   } catch (error) {
-    console.error('[History] Failed to save history:', error)
+    log.error('Failed to save history', () => errorFields(error))
+    throw error
   }
 }
 
-export const addHistoryEntry = async (text: string, durationMs: number): Promise<HistoryItem> => {
-  const history = await loadHistory()
-
-  const wordCount = text.trim().split(/\s+/).length
-  const durationMin = durationMs / 1000 / 60
-  const wpm = durationMin > 0 ? Math.round(wordCount / durationMin) : 0
+export const addHistoryEntry = (text: string, durationMs: number, usage?: UsageRecord): Promise<HistoryItem> =>
+  enqueueMutation(async () => {
+    const history = await loadHistory()
+
+    const wordCount = countWords(text)
+    const durationMin = durationMs / 1000 / 60
+    const wpm = durationMin > 0 ? Math.round(wordCount / durationMin) : 0
+
+    const newItem: HistoryItem = {
+      id: uuidv4(),
+      text,
+      timestamp: Date.now(),
+      duration: durationMs / 1000,
+      wpm,
+      words: wordCount,
+      usage
+    }
 
-  const newItem: HistoryItem = {
-    id: uuidv4(),
-    text,
-    timestamp: Date.now(),
-    duration: durationMs / 1000,
-    wpm
-  }
+    // Add to beginning
+    history.unshift(newItem)
 
-  // Add to beginning
-  history.unshift(newItem)
+    // Limit to last MAX_HISTORY_ENTRIES entries
+    if (history.length > MAX_HISTORY_ENTRIES) {
+      history.length = MAX_HISTORY_ENTRIES
+    }
 
-  // Limit to last 1000 entries
-  if (history.length > 1000) {
-    history.length = 1000
-  }
+    await saveHistory(history)
 
-  await saveHistory(history)
+    const change: HistoryChange = { op: 'add', item: newItem }
+    historyEvents.emit('change', change)
 
-  return newItem
-}
+    return newItem
+  })
 
 export const getStats = async (): Promise<Stats> => {
-  const history = await loadHistory()
-  const now = Date.now()
-  const oneWeekAgo = now - 7 * 24 * 60 * 60 * 1000
+  await loadHistory()
+  const history = historyCache ?? []
+  const oneWeekAgo = Date.now() - WEEK_MS
 
-  let totalWords = 0
+  // Newest first, so the week is a prefix
   let weeklyWords = 0
-  let totalWpm = 0
-  let wpmCount = 0
-
-  history.forEach((item: HistoryItem) => {
-    const words = item.text.trim().split(/\s+/).length
-    totalWords += words
-
-    if (item.timestamp > oneWeekAgo) {
-      weeklyWords += words
-    }
-
-    if (item.wpm > 0) {
-      totalWpm += item.wpm
-      wpmCount++
-    }
-  })
+  for (const item of history) {
+    if (item.timestamp <= oneWeekAgo) break
+    weeklyWords += wordsOf(item)
+  }
 
   return {
-    totalWords,
+    totalWords: totals.words,
     weeklyWords,
-    averageWpm: wpmCount > 0 ? Math.round(totalWpm / wpmCount) : 0
+    averageWpm: totals.wpmCount > 0 ? Math.round(totals.wpmSum / totals.wpmCount) : 0
   }
 }
 
-export const deleteHistoryItem = async (id: string): Promise<void> => {
-  let history = await loadHistory()
-  history = history.filter((item: HistoryItem) => item.id !== id)
-  await saveHistory(history)
-}
+// Aggregated cost of the dictations still in history, for capacity planning
+export const getUsageSummary = async (): Promise<UsageSummary> => summarizeUsage(await loadHistory())
+
+export const deleteHistoryItem = (id: string): Promise<void> =>
+  enqueueMutation(async () => {
+    const history = await loadHistory()
+    const remaining = history.filter((item: HistoryItem) => item.id !== id)
+    if (remaining.length === history.length) return
+
+    await saveHistory(remaining)
+
+    const change: HistoryChange = { op: 'delete', id }
+    historyEvents.emit('change', change)
+  })
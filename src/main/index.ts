@@ -7,24 +7,113 @@ import {
   Tray,
   Menu,
   nativeImage,
-  screen
+  screen,
+  dialog
 } from 'electron'
 import { join } from 'path'
 import * as fs from 'fs'
 import { electronApp, optimizer, is } from '@electron-toolkit/utils'
 import { uIOhook } from 'uiohook-napi'
-import { loadHistory, getStats, deleteHistoryItem } from './history'
-import { loadNotes, addNote, deleteNote, updateNote } from './notes'
+import {
+  loadHistory,
+  getStats,
+  getUsageSummary,
+  deleteHistoryItem,
+  addHistoryEntry,
+  historyEvents
+} from './history'
+import { loadNotes, addNote, deleteNote, updateNote, notesEvents } from './notes'
+import {
+  loadDictionary,
+  addDictionaryEntry,
+  updateDictionaryEntry,
+  deleteDictionaryEntry,
+  importDictionaryFile,
+  migrateDictionaryFromSettings,
+  dictionaryEvents
+} from './dictionary'
+import {
+  initStoreSubscriptions,
+  registerStoreTopic,
+  publishStoreDelta,
+  hasStoreSubscribers
+} from './subscriptions'
 import icon from '../../resources/icon.png?asset'
-import { processAudio, injectText, Settings } from './openai'
-import { initializeEncryption, encryptData, decryptData, detectStorageVersion, exportMasterKey, importMasterKey } from './encryption'
-import 'dotenv/config'
+import type { Settings, ProcessAudioOptions, ProcessAudioResult } from './openai'
+import { injectText } from './inject'
+import { configureNative, getNativeCapabilities } from './native'
+import {
+  startPipeline,
+  stopPipeline,
+  runPipeline,
+  runPipelinePcm,
+  updatePipelineDictionary
+} from './pipeline'
+import {
+  CAPTURE_SAMPLE_RATE,
+  isMainCaptureAvailable,
+  isMainCaptureActive,
+  startMainCapture,
+  stopMainCapture,
+  cancelMainCapture,
+  isKeywordListening
+} from './capture'
+import {
+  DEFAULT_WAKE_WORD_THRESHOLD,
+  WAKE_WORD_PREROLL_MS,
+  SilenceEndpointer,
+  findWakeWordModel,
+  isWakeWordSupported,
+  startWakeWord,
+  stopWakeWord
+} from './wake-word'
+import { configureWindowPool, prewarmWindow, showPooledWindow, getPooledWindow } from './window-pool'
+import { initializeEncryption, encryptData, decryptData, detectStorageVersion, exportMasterKey, importMasterKey, KeyRotationInProgressError } from './encryption'
+import { resumeKeyRotation, startKeyRotation } from './key-rotation'
+import { markStartup, finishStartupTrace } from './startup-trace'
+import {
+  CaptureHealth,
+  recordCaptureHealth,
+  getCaptureHealthRecords,
+  onCaptureHealth
+} from './capture-health'
+import { configureLogger, createLogger, errorFields, flushLogs, redactTranscript } from './logger'
+import {
+  startResourceMonitor,
+  stopResourceMonitor,
+  getResourceSamples,
+  exportResourceSamples,
+  setDaemonPid
+} from './resource-monitor'
+import {
+  DEFAULT_LATENCY_TARGET_MS,
+  getDegradationPlan,
+  recordDictation,
+  setLatencyTarget
+} from './slo-controller'
+
+markStartup('main-module-loaded')
+
+// Deferred startup work (pipeline worker) waits this long after the hotkey is live
+const DEFERRED_STARTUP_DELAY_MS = 1000
+
+const dictationLog = createLogger('Dictation')
+const appLog = createLogger('App')
+const settingsLog = createLogger('Settings')
+const shortcutLog = createLogger('Shortcut')
+const ipcLog = createLogger('IPC')
+const displayLog = createLogger('Display')
 
 let mainWindow: BrowserWindow | null = null
-let settingsWindow: BrowserWindow | null = null
 let tray: Tray | null = null
 let mainWindowReady = false // Track when renderer is ready to receive IPC
 
+// Bundled resources that native code reads from disk (unpacked from app.asar)
+const wakeWordResourcesPath = (): string =>
+  app.isPackaged
+    ? join(process.resourcesPath, 'app.asar.unpacked', 'resources')
+    : join(process.cwd(), 'resources')
+
 function createWindow(): void {
   // Create the browser window.
   const { x: workAreaX, y: workAreaY, width: workAreaWidth, height: workAreaHeight } = screen.getPrimaryDisplay().workArea
@@ -51,7 +140,9 @@ function createWindow(): void {
     ...(process.platform === 'linux' ? { icon } : {}),
     webPreferences: {
       preload: join(__dirname, '../preload/index.js'),
-      sandbox: false
+      sandbox: false,
+      // Cache compiled renderer code on first load instead of after repeated runs
+      v8CacheOptions: 'bypassHeatCheck'
     }
   })
 
@@ -90,10 +181,11 @@ function createWindow(): void {
 
   // HMR for renderer base on electron-vite cli.
   // Load the remote URL for development or the local html file for production.
+  // The pill has its own small entry; settings and examples load index.html
   if (is.dev && process.env['ELECTRON_RENDERER_URL']) {
-    mainWindow.loadURL(process.env['ELECTRON_RENDERER_URL'])
+    mainWindow.loadURL(`${process.env['ELECTRON_RENDERER_URL']}/pill.html`)
   } else {
-    mainWindow.loadFile(join(__dirname, '../renderer/index.html'))
+    mainWindow.loadFile(join(__dirname, '../renderer/pill.html'))
   }
 }
 
@@ -102,9 +194,7 @@ function createWindow(): void {
 function ensureWindowMatchesDisplay(): void {
   if (mainWindow && !mainWindow.isDestroyed()) {
     const { width, height } = screen.getPrimaryDisplay().bounds
-    console.log(
-      `[Display Fix] Ensuring window matches display with manual offset: ${width}x${height} at -100,0`
-    )
+    displayLog.info(() => `Ensuring window matches display with manual offset: ${width}x${height} at -100,0`)
     mainWindow.setBounds({
       x: -100,
       y: 0,
@@ -118,16 +208,15 @@ function ensureWindowMatchesDisplay(): void {
 // initialization and is ready to create browser windows.
 // Some APIs can only be used after this event occurs.
 app.whenReady().then(async () => {
-  // Make mainWindow accessible globally for whisper-local.ts
-  ;(global as any).getMainWindow = (): BrowserWindow | null => mainWindow
-
-  // Initialize encryption system FIRST
-  try {
-    await initializeEncryption()
-    console.log('[App] Encryption initialized successfully')
-  } catch (error) {
-    console.error('[App] Failed to initialize encryption:', error)
-  }
+  markStartup('app-ready')
+
+  // Structured log in userData/logs; WISPR_LOG_TRANSCRIPTS=1 stops transcript redaction
+  configureLogger({
+    directory: join(app.getPath('userData'), 'logs'),
+    consoleEcho: is.dev,
+    level: is.dev ? 'debug' : 'info',
+    logTranscripts: process.env.WISPR_LOG_TRANSCRIPTS === '1'
+  })
 
   // Set app user model id for windows
   electronApp.setAppUserModelId('com.electron')
@@ -139,6 +228,148 @@ app.whenReady().then(async () => {
     optimizer.watchWindowShortcuts(window)
   })
 
+  // Settings Management - loaded in the background, awaited before tray menu and shortcuts
+  const settingsPath = join(app.getPath('userData'), 'settings.json')
+  let settings: Settings = {
+    hotkey: 'CommandOrControl+Shift+Space',
+    triggerMode: 'toggle', // 'toggle' | 'hold'
+    holdKey: null as number | null,
+    startOnLogin: false,
+    style: 'polished',
+    language: 'auto',
+    customInstructions: ''
+  }
+
+  const loadSettings = async () => {
+    try {
+      // Load local settings first
+      if (fs.existsSync(settingsPath)) {
+        const raw = fs.readFileSync(settingsPath, 'utf-8')
+        const parsed = JSON.parse(raw)
+
+        // Detect storage format version
+        const version = detectStorageVersion(parsed)
+
+        if (version === 1) {
+          // Old plaintext format - load directly, will encrypt on next save
+          settingsLog.info('Detected plaintext format, will migrate on next save')
+          settings = { ...settings, ...parsed }
+        } else {
+          // Version 2 - encrypted format
+          try {
+            const decrypted = await decryptData(parsed.data)
+            settings = { ...settings, ...decrypted }
+            settingsLog.info('Loaded encrypted settings')
+          } catch (error) {
+            settingsLog.error('Decryption failed, using defaults', () => errorFields(error))
+          }
+        }
+      }
+
+      setLatencyTarget(settings.latencyTargetMs ?? DEFAULT_LATENCY_TARGET_MS)
+
+      // Sync login item settings
+      if (typeof settings.startOnLogin === 'boolean') {
+        app.setLoginItemSettings({ openAtLogin: settings.startOnLogin })
+      }
+    } catch (error) {
+      settingsLog.error('Failed to load settings', () => errorFields(error))
+    }
+  }
+
+  const saveSettings = async () => {
+    try {
+      // Encrypt the settings
+      const encrypted = await encryptData(settings)
+      // The hotkey is also kept in the clear, so it can be registered before decryption
+      const wrapper = { version: 2 as const, data: encrypted, hotkey: settings.hotkey }
+
+      // Write encrypted data
+      fs.writeFileSync(settingsPath, JSON.stringify(wrapper))
+      settingsLog.debug('Saved encrypted settings')
+    } catch (error) {
+      settingsLog.error('Failed to save settings', () => errorFields(error))
+    }
+  }
+
+  // Push single-key changes to windows subscribed to settings
+  const publishSetting = (key: keyof Settings): void => {
+    publishStoreDelta('settings', { key, value: settings[key] })
+  }
+
+  configureNative({ isPackaged: app.isPackaged, resourcesPath: process.resourcesPath })
+
+  // Show the pill first - everything below runs while its renderer boots
+  createWindow()
+  markStartup('window-created')
+
+  // The hotkey goes live now, from the clear copy in settings.json (or the default),
+  // rather than after key derivation and decryption. A press before the dictation
+  // handlers exist is held and replayed; the shortcut is re-registered once settings load
+  let onHotkey: (() => void) | null = null
+  let hotkeyPressedEarly = false
+  const readStartupHotkey = (): string => {
+    try {
+      const parsed = JSON.parse(fs.readFileSync(settingsPath, 'utf-8'))
+      if (typeof parsed?.hotkey === 'string' && parsed.hotkey) return parsed.hotkey
+    } catch {
+      // No settings file yet
+    }
+    return settings.hotkey
+  }
+  try {
+    globalShortcut.register(readStartupHotkey(), () => {
+      if (onHotkey) onHotkey()
+      else hotkeyPressedEarly = true
+    })
+  } catch (error) {
+    shortcutLog.error('Failed to register shortcut', () => errorFields(error))
+  }
+  markStartup('hotkey-ready')
+
+  // Encryption (PBKDF2 on first run) and settings load run in the background
+  const encryptionReady = initializeEncryption()
+    .then(() => {
+      appLog.info('Encryption initialized successfully')
+      markStartup('encryption-ready')
+
+      // Finish any key rotation interrupted by a crash or quit (runs in the background)
+      resumeKeyRotation().catch((error) => {
+        appLog.error('Failed to resume key rotation', () => errorFields(error))
+      })
+    })
+    .catch((error) => {
+      appLog.error('Failed to initialize encryption', () => errorFields(error))
+    })
+  const settingsReady = encryptionReady.then(loadSettings)
+
+  // Store subscriptions - windows get a snapshot once, then deltas
+  initStoreSubscriptions()
+  registerStoreTopic('history', () => encryptionReady.then(loadHistory))
+  registerStoreTopic('stats', () => encryptionReady.then(getStats))
+  registerStoreTopic('notes', () => encryptionReady.then(loadNotes))
+  registerStoreTopic('dictionary', () => encryptionReady.then(loadDictionary))
+  registerStoreTopic('diagnostics', getResourceSamples)
+  registerStoreTopic('capture-health', getCaptureHealthRecords)
+  onCaptureHealth((record) => publishStoreDelta('capture-health', record))
+  registerStoreTopic('settings', async () => {
+    await settingsReady
+    return settings
+  })
+
+  historyEvents.on('change', (change) => {
+    publishStoreDelta('history', change)
+    // Stats are three numbers - push them whole rather than diffing
+    if (hasStoreSubscribers('stats')) {
+      getStats().then((stats) => publishStoreDelta('stats', stats))
+    }
+  })
+  notesEvents.on('change', (change) => publishStoreDelta('notes', change))
+  dictionaryEvents.on('change', (change) => {
+    publishStoreDelta('dictionary', change)
+    updatePipelineDictionary(change)
+  })
+
   // Force Dock Icon on macOS
   if (process.platform === 'darwin' && app.dock) {
     app.dock.setIcon(nativeImage.createFromPath(icon))
@@ -146,7 +377,7 @@ app.whenReady().then(async () => {
   }
 
   // IPC test
-  ipcMain.on('ping', () => console.log('pong'))
+  ipcMain.on('ping', () => appLog.debug('pong'))
 
   // Hide Window IPC (Logical hide - stop recording/processing UI)
   ipcMain.on('hide-window', () => {
@@ -194,26 +425,52 @@ app.whenReady().then(async () => {
 
   ipcMain.handle('transcribe-buffer', async (_, buffer) => {
     try {
-      console.log('[Performance] Processing note audio buffer...')
-      const text = await processAudio(buffer, settings)
+      const { text, durationMs, usage } = await runPipeline(buffer, settings, { diarize: true })
+      if (text) {
+        addHistoryEntry(text, durationMs, usage).catch((error) =>
+          dictationLog.error('Failed to save the note to history', () => errorFields(error))
+        )
+      }
       return text
     } catch (error) {
-      console.error('Error transcribing note buffer:', error)
+      dictationLog.error('Error transcribing note buffer', () => errorFields(error))
       return ''
     }
   })
 
-  // Audio Data Handler (Batch mode - OpenAI)
-  ipcMain.on('audio-data', async (_, buffer) => {
+  // Degradation chosen by the latency controller at key release (see slo-controller.ts)
+  let dictationPlan = getDegradationPlan()
+  let releasedAt: number | null = null
+
+  const plannedSettings = (): Settings =>
+    dictationPlan.localModel ? { ...settings, localModel: dictationPlan.localModel } : settings
+
+  const plannedOptions = (): ProcessAudioOptions => ({
+    skipFormattingUnderWords: dictationPlan.skipFormattingUnderWords
+  })
+
+  // Shared tail of a dictation: history, hide, inject, reset the pill
+  // `clock` holds when the key was released and when the audio was in hand
+  const finishDictation = async (
+    result: Promise<ProcessAudioResult>,
+    clock: { releasedAt: number; capturedAt: number }
+  ): Promise<void> => {
     try {
-      console.log('[Performance] Received audio data in main process')
-      console.time('Audio Processing')
       const startProcessing = performance.now()
 
-      // 1. Process Audio (Transcribe)
-      const text = await processAudio(buffer, settings)
-      console.log('[Performance] Transcription complete:', text)
-      console.timeEnd('Audio Processing')
+      // 1. Process Audio (Transcribe) in the pipeline utility process
+      const { text, durationMs, stageMs, usage } = await result
+      const transcriptionMs = performance.now() - startProcessing
+      dictationLog.info(() => `Transcription complete: ${redactTranscript(text)}`, () => ({
+        ms: Math.round(transcriptionMs)
+      }))
+
+      // Save to History
+      if (text) {
+        addHistoryEntry(text, durationMs, usage).catch((error) =>
+          dictationLog.error('Failed to save the dictation to history', () => errorFields(error))
+        )
+      }
 
       // 2. Hide Window (Logical)
       if (mainWindow) {
@@ -221,6 +478,7 @@ app.whenReady().then(async () => {
       }
 
       // 3. Handle Text
+      const injectStarted = performance.now()
       if (text) {
         // Case B: General Flow (Inject Text)
         // Wait for focus to return (aggressively reduced to 10ms for testing)
@@ -234,7 +492,21 @@ app.whenReady().then(async () => {
       }
 
       const totalTime = performance.now() - startProcessing
-      console.log(`[Performance] Total Main Process Time: ${totalTime.toFixed(2)}ms`)
+      dictationLog.info('Total main process time', () => ({ ms: Math.round(totalTime) }))
+
+      if (stageMs) {
+        recordDictation({
+          stages: {
+            capture: clock.capturedAt - clock.releasedAt,
+            transcribe: stageMs.transcribe,
+            format: stageMs.format,
+            inject: performance.now() - injectStarted
+          },
+          audioMs: durationMs,
+          mode: settings.transcriptionMode || 'cloud',
+          localModel: settings.localModel || 'base'
+        })
+      }
 
       // Reset UI to idle state immediately
       if (mainWindow) {
@@ -253,13 +525,26 @@ app.whenReady().then(async () => {
         }
       }
     } catch (error) {
-      console.error('Error processing audio:', error)
+      dictationLog.error('Error processing audio', () => errorFields(error))
       // Ensure UI resets even on error
       if (mainWindow) {
         mainWindow.webContents.send('reset-ui')
       }
     }
+  }
+
+  // Audio Data Handler (Batch mode - OpenAI)
+  ipcMain.on('audio-data', (_, buffer, health?: CaptureHealth) => {
+    dictationLog.debug(() => `Received ${buffer.byteLength} bytes of audio from the pill`)
+    const capturedAt = performance.now()
+    if (health && typeof health === 'object') recordCaptureHealth({ ...health, source: 'renderer' })
+    finishDictation(runPipeline(buffer, plannedSettings(), plannedOptions()), {
+      releasedAt: releasedAt ?? capturedAt,
+      capturedAt
+    })
+    releasedAt = null
   })
+
   // Create Tray Icon
   const image = nativeImage.createFromPath(icon)
   if (process.platform === 'darwin') {
@@ -268,70 +553,23 @@ app.whenReady().then(async () => {
   tray = new Tray(image.resize({ width: 22, height: 22 })) // Standard size for macOS menu bar
   tray.setToolTip('Wispr Flow Clone')
 
-  // Settings Management - LOAD BEFORE creating window and tray menu
-  const settingsPath = join(app.getPath('userData'), 'settings.json')
-  let settings: Settings = {
-    hotkey: 'CommandOrControl+Shift+Space',
-    triggerMode: 'toggle', // 'toggle' | 'hold'
-    holdKey: null as number | null,
-    startOnLogin: false,
-    style: 'polished',
-    language: 'auto',
-    customInstructions: ''
-  }
-
-  const loadSettings = async () => {
-    try {
-      // Load local settings first
-      if (fs.existsSync(settingsPath)) {
-        const raw = fs.readFileSync(settingsPath, 'utf-8')
-        const parsed = JSON.parse(raw)
-
-        // Detect storage format version
-        const version = detectStorageVersion(parsed)
-
-        if (version === 1) {
-          // Old plaintext format - load directly, will encrypt on next save
-          console.log('[Settings] Detected plaintext format, will migrate on next save')
-          settings = { ...settings, ...parsed }
-        } else {
-          // Version 2 - encrypted format
-          try {
-            const decrypted = await decryptData(parsed.data)
-            settings = { ...settings, ...decrypted }
-            console.log('[Settings] Loaded encrypted settings')
-          } catch (error) {
-            console.error('[Settings] Decryption failed, using defaults:', error)
-          }
-        }
-      }
+  // Tray menu and shortcuts need the user's settings
+  await settingsReady
+  markStartup('settings-loaded')
 
-      // Sync login item settings
-      if (typeof settings.startOnLogin === 'boolean') {
-        app.setLoginItemSettings({ openAtLogin: settings.startOnLogin })
-      }
-    } catch (error) {
-      console.error('[Settings] Failed to load settings:', error)
-    }
+  // Dictionary entries used to live in settings - move them to their own store once
+  const legacySettings = settings as Settings & {
+    dictionaryEntries?: { term: string; replacement: string }[]
   }
-
-  const saveSettings = async () => {
-    try {
-      // Encrypt the settings
-      const encrypted = await encryptData(settings)
-      const wrapper = { version: 2 as const, data: encrypted }
-
-      // Write encrypted data
-      fs.writeFileSync(settingsPath, JSON.stringify(wrapper, null, 2))
-      console.log('[Settings] Saved encrypted settings')
-    } catch (error) {
-      console.error('[Settings] Failed to save settings:', error)
-    }
+  if (Array.isArray(legacySettings.dictionaryEntries)) {
+    migrateDictionaryFromSettings(legacySettings.dictionaryEntries)
+      .then(() => {
+        delete legacySettings.dictionaryEntries
+        return saveSettings()
+      })
+      .catch((error) => appLog.error('Dictionary migration from settings failed', () => errorFields(error)))
   }
 
-  // Load settings FIRST
-  await loadSettings()
-
   // Language options for tray menu (all Whisper-supported languages)
   const languages = [
     { code: 'en', label: '🇺🇸 English' },
@@ -474,6 +712,7 @@ app.whenReady().then(async () => {
       click: () => {
         settings.language = lang.code
         saveSettings()
+        publishSetting('language')
         buildTrayMenu() // Rebuild to update checkmarks
       }
     }))
@@ -503,6 +742,7 @@ app.whenReady().then(async () => {
         click: () => {
           settings.transcriptionMode = privacyMode ? 'cloud' : 'local'
           saveSettings()
+          publishSetting('transcriptionMode')
           buildTrayMenu() // Rebuild to update checkmark and label
         }
       },
@@ -527,8 +767,96 @@ app.whenReady().then(async () => {
   // Build initial tray menu
   buildTrayMenu()
 
-  // Then create window
-  createWindow()
+  // Start/stop a dictation from a hotkey or the wake phrase
+  // With captureBackend 'native' (or while listening for the wake phrase, which keeps
+  // the device open) the microphone records right here in main; otherwise the pill
+  // renderer records with getUserMedia/MediaRecorder after 'window-shown'
+  const useMainCapture = (): boolean =>
+    isKeywordListening() || (settings.captureBackend === 'native' && isMainCaptureAvailable())
+
+  const startDictation = (trigger: 'hotkey' | 'wake-word' = 'hotkey'): void => {
+    if (!mainWindowReady || !mainWindow || mainWindow.isDestroyed()) {
+      dictationLog.warn('mainWindow not ready, ignoring shortcut')
+      return
+    }
+    if (isMainCaptureActive()) return // Key autorepeat
+    const hotkeyAt = performance.now()
+
+    if (useMainCapture()) {
+      // Hands-free dictations end by themselves once the speaker stops
+      const endpointer = trigger === 'wake-word' ? new SilenceEndpointer(hotkeyAt) : null
+      const backend = startMainCapture(
+        {
+          onLevel: (level) => {
+            mainWindow?.webContents.send('capture-level', level)
+            if (endpointer?.push(level) && isRecordingState) stopDictation()
+          }
+        },
+        hotkeyAt,
+        trigger === 'wake-word' ? WAKE_WORD_PREROLL_MS : 0
+      )
+      if (backend) {
+        isRecordingState = true
+        mainWindow.webContents.send('capture-started')
+        return
+      }
+      // Device failed to open - fall back to the renderer for this dictation
+    }
+
+    // Wall-clock hotkey time lets the pill measure its own start latency
+    mainWindow.webContents.send('window-shown', Date.now() - (performance.now() - hotkeyAt))
+    mainWindow.focus()
+  }
+
+  const stopDictation = (): void => {
+    if (!mainWindowReady || !mainWindow || mainWindow.isDestroyed()) return
+
+    releasedAt = performance.now()
+    dictationPlan = getDegradationPlan(settings.localModel || 'base')
+
+    // Puts the pill into its processing state (and stops a renderer recording after
+    // the trailing window, shortened when degraded)
+    mainWindow.webContents.send('window-hidden', dictationPlan.trailingCaptureMs)
+
+    if (isMainCaptureActive()) {
+      isRecordingState = false
+      const clock = { releasedAt, capturedAt: releasedAt }
+      finishDictation(
+        stopMainCapture(dictationPlan.trailingCaptureMs ?? undefined).then((captured) => {
+          clock.capturedAt = performance.now()
+          if (captured) recordCaptureHealth(captured.health)
+          return captured && captured.samples.length > 0
+            ? runPipelinePcm(captured.samples, CAPTURE_SAMPLE_RATE, plannedSettings(), plannedOptions())
+            : { text: '', durationMs: 0 }
+        }),
+        clock
+      )
+      releasedAt = null
+    }
+  }
+
+  // Hands-free activation follows its setting; it needs native capture and a keyword model
+  const configureWakeWord = (): void => {
+    if (!settings.wakeWord) {
+      stopWakeWord()
+      return
+    }
+    const modelPath = findWakeWordModel(app.getPath('userData'), wakeWordResourcesPath())
+    if (!isWakeWordSupported() || !modelPath) {
+      dictationLog.warn('Wake phrase is on but unavailable', () => ({
+        supported: isWakeWordSupported(),
+        model: modelPath
+      }))
+      return
+    }
+    startWakeWord({
+      modelPath,
+      threshold: settings.wakeWordThreshold ?? DEFAULT_WAKE_WORD_THRESHOLD,
+      onWake: () => {
+        if (!isRecordingState) startDictation('wake-word')
+      }
+    })
+  }
 
   // uiohook Integration
   let isRecordingKey = false
@@ -539,6 +867,7 @@ app.whenReady().then(async () => {
       if (isRecordingKey) {
         settings.holdKey = e.keycode
         saveSettings()
+        publishSetting('holdKey')
         isRecordingKey = false
         // Prevent immediate trigger from autorepeat
         ignorePTTKey = e.keycode
@@ -548,28 +877,20 @@ app.whenReady().then(async () => {
         // Update tray menu with new PTT key
         buildTrayMenu()
         // Notify renderer
-        if (settingsWindow) {
-          settingsWindow.webContents.send('key-recorded', e.keycode)
-        }
+        getPooledWindow('settings')?.webContents.send('key-recorded', e.keycode)
         return
       }
 
       // Escape to Stop Recording
       if (e.keycode === 1 && isRecordingState) {
-        if (mainWindow) {
-          mainWindow.webContents.send('window-hidden')
-        }
+        stopDictation()
         return
       }
 
       // PTT Logic - Only active when holdKey is explicitly configured
       // Requires holdKey to be set (not null) and match the pressed key
       if (settings.holdKey !== null && settings.holdKey === e.keycode && e.keycode !== ignorePTTKey) {
-        // Ensure mainWindow is ready before sending
-        if (mainWindowReady && mainWindow && !mainWindow.isDestroyed()) {
-          mainWindow.webContents.send('window-shown')
-          mainWindow.focus()
-        }
+        startDictation()
       }
     })
 
@@ -582,115 +903,30 @@ app.whenReady().then(async () => {
 
       // PTT Logic - Only active when holdKey is explicitly configured
       if (settings.holdKey !== null && settings.holdKey === e.keycode) {
-        // Ensure mainWindow is ready before sending
-        if (mainWindowReady && mainWindow && !mainWindow.isDestroyed()) {
-          mainWindow.webContents.send('window-hidden')
-        }
+        stopDictation()
       }
     })
 
     uIOhook.start()
   } catch (error) {
-    console.error('Failed to start uiohook:', error)
+    shortcutLog.error('Failed to start uiohook', () => errorFields(error))
   }
 
-  // Settings Window
-  
-  const createSettingsWindow = (tab?: string) => {
-    // Build the hash route - default to 'settings', or 'settings/shortcuts' if specified
-    const hashRoute = tab ? `settings/${tab}` : 'settings'
-
-    if (settingsWindow) {
-      if (settingsWindow.isDestroyed()) {
-        settingsWindow = null
-      } else {
-        // If window exists, navigate to the requested tab
-        if (tab && is.dev && process.env['ELECTRON_RENDERER_URL']) {
-          settingsWindow.loadURL(`${process.env['ELECTRON_RENDERER_URL']}#/${hashRoute}`)
-        } else if (tab) {
-          settingsWindow.loadFile(join(__dirname, '../renderer/index.html'), { hash: hashRoute })
-        }
-        settingsWindow.focus()
-        return
-      }
-    }
-
-    settingsWindow = new BrowserWindow({
-      width: 1000,
-      height: 700,
-      title: 'Settings',
-      resizable: true,
-      show: false, // Don't show until content is ready
-      autoHideMenuBar: true,
-      webPreferences: {
-        preload: join(__dirname, '../preload/index.js'),
-        sandbox: false
-      }
-    })
-
-    // Show window only after content is ready to prevent flicker
-    settingsWindow.once('ready-to-show', () => {
-      settingsWindow?.show()
-    })
-
-    if (is.dev && process.env['ELECTRON_RENDERER_URL']) {
-      settingsWindow.loadURL(`${process.env['ELECTRON_RENDERER_URL']}#/${hashRoute}`)
-    } else {
-      settingsWindow.loadFile(join(__dirname, '../renderer/index.html'), { hash: hashRoute })
+  // Settings and Examples windows come from the prewarmed pool (window-pool.ts)
+  configureWindowPool({
+    preloadPath: join(__dirname, '../preload/index.js'),
+    onHidden: (kind) => {
+      if (kind === 'settings') isRecordingKey = false
     }
+  })
 
-    // Handle closing properly
-    settingsWindow.on('closed', () => {
-      settingsWindow = null
-      isRecordingKey = false
-    })
-
-    // Also handle close event to be safe
-    settingsWindow.on('close', () => {
-      isRecordingKey = false
-    })
+  const createSettingsWindow = (tab?: string) => {
+    // Build the hash route - default to 'settings', or 'settings/shortcuts' if specified
+    showPooledWindow('settings', tab ? `settings/${tab}` : 'settings')
   }
 
-  // Examples Window
-  let examplesWindow: BrowserWindow | null = null
-
   const createExamplesWindow = () => {
-    if (examplesWindow) {
-      if (examplesWindow.isDestroyed()) {
-        examplesWindow = null
-      } else {
-        examplesWindow.focus()
-        return
-      }
-    }
-
-    examplesWindow = new BrowserWindow({
-      width: 500,
-      height: 600,
-      title: 'Custom Instruction Examples',
-      resizable: false,
-      show: false, // Don't show until content is ready
-      autoHideMenuBar: true,
-      webPreferences: {
-        preload: join(__dirname, '../preload/index.js'),
-        sandbox: false
-      }
-    })
-
-    // Show window only after content is ready to prevent flicker
-    examplesWindow.once('ready-to-show', () => {
-      examplesWindow?.show()
-    })
-
-    if (is.dev && process.env['ELECTRON_RENDERER_URL']) {
-      examplesWindow.loadURL(`${process.env['ELECTRON_RENDERER_URL']}#/examples`)
-    } else {
-      examplesWindow.loadFile(join(__dirname, '../renderer/index.html'), { hash: 'examples' })
-    }
-
-    examplesWindow.on('closed', () => {
-      examplesWindow = null
-    })
+    showPooledWindow('examples', 'examples')
   }
 
   ipcMain.on('open-examples-window', () => {
@@ -727,8 +963,12 @@ app.whenReady().then(async () => {
     return getStats()
   })
 
+  ipcMain.handle('get-usage-summary', () => {
+    return encryptionReady.then(getUsageSummary)
+  })
+
   ipcMain.handle('delete-history-item', (_, id) => {
-    deleteHistoryItem(id)
+    return deleteHistoryItem(id)
   })
 
   // Notes Handlers
@@ -741,11 +981,72 @@ app.whenReady().then(async () => {
   })
 
   ipcMain.handle('delete-note', (_, id) => {
-    deleteNote(id)
+    return deleteNote(id)
   })
 
   ipcMain.handle('update-note', (_, id, content) => {
-    updateNote(id, content)
+    return updateNote(id, content)
+  })
+
+  // Dictionary Handlers - each edit touches one entry, not the whole settings file
+  ipcMain.handle('dictionary-add', (_, term: string, replacement: string) => {
+    return addDictionaryEntry(term, replacement)
+  })
+
+  ipcMain.handle('dictionary-update', (_, key: string, term: string, replacement: string) => {
+    return updateDictionaryEntry(key, term, replacement)
+  })
+
+  ipcMain.handle('dictionary-delete', (_, key: string) => {
+    return deleteDictionaryEntry(key)
+  })
+
+  ipcMain.handle('dictionary-import', async (event) => {
+    const parent = BrowserWindow.fromWebContents(event.sender)
+    const options: Electron.OpenDialogOptions = {
+      title: 'Import Dictionary',
+      properties: ['openFile'],
+      filters: [{ name: 'CSV or TSV', extensions: ['csv', 'tsv', 'txt'] }]
+    }
+    const { canceled, filePaths } = parent
+      ? await dialog.showOpenDialog(parent, options)
+      : await dialog.showOpenDialog(options)
+    if (canceled || filePaths.length === 0) return null
+
+    try {
+      return { success: true, ...(await importDictionaryFile(filePaths[0])) }
+    } catch (error) {
+      ipcLog.error('Failed to import dictionary', () => errorFields(error))
+      return { success: false, error: String(error) }
+    }
+  })
+
+  ipcMain.handle('get-native-capabilities', () => getNativeCapabilities())
+  ipcMain.handle('get-wake-word-status', () => ({
+    supported: isWakeWordSupported(),
+    modelFound: findWakeWordModel(app.getPath('userData'), wakeWordResourcesPath()) !== null
+  }))
+
+  // Diagnostics - the live series comes through the 'diagnostics' subscription
+  ipcMain.handle('diagnostics-export', async (event) => {
+    const parent = BrowserWindow.fromWebContents(event.sender)
+    const options: Electron.SaveDialogOptions = {
+      title: 'Export Diagnostics',
+      defaultPath: `wispr-diagnostics-${new Date().toISOString().slice(0, 10)}.json`,
+      filters: [{ name: 'JSON', extensions: ['json'] }]
+    }
+    const { canceled, filePath } = parent
+      ? await dialog.showSaveDialog(parent, options)
+      : await dialog.showSaveDialog(options)
+    if (canceled || !filePath) return { success: false }
+
+    try {
+      await fs.promises.writeFile(filePath, exportResourceSamples({ captureHealth: getCaptureHealthRecords() }))
+      return { success: true, filePath }
+    } catch (error) {
+      ipcLog.error('Failed to export diagnostics', () => errorFields(error))
+      return { success: false, error: String(error) }
+    }
   })
 
   // Encryption Key Export/Import Handlers
@@ -754,7 +1055,7 @@ app.whenReady().then(async () => {
       const key = await exportMasterKey()
       return { success: true, key }
     } catch (error) {
-      console.error('[IPC] Failed to export key:', error)
+      ipcLog.error('Failed to export key', () => errorFields(error))
       return { success: false, error: String(error) }
     }
   })
@@ -763,12 +1064,17 @@ app.whenReady().then(async () => {
     try {
       const success = await importMasterKey(keyString)
       if (success) {
+        // Re-encrypt existing stores under the imported key in the background
+        startKeyRotation().catch((error) => {
+          ipcLog.error('Failed to start key rotation', () => errorFields(error))
+        })
         return { success: true }
       } else {
         return { success: false, error: 'Invalid encryption key' }
       }
     } catch (error) {
-      console.error('[IPC] Failed to import key:', error)
+      ipcLog.error('Failed to import key', () => errorFields(error))
+      if (error instanceof KeyRotationInProgressError) return { success: false, error: error.message }
       return { success: false, error: String(error) }
     }
   })
@@ -780,11 +1086,20 @@ app.whenReady().then(async () => {
     // @ts-ignore: Dynamic assignment to typed object
     settings[key] = value
     saveSettings()
+    publishSetting(key)
 
     if (key === 'startOnLogin') {
       app.setLoginItemSettings({ openAtLogin: value })
     }
 
+    if (key === 'latencyTargetMs') {
+      setLatencyTarget(value)
+    }
+
+    if (key === 'wakeWord' || key === 'wakeWordThreshold') {
+      configureWakeWord()
+    }
+
     // Always re-register global shortcut when hotkey changes
     if (key === 'hotkey') {
       globalShortcut.unregisterAll()
@@ -815,40 +1130,63 @@ app.whenReady().then(async () => {
     isRecordingState = isRecording
   })
 
+  const toggleDictation = (): void => {
+    if (isRecordingState) {
+      stopDictation()
+    } else {
+      startDictation()
+    }
+  }
+
   // Register Global Shortcut Helper
   // Always registers the Toggle shortcut regardless of triggerMode
   // This allows users to use Toggle shortcut even when PTT mode is selected
   const registerGlobalShortcut = () => {
-    console.log(`[Shortcut] registerGlobalShortcut called, hotkey=${settings.hotkey}`)
+    shortcutLog.debug(() => `registerGlobalShortcut called, hotkey=${settings.hotkey}`)
 
     try {
       globalShortcut.unregisterAll() // Clear old ones
-      const success = globalShortcut.register(settings.hotkey, () => {
-        // Ensure mainWindow is ready before sending IPC
-        if (mainWindowReady && mainWindow && !mainWindow.isDestroyed()) {
-          if (isRecordingState) {
-            // Stop
-            mainWindow.webContents.send('window-hidden')
-          } else {
-            // Start
-            mainWindow.webContents.send('window-shown')
-            mainWindow.focus()
-          }
-        } else {
-          console.log('[Shortcut] mainWindow not ready, ignoring shortcut')
-        }
-      })
-      console.log(`[Shortcut] Registered global shortcut: ${settings.hotkey}, success=${success}`)
+      const success = globalShortcut.register(settings.hotkey, toggleDictation)
+      shortcutLog.info(() => `Registered global shortcut: ${settings.hotkey}, success=${success}`)
     } catch (error) {
-      console.error('Failed to register shortcut:', error)
+      shortcutLog.error('Failed to register shortcut', () => errorFields(error))
     }
   }
 
-  // Register shortcut after a small delay to ensure everything is initialized
+  // Everything the shortcut touches is initialized by now - swap the startup
+  // registration for the user's hotkey and replay a press it caught
+  registerGlobalShortcut()
+  onHotkey = toggleDictation
+  if (hotkeyPressedEarly) {
+    hotkeyPressedEarly = false
+    toggleDictation()
+  }
+  finishStartupTrace()
+
+  // Start the audio pipeline utility process once the app is idle
+  // (the first dictation spawns it on demand if it hasn't started yet)
   setTimeout(() => {
-    console.log('[Shortcut] Delayed registration starting...')
-    registerGlobalShortcut()
-  }, 100)
+    // Load and probe the native module now rather than on the first paste
+    getNativeCapabilities()
+    configureWakeWord()
+
+    startResourceMonitor((sample) => publishStoreDelta('diagnostics', sample))
+
+    startPipeline({
+      loadDictionary: () => encryptionReady.then(loadDictionary),
+      onDaemonPid: setDaemonPid,
+      onModelDownloadProgress: (model, progress) => {
+        mainWindow?.webContents.send('model-download-progress', {
+          model,
+          progress,
+          isLoading: true
+        })
+      }
+    })
+
+    // Hidden spare renderer so Settings/Examples open without a load (window-pool.ts)
+    prewarmWindow()
+  }, DEFERRED_STARTUP_DELAY_MS)
 
   app.on('activate', function () {
     // On macOS it's common to re-create a window in the app when the
@@ -870,3 +1208,12 @@ app.on('window-all-closed', () => {
     app.quit()
   }
 })
+
+// Shut down the audio pipeline (and its WhisperKit daemon) and the microphone on quit
+app.on('will-quit', () => {
+  stopResourceMonitor()
+  stopWakeWord()
+  cancelMainCapture()
+  stopPipeline()
+  flushLogs()
+})
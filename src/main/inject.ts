@@ -0,0 +1,50 @@
+import { exec } from 'child_process'
+import { clipboard } from 'electron'
+import { sendNativePaste } from './native'
+import { createLogger, errorFields } from './logger'
+
+const log = createLogger('Inject')
+
+/**
+ * Paste text into the focused application
+ * Stays in the main process because it needs the Electron clipboard
+ */
+export async function injectText(text: string): Promise<void> {
+  return new Promise((resolve, reject) => {
+    try {
+      // 1. Set clipboard instantly using Electron API
+      // Note: Previous clipboard restore functionality was removed
+      clipboard.writeText(text)
+
+      // 2. On Linux, press Ctrl+V through XTest in-process (no child process)
+      if (process.platform === 'linux') {
+        if (!sendNativePaste()) {
+          log.warn('Native paste unavailable - text left on the clipboard')
+        }
+        resolve()
+        return
+      }
+
+      // 2. Trigger Paste (Cmd+V) using minimal AppleScript
+      // We use 'osascript -e' to avoid file I/O
+      // Aggressively reduced delay to 0.01s (10ms) for testing
+      const script = `tell application "System Events"
+                delay 0.01
+                key code 9 using command down
+            end tell`
+
+      exec(`osascript -e '${script}'`, (error) => {
+        if (error) {
+          log.error('Error injecting text', () => errorFields(error))
+          reject(error)
+        } else {
+          // 3. Clipboard restoration is disabled - text remains in clipboard
+          // for manual paste if needed
+          resolve()
+        }
+      })
+    } catch (error) {
+      reject(error)
+    }
+  })
+}
@@ -0,0 +1,174 @@
+import { app } from 'electron'
+import { join } from 'path'
+import { readFileSync, writeFileSync, existsSync, renameSync, unlinkSync } from 'fs'
+import {
+  encryptData,
+  decryptData,
+  detectStorageVersion,
+  discardPreviousKey,
+  getKeyId,
+  getMasterKey,
+  getPreviousKey,
+  isEncryptedWithCurrentKey
+} from './encryption'
+import { createLogger, errorFields } from './logger'
+
+// Stores that are re-encrypted when the master key changes
+const ROTATED_STORES = ['history.json', 'notes.json', 'settings.json', 'dictionary.json']
+const ROTATION_MARKER_FILE = 'key-rotation.json'
+
+// Pause between stores so the main process keeps serving IPC and hotkeys
+const STORE_INTERVAL_MS = 250
+
+const log = createLogger('KeyRotation')
+
+// Progress marker persisted after every store, so a crash resumes where it left off
+interface RotationMarker {
+  targetKeyId: string
+  completed: string[]
+  startedAt: number
+}
+
+let rotationRunning = false
+
+const getMarkerPath = (): string => {
+  return join(app.getPath('userData'), ROTATION_MARKER_FILE)
+}
+
+const readMarker = (): RotationMarker | null => {
+  const path = getMarkerPath()
+  if (!existsSync(path)) {
+    return null
+  }
+  try {
+    return JSON.parse(readFileSync(path, 'utf-8'))
+  } catch (error) {
+    log.error('Failed to read progress marker', () => errorFields(error))
+    return null
+  }
+}
+
+const writeMarker = (marker: RotationMarker): void => {
+  writeFileSync(getMarkerPath(), JSON.stringify(marker))
+}
+
+/**
+ * Re-encrypt a single store under the current key
+ * Returns once the store is either rotated or found to need no work
+ */
+const rotateStore = async (file: string): Promise<void> => {
+  const path = join(app.getPath('userData'), file)
+  if (!existsSync(path)) {
+    return
+  }
+
+  const raw = readFileSync(path, 'utf-8')
+  const parsed = JSON.parse(raw)
+
+  // Plaintext stores are encrypted with the current key on their next save
+  if (detectStorageVersion(parsed) !== 2) {
+    return
+  }
+
+  if (await isEncryptedWithCurrentKey(parsed.data)) {
+    return
+  }
+
+  const decrypted = await decryptData(parsed.data)
+  const encrypted = await encryptData(decrypted)
+  // Other wrapper fields (the clear hotkey copy in settings.json) are kept
+  const serialized = JSON.stringify({ ...parsed, version: 2 as const, data: encrypted })
+
+  // The app may have saved this store while we were encrypting - its write already
+  // uses the new key and is newer than our copy, so leave it alone
+  if (readFileSync(path, 'utf-8') !== raw) {
+    log.info(() => `${file} changed during rotation, keeping newer copy`)
+    return
+  }
+
+  // Write to a temp file and rename so a crash never leaves a half-written store
+  const tempPath = path + '.rotating'
+  writeFileSync(tempPath, serialized, 'utf-8')
+  renameSync(tempPath, path)
+}
+
+const runRotation = async (marker: RotationMarker): Promise<void> => {
+  if (rotationRunning) {
+    return
+  }
+  rotationRunning = true
+
+  try {
+    for (const file of ROTATED_STORES) {
+      if (marker.completed.includes(file)) {
+        continue
+      }
+
+      await new Promise((resolve) => setTimeout(resolve, STORE_INTERVAL_MS))
+
+      try {
+        await rotateStore(file)
+        log.info(() => `Re-encrypted ${file}`)
+      } catch (error) {
+        // Leave the marker in place - the previous key stays available and we retry on next launch
+        log.error(() => `Failed to re-encrypt ${file}`, () => errorFields(error))
+        return
+      }
+
+      marker.completed.push(file)
+      writeMarker(marker)
+    }
+
+    discardPreviousKey()
+    unlinkSync(getMarkerPath())
+    log.info(() => `Rotation complete after ${Date.now() - marker.startedAt}ms`)
+  } finally {
+    rotationRunning = false
+  }
+}
+
+// Runs in the background; a failure (marker write, rename) leaves the marker in place,
+// so the rotation resumes on the next launch
+const runRotationInBackground = (marker: RotationMarker): void => {
+  runRotation(marker).catch((error) => {
+    log.error('Rotation stopped, will resume on next launch', () => errorFields(error))
+  })
+}
+
+/**
+ * Start re-encrypting all stores under the current master key
+ * Call after a new key has been imported
+ */
+export const startKeyRotation = async (): Promise<void> => {
+  const key = await getMasterKey()
+  const marker: RotationMarker = {
+    targetKeyId: getKeyId(key),
+    completed: [],
+    startedAt: Date.now()
+  }
+  writeMarker(marker)
+  log.info('Starting background key rotation')
+  runRotationInBackground(marker)
+}
+
+/**
+ * Resume an interrupted rotation (call on startup after encryption is initialized)
+ */
+export const resumeKeyRotation = async (): Promise<void> => {
+  const marker = readMarker()
+  const previousKey = await getPreviousKey()
+
+  if (!marker && !previousKey) {
+    return
+  }
+
+  const key = await getMasterKey()
+  if (!marker || marker.targetKeyId !== getKeyId(key)) {
+    // Key changed again or marker was lost - rotate everything towards the current key
+    await startKeyRotation()
+    return
+  }
+
+  log.info(() => `Resuming rotation, ${marker.completed.length} store(s) already done`)
+  runRotationInBackground(marker)
+}
@@ -0,0 +1,204 @@
+import fs from 'fs'
+import os from 'os'
+import path from 'path'
+import { resamplePcm, spotKeywords } from './native'
+import { configureLogger } from './logger'
+import { CAPTURE_SAMPLE_RATE } from './capture'
+
+// False-accept / false-reject benchmark for the wake phrase model (wake-word.ts)
+// Runs the native streaming detector - the same code the capture thread runs - over
+// labelled recordings at several thresholds:
+//   positives: one clip per utterance of the wake phrase; a clip without a detection
+//              is a false reject
+//   negatives: long recordings without it (speech, TV, typing, silence); every
+//              detection is a false accept, reported per hour of audio
+// It also reports the detector's cost as a share of one core (processing time over
+// audio time), and the lowest-FRR threshold within the false-accept budget
+//
+// Not shipped (excluded in electron-builder.yml). Build, then run with:
+//   ELECTRON_RUN_AS_NODE=1 electron out/main/kws-bench.js --model <file.kws>
+//     --positives <dir|wav...> --negatives <dir|wav...> [options]
+//
+//   --thresholds 0.5,0.7,0.9   Thresholds to evaluate (default 0.5 to 0.95 in steps of 0.05)
+//   --max-fa-per-hour <n>      False-accept budget for the recommendation (default 0.5)
+//   --label <text>             Stored in the export, e.g. the model version under test
+//   --out <file.json>          Write results as JSON
+
+const RESULT_VERSION = 1
+
+interface Options {
+  model: string
+  positives: string[]
+  negatives: string[]
+  thresholds: number[]
+  maxFaPerHour: number
+  label?: string
+  out?: string
+}
+
+interface Recording {
+  path: string
+  samples: Int16Array
+}
+
+interface ThresholdResult {
+  threshold: number
+  falseRejects: number
+  falseRejectRate: number
+  falseAccepts: number
+  falseAcceptsPerHour: number
+}
+
+const parseOptions = (argv: string[]): Options => {
+  const values = new Map<string, string>()
+  const lists: Record<string, string[]> = { positives: [], negatives: [] }
+  for (let i = 0; i < argv.length; i++) {
+    const name = argv[i].slice(2)
+    if (name in lists) {
+      while (argv[i + 1] && !argv[i + 1].startsWith('--')) lists[name].push(argv[++i])
+    } else if (argv[i].startsWith('--')) {
+      values.set(name, argv[i + 1])
+      i++
+    }
+  }
+
+  const defaultThresholds = Array.from({ length: 10 }, (_, i) => Math.round((0.5 + i * 0.05) * 100) / 100)
+  const thresholds = values.get('thresholds')
+  return {
+    model: values.get('model') ?? '',
+    positives: lists.positives,
+    negatives: lists.negatives,
+    thresholds: thresholds
+      ? thresholds.split(',').map(Number).filter((n) => n > 0 && n < 1)
+      : defaultThresholds,
+    maxFaPerHour: Number(values.get('max-fa-per-hour') ?? 0.5),
+    label: values.get('label'),
+    out: values.get('out')
+  }
+}
+
+/**
+ * 16-bit PCM WAV as mono at the capture rate
+ */
+const readWav = (file: string): Int16Array => {
+  const data = fs.readFileSync(file)
+  let channels = 0
+  let sampleRate = 0
+  let bits = 0
+  for (let offset = 12; offset + 8 <= data.length; ) {
+    const id = data.toString('ascii', offset, offset + 4)
+    const size = data.readUInt32LE(offset + 4)
+    if (id === 'fmt ') {
+      channels = data.readUInt16LE(offset + 10)
+      sampleRate = data.readUInt32LE(offset + 12)
+      bits = data.readUInt16LE(offset + 22)
+    } else if (id === 'data' && bits === 16) {
+      const frames = Math.floor(Math.min(size, data.length - offset - 8) / (2 * channels))
+      const mono = new Int16Array(frames)
+      for (let i = 0; i < frames; i++) {
+        let sum = 0
+        for (let c = 0; c < channels; c++) sum += data.readInt16LE(offset + 8 + (i * channels + c) * 2)
+        mono[i] = Math.round(sum / channels)
+      }
+      return resamplePcm(mono, sampleRate, CAPTURE_SAMPLE_RATE)
+    }
+    offset += 8 + size + (size % 2)
+  }
+  throw new Error(`${file} is not a 16-bit PCM WAV file`)
+}
+
+const loadRecordings = (entries: string[]): Recording[] =>
+  entries
+    .flatMap((entry) =>
+      fs.statSync(entry).isDirectory()
+        ? fs
+            .readdirSync(entry)
+            .filter((name) => name.endsWith('.wav'))
+            .map((name) => path.join(entry, name))
+        : [entry]
+    )
+    .map((file) => ({ path: path.resolve(file), samples: readWav(file) }))
+
+const audioSeconds = (recordings: Recording[]): number =>
+  recordings.reduce((total, recording) => total + recording.samples.length, 0) / CAPTURE_SAMPLE_RATE
+
+const main = (): void => {
+  const options = parseOptions(process.argv.slice(2))
+  if (!options.model || options.positives.length === 0 || options.negatives.length === 0) {
+    console.error(
+      'Usage: kws-bench.js --model <file.kws> --positives <dir|wav...> --negatives <dir|wav...> [--thresholds 0.5,0.7] ...'
+    )
+    process.exit(2)
+  }
+  configureLogger({ level: 'warn', consoleEcho: true })
+
+  const positives = loadRecordings(options.positives)
+  const negatives = loadRecordings(options.negatives)
+  const negativeHours = audioSeconds(negatives) / 3600
+  console.log(
+    `${path.basename(options.model)}: ${positives.length} positive clips, ` +
+      `${(negativeHours * 60).toFixed(1)} min of negative audio`
+  )
+
+  let processingMs = 0
+  const results: ThresholdResult[] = []
+  for (const threshold of options.thresholds) {
+    const started = performance.now()
+    const falseRejects = positives.filter(
+      (clip) => spotKeywords(options.model, clip.samples, CAPTURE_SAMPLE_RATE, threshold).length === 0
+    ).length
+    const falseAccepts = negatives.reduce(
+      (total, recording) =>
+        total + spotKeywords(options.model, recording.samples, CAPTURE_SAMPLE_RATE, threshold).length,
+      0
+    )
+    processingMs += performance.now() - started
+
+    const result: ThresholdResult = {
+      threshold,
+      falseRejects,
+      falseRejectRate: Math.round((falseRejects / positives.length) * 10000) / 10000,
+      falseAccepts,
+      falseAcceptsPerHour: Math.round((falseAccepts / negativeHours) * 100) / 100
+    }
+    results.push(result)
+    console.log(
+      `threshold ${threshold.toFixed(2)}  FRR ${(result.falseRejectRate * 100).toFixed(2).padStart(6)}%` +
+        `  FA ${String(falseAccepts).padStart(4)} (${result.falseAcceptsPerHour.toFixed(2)}/h)`
+    )
+  }
+
+  // Every threshold processed all of the audio once
+  const processedSeconds = (audioSeconds(positives) + audioSeconds(negatives)) * options.thresholds.length
+  const coreShare = Math.round((processingMs / 1000 / processedSeconds) * 100000) / 1000
+  console.log(`Detector cost: ${coreShare}% of one core`)
+
+  const withinBudget = results.filter((result) => result.falseAcceptsPerHour <= options.maxFaPerHour)
+  const recommended = withinBudget.length
+    ? withinBudget.reduce((best, result) => (result.falseRejectRate <= best.falseRejectRate ? result : best))
+    : null
+  console.log(
+    recommended
+      ? `Recommended threshold: ${recommended.threshold} (FRR ${(recommended.falseRejectRate * 100).toFixed(2)}%, ${recommended.falseAcceptsPerHour}/h)`
+      : `No threshold meets ${options.maxFaPerHour} false accepts per hour`
+  )
+
+  if (options.out) {
+    const exported = {
+      version: RESULT_VERSION,
+      label: options.label ?? null,
+      startedAt: new Date().toISOString(),
+      host: { platform: process.platform, arch: process.arch, cpus: os.cpus().length },
+      model: path.basename(options.model),
+      positives: { clips: positives.length, audioSeconds: audioSeconds(positives) },
+      negatives: { recordings: negatives.length, audioSeconds: audioSeconds(negatives) },
+      coreSharePercent: coreShare,
+      thresholds: results,
+      recommended: recommended?.threshold ?? null
+    }
+    fs.writeFileSync(options.out, JSON.stringify(exported, null, 2))
+    console.log(`Results written to ${options.out}`)
+  }
+}
+
+main()
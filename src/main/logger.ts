@@ -0,0 +1,271 @@
+import fs from 'fs'
+import path from 'path'
+
+// Structured, leveled logger
+// Calls only append to an in-memory ring buffer; formatting is deferred until an entry
+// is actually kept, and a timer flushes batches to a rotating file (and to the console
+// in development). Transcript text is redacted unless explicitly enabled.
+// No Electron imports - the pipeline utility process forwards its entries to main
+
+export type LogLevel = 'debug' | 'info' | 'warn' | 'error'
+
+export type LogFields = Record<string, unknown>
+
+export interface LogEntry {
+  t: number
+  level: LogLevel
+  scope: string
+  msg: string
+  fields?: LogFields
+}
+
+export interface LoggerOptions {
+  level?: LogLevel
+  directory?: string // Write rotating log files here
+  consoleEcho?: boolean // Mirror flushed batches to stdout/stderr
+  forward?: (entries: LogEntry[]) => void // Hand batches to another process instead
+  logTranscripts?: boolean // Disable transcript redaction (debugging only)
+}
+
+type Lazy<T> = T | (() => T)
+
+const LEVEL_ORDER: Record<LogLevel, number> = { debug: 10, info: 20, warn: 30, error: 40 }
+const RING_CAPACITY = 5000
+const FLUSH_INTERVAL_MS = 1000
+const FLUSH_THRESHOLD = 500 // Flush early when this many entries are waiting
+const LOG_FILE = 'wispr.log'
+const MAX_FILE_BYTES = 5 * 1024 * 1024
+const MAX_ROTATED_FILES = 3
+
+let options: LoggerOptions = { level: 'info', consoleEcho: true }
+let minLevel = LEVEL_ORDER.info
+
+// Ring buffer of recent entries; `written` counts every entry ever appended
+const ring: (LogEntry | undefined)[] = new Array(RING_CAPACITY)
+let written = 0
+let flushed = 0
+let flushTimer: NodeJS.Timeout | null = null
+let flushing: Promise<void> | null = null
+let fileBytes = -1 // Unknown until the first write
+
+export function configureLogger(next: LoggerOptions): void {
+  options = { ...options, ...next }
+  minLevel = LEVEL_ORDER[options.level ?? 'info']
+  if (options.directory) fs.mkdirSync(options.directory, { recursive: true })
+}
+
+/**
+ * Level and redaction settings, for handing on to the pipeline worker
+ */
+export function getLoggerOptions(): Pick<LoggerOptions, 'level' | 'logTranscripts'> {
+  return { level: options.level, logTranscripts: options.logTranscripts }
+}
+
+const resolve = <T>(value: Lazy<T>): T =>
+  typeof value === 'function' ? (value as () => T)() : value
+
+/**
+ * Replace transcript text with its length unless transcript logging is enabled
+ */
+export function redactTranscript(text: string | null | undefined): string {
+  if (!text) return ''
+  if (options.logTranscripts) return text
+  return `[redacted ${text.length} chars]`
+}
+
+const scheduleFlush = (): void => {
+  if (written - flushed >= FLUSH_THRESHOLD) {
+    setImmediate(flushLogs)
+    return
+  }
+  if (!flushTimer) {
+    flushTimer = setTimeout(flushLogs, FLUSH_INTERVAL_MS)
+    flushTimer.unref()
+  }
+}
+
+/**
+ * Append already-built entries (also used for entries forwarded from the pipeline)
+ */
+export function writeLogEntries(entries: LogEntry[]): void {
+  for (const entry of entries) {
+    ring[written % RING_CAPACITY] = entry
+    written++
+  }
+  scheduleFlush()
+}
+
+const formatLine = (entry: LogEntry): string => {
+  return JSON.stringify({
+    t: new Date(entry.t).toISOString(),
+    level: entry.level,
+    scope: entry.scope,
+    msg: entry.msg,
+    ...entry.fields
+  })
+}
+
+const formatConsole = (entry: LogEntry): string => {
+  const fields = entry.fields ? ' ' + JSON.stringify(entry.fields) : ''
+  return `[${entry.scope}] ${entry.msg}${fields}`
+}
+
+const rotateIfNeeded = async (filePath: string, incoming: number): Promise<void> => {
+  if (fileBytes < 0) {
+    fileBytes = await fs.promises.stat(filePath).then((s) => s.size).catch(() => 0)
+  }
+  if (fileBytes + incoming <= MAX_FILE_BYTES) return
+
+  // wispr.log -> wispr.1.log -> ... -> wispr.<MAX>.log (oldest dropped)
+  const base = filePath.replace(/\.log$/, '')
+  for (let i = MAX_ROTATED_FILES - 1; i >= 1; i--) {
+    await fs.promises.rename(`${base}.${i}.log`, `${base}.${i + 1}.log`).catch(() => undefined)
+  }
+  await fs.promises.rename(filePath, `${base}.1.log`).catch(() => undefined)
+  fileBytes = 0
+}
+
+const takePending = (): { entries: LogEntry[]; dropped: number } => {
+  const oldestKept = Math.max(flushed, written - RING_CAPACITY)
+  const dropped = oldestKept - flushed
+  const entries: LogEntry[] = []
+  for (let i = oldestKept; i < written; i++) {
+    entries.push(ring[i % RING_CAPACITY]!)
+  }
+  flushed = written
+  return { entries, dropped }
+}
+
+/**
+ * Write everything buffered so far (runs on a timer; call directly before exit)
+ */
+export function flushLogs(): Promise<void> {
+  if (flushTimer) {
+    clearTimeout(flushTimer)
+    flushTimer = null
+  }
+  if (flushing) return flushing.then(() => (written > flushed ? flushLogs() : undefined))
+  if (written === flushed) return Promise.resolve()
+
+  const { entries, dropped } = takePending()
+  if (dropped > 0) {
+    entries.unshift({ t: Date.now(), level: 'warn', scope: 'Logger', msg: `Dropped ${dropped} entries before flush` })
+  }
+
+  flushing = (async () => {
+    if (options.forward) {
+      options.forward(entries)
+      return
+    }
+
+    if (options.consoleEcho) {
+      const out = entries.filter((e) => LEVEL_ORDER[e.level] < LEVEL_ORDER.warn)
+      const err = entries.filter((e) => LEVEL_ORDER[e.level] >= LEVEL_ORDER.warn)
+      if (out.length) process.stdout.write(out.map(formatConsole).join('\n') + '\n')
+      if (err.length) process.stderr.write(err.map(formatConsole).join('\n') + '\n')
+    }
+
+    if (options.directory) {
+      const filePath = path.join(options.directory, LOG_FILE)
+      const data = entries.map(formatLine).join('\n') + '\n'
+      const bytes = Buffer.byteLength(data)
+      await rotateIfNeeded(filePath, bytes)
+      await fs.promises.appendFile(filePath, data)
+      fileBytes += bytes
+    }
+  })()
+    .catch(() => undefined) // Never let logging take the app down
+    .finally(() => {
+      flushing = null
+    })
+
+  return flushing
+}
+
+/**
+ * Recent entries still held in memory (newest last)
+ */
+export function getRecentLogs(limit = 200): LogEntry[] {
+  const start = Math.max(0, written - Math.min(limit, RING_CAPACITY))
+  const entries: LogEntry[] = []
+  for (let i = start; i < written; i++) entries.push(ring[i % RING_CAPACITY]!)
+  return entries
+}
+
+export class Logger {
+  // Per-key sampling state: last emitted time and entries suppressed since
+  private samples: Map<string, { at: number; suppressed: number }> | null = null
+  private scope: string
+  private sampleKey: string | null
+  private sampleIntervalMs: number
+  private parent: Logger | null
+
+  constructor(scope: string, sampleKey: string | null = null, sampleIntervalMs = 0, parent: Logger | null = null) {
+    this.scope = scope
+    this.sampleKey = sampleKey
+    this.sampleIntervalMs = sampleIntervalMs
+    this.parent = parent
+  }
+
+  /**
+   * Logger that keeps at most one entry per interval for `key` (the next kept
+   * entry reports how many were suppressed)
+   */
+  sampled(key: string, intervalMs: number): Logger {
+    return new Logger(this.scope, key, intervalMs, this)
+  }
+
+  debug(message: Lazy<string>, fields?: Lazy<LogFields>): void {
+    this.log('debug', message, fields)
+  }
+
+  info(message: Lazy<string>, fields?: Lazy<LogFields>): void {
+    this.log('info', message, fields)
+  }
+
+  warn(message: Lazy<string>, fields?: Lazy<LogFields>): void {
+    this.log('warn', message, fields)
+  }
+
+  error(message: Lazy<string>, fields?: Lazy<LogFields>): void {
+    this.log('error', message, fields)
+  }
+
+  private log(level: LogLevel, message: Lazy<string>, fields?: Lazy<LogFields>): void {
+    if (LEVEL_ORDER[level] < minLevel) return
+
+    let suppressed = 0
+    if (this.sampleKey) {
+      const owner = this.parent ?? this
+      owner.samples ??= new Map()
+      const now = Date.now()
+      const state = owner.samples.get(this.sampleKey)
+      if (state && now - state.at < this.sampleIntervalMs) {
+        state.suppressed++
+        return
+      }
+      suppressed = state?.suppressed ?? 0
+      owner.samples.set(this.sampleKey, { at: now, suppressed: 0 })
+    }
+
+    let resolvedFields = fields === undefined ? undefined : resolve(fields)
+    if (suppressed > 0) resolvedFields = { ...resolvedFields, suppressed }
+
+    writeLogEntries([{ t: Date.now(), level, scope: this.scope, msg: resolve(message), fields: resolvedFields }])
+  }
+}
+
+/**
+ * Logger for one module, e.g. createLogger('WhisperDaemon')
+ */
+export function createLogger(scope: string): Logger {
+  return new Logger(scope)
+}
+
+/**
+ * Errors don't survive JSON.stringify - keep the useful parts
+ */
+export function errorFields(error: unknown): LogFields {
+  if (error instanceof Error) return { error: error.message, stack: error.stack }
+  return { error: String(error) }
+}
@@ -0,0 +1,292 @@
+import { createRequire } from 'module'
+import path from 'path'
+import fs from 'fs'
+import { createLogger, errorFields } from './logger'
+
+// Facade over the optional native module (native/cloudkit)
+// Every caller goes through here and falls back to the existing child-process path
+// when the module or one of its features is unavailable (capture and injection are
+// Linux-only; decoding and resampling build anywhere libopus does). Usable from the main
+// process and the pipeline utility process (no Electron imports)
+
+export type CaptureBackend = 'pulse' | 'alsa'
+
+export interface NativeCapabilities {
+  loaded: boolean
+  capture: CaptureBackend[] // Empty when capture isn't compiled in
+  opus: boolean
+  keyword: boolean // Keyword spotting during capture (see wake-word.ts)
+  resample: boolean
+  inject: boolean // X11 display with XTest available
+  shm: boolean // POSIX shared memory for handing PCM to the daemon (see pcm-slab.ts)
+}
+
+export interface NativeCaptureOptions {
+  backend?: CaptureBackend
+  device?: string
+  sampleRate?: number
+  frameMs?: number
+  keywordModel?: string // Start listening for the keyword instead of delivering audio
+  keywordThreshold?: number
+}
+
+// Per-chunk metadata from the capture thread (see capture.ts health accounting)
+export interface CaptureChunkInfo {
+  sequence: number // Consecutive unless chunks were dropped
+  elapsedMs: number // Read completion time since capture start
+  overruns: number // Device buffer overruns so far (ALSA xruns; always 0 on Pulse)
+}
+
+export type CaptureDataCallback = (samples: Int16Array, info: CaptureChunkInfo) => void
+
+interface CloudkitBinding {
+  capabilities(): Omit<NativeCapabilities, 'loaded'>
+  startCapture(
+    options: NativeCaptureOptions,
+    onData: (samples: Int16Array, sequence: number, elapsedMs: number, overruns: number) => void,
+    onError?: (message: string) => void,
+    onKeyword?: (score: number) => void
+  ): CaptureBackend
+  stopCapture(): void
+  resumeCapture(prerollMs: number): void
+  pauseCapture(): void
+  spotKeywords(
+    modelPath: string,
+    samples: Int16Array,
+    sampleRate: number,
+    threshold: number
+  ): number[]
+  decodeWebmOpus(data: Uint8Array, sampleRate: number): Promise<Int16Array>
+  resample(samples: Int16Array, fromRate: number, toRate: number): Int16Array
+  sendPasteShortcut(): void
+  shmCreate(name: string, bytes: number): SharedMemoryHandle
+  shmWrite(handle: SharedMemoryHandle, byteOffset: number, samples: Int16Array): void
+  shmClose(handle: SharedMemoryHandle): void
+  shmUnlink(name: string): boolean
+}
+
+// Opaque handle to a mapped region (an N-API external)
+export type SharedMemoryHandle = { readonly __sharedMemory: unique symbol }
+
+export interface NativeConfig {
+  isPackaged: boolean
+  resourcesPath: string
+}
+
+const UNAVAILABLE: NativeCapabilities = {
+  loaded: false,
+  capture: [],
+  opus: false,
+  keyword: false,
+  resample: false,
+  inject: false,
+  shm: false
+}
+
+let config: NativeConfig = {
+  isPackaged: false,
+  resourcesPath: process.resourcesPath
+}
+const log = createLogger('Native')
+
+let binding: CloudkitBinding | null | undefined // undefined = not tried yet
+let capabilities: NativeCapabilities | null = null
+
+export function configureNative(options: NativeConfig): void {
+  config = options
+}
+
+/**
+ * Path of the built module
+ * In development: native/cloudkit/build/Release (npm run build:native)
+ * In production: unpacked next to app.asar (see asarUnpack in electron-builder.yml)
+ */
+function getModulePath(): string {
+  const relative = path.join('native', 'cloudkit', 'build', 'Release', 'cloudkit.node')
+  if (config.isPackaged) {
+    return path.join(config.resourcesPath, 'app.asar.unpacked', relative)
+  }
+  return path.join(process.cwd(), relative)
+}
+
+function loadBinding(): CloudkitBinding | null {
+  if (binding !== undefined) return binding
+
+  binding = null
+  const modulePath = getModulePath()
+  if (!fs.existsSync(modulePath)) {
+    log.info(() => `Module not built, using fallbacks: ${modulePath}`)
+    return binding
+  }
+  try {
+    binding = createRequire(__filename)(modulePath) as CloudkitBinding
+  } catch (error) {
+    log.error('Failed to load module, using fallbacks', () => errorFields(error))
+  }
+  return binding
+}
+
+/**
+ * What the native module can do on this machine (cached after the first call)
+ */
+export function getNativeCapabilities(): NativeCapabilities {
+  if (capabilities) return capabilities
+
+  const native = loadBinding()
+  if (!native) {
+    capabilities = UNAVAILABLE
+  } else {
+    try {
+      capabilities = { loaded: true, ...native.capabilities() }
+    } catch (error) {
+      log.error('Capability probe failed', () => errorFields(error))
+      capabilities = UNAVAILABLE
+    }
+  }
+  log.info('Capabilities', () => ({ ...capabilities }))
+  return capabilities
+}
+
+/**
+ * Start mono 16-bit capture; returns the backend in use. Throws when no backend opens
+ * With options.keywordModel the device opens listening: no audio reaches onData until
+ * resumeNativeCapture, and onKeyword reports each detection
+ */
+export function startNativeCapture(
+  options: NativeCaptureOptions,
+  onData: CaptureDataCallback,
+  onError?: (message: string) => void,
+  onKeyword?: (score: number) => void
+): CaptureBackend {
+  const native = loadBinding()
+  if (!native || getNativeCapabilities().capture.length === 0) {
+    throw new Error('Native capture is not available')
+  }
+  return native.startCapture(
+    options,
+    (samples, sequence, elapsedMs, overruns) => onData(samples, { sequence, elapsedMs, overruns }),
+    onError,
+    onKeyword
+  )
+}
+
+export function stopNativeCapture(): void {
+  loadBinding()?.stopCapture()
+}
+
+/**
+ * Switch a listening session to delivery, starting prerollMs before the last detection
+ */
+export function resumeNativeCapture(prerollMs: number): void {
+  loadBinding()!.resumeCapture(prerollMs)
+}
+
+/**
+ * Switch a delivering session back to listening without closing the device
+ */
+export function pauseNativeCapture(): void {
+  loadBinding()!.pauseCapture()
+}
+
+/**
+ * Run the keyword detector over a recording; detection times in ms (benchmarks)
+ */
+export function spotKeywords(
+  modelPath: string,
+  samples: Int16Array,
+  sampleRate: number,
+  threshold: number
+): number[] {
+  const native = loadBinding()
+  if (!native || !getNativeCapabilities().keyword) {
+    throw new Error('Native keyword spotting is not available')
+  }
+  return native.spotKeywords(modelPath, samples, sampleRate, threshold)
+}
+
+/**
+ * Decode a MediaRecorder WebM/Opus recording to mono PCM, or null when unsupported
+ */
+export async function decodeWebmOpus(data: Uint8Array, sampleRate: number): Promise<Int16Array | null> {
+  if (!getNativeCapabilities().opus) return null
+  try {
+    return await loadBinding()!.decodeWebmOpus(data, sampleRate)
+  } catch (error) {
+    log.warn('Opus decode failed, using fallback', () => errorFields(error))
+    return null
+  }
+}
+
+export function resamplePcm(samples: Int16Array, fromRate: number, toRate: number): Int16Array {
+  if (fromRate === toRate) return samples
+  const native = loadBinding()
+  if (!native) throw new Error('Native resampler is not available')
+  return native.resample(samples, fromRate, toRate)
+}
+
+/**
+ * Press the paste shortcut in the focused window; false when injection is unavailable
+ */
+export function sendNativePaste(): boolean {
+  if (!getNativeCapabilities().inject) return false
+  try {
+    loadBinding()!.sendPasteShortcut()
+    return true
+  } catch (error) {
+    log.error('Paste injection failed', () => errorFields(error))
+    return false
+  }
+}
+
+/**
+ * Create a named shared-memory region owned by this process, or null when unsupported
+ */
+export function createSharedMemory(name: string, bytes: number): SharedMemoryHandle | null {
+  if (!getNativeCapabilities().shm) return null
+  try {
+    return loadBinding()!.shmCreate(name, bytes)
+  } catch (error) {
+    log.warn('Shared memory unavailable', () => errorFields(error))
+    return null
+  }
+}
+
+export function writeSharedMemory(handle: SharedMemoryHandle, byteOffset: number, samples: Int16Array): void {
+  loadBinding()!.shmWrite(handle, byteOffset, samples)
+}
+
+/**
+ * Unmap and unlink a region created by createSharedMemory
+ */
+export function closeSharedMemory(handle: SharedMemoryHandle): void {
+  loadBinding()?.shmClose(handle)
+}
+
+/**
+ * Remove a region by name (leftovers of a process that crashed)
+ */
+export function unlinkSharedMemory(name: string): boolean {
+  return loadBinding()?.shmUnlink(name) ?? false
+}
+
+/**
+ * Wrap mono 16-bit PCM in a WAV header (for tools that need a file)
+ */
+export function encodeWav(samples: Int16Array, sampleRate: number): Buffer {
+  const dataBytes = samples.byteLength
+  const header = Buffer.alloc(44)
+  header.write('RIFF', 0)
+  header.writeUInt32LE(36 + dataBytes, 4)
+  header.write('WAVE', 8)
+  header.write('fmt ', 12)
+  header.writeUInt32LE(16, 16) // PCM chunk size
+  header.writeUInt16LE(1, 20) // PCM format
+  header.writeUInt16LE(1, 22) // Mono
+  header.writeUInt32LE(sampleRate, 24)
+  header.writeUInt32LE(sampleRate * 2, 28) // Byte rate
+  header.writeUInt16LE(2, 32) // Block align
+  header.writeUInt16LE(16, 34) // Bits per sample
+  header.write('data', 36)
+  header.writeUInt32LE(dataBytes, 40)
+  return Buffer.concat([header, Buffer.from(samples.buffer, samples.byteOffset, dataBytes)])
+}
@@ -1,8 +1,10 @@
 import { app } from 'electron'
 import { join } from 'path'
 import { readFileSync, writeFileSync, existsSync, copyFileSync } from 'fs'
+import { EventEmitter } from 'events'
 import { v4 as uuidv4 } from 'uuid'
 import { encryptData, decryptData, detectStorageVersion } from './encryption'
+import { createLogger, errorFields } from './logger'
 
 export interface NoteItem {
   id: string
@@ -10,15 +12,42 @@ export interface NoteItem {
   timestamp: number
 }
 
+// Change events pushed to subscribed windows (see subscriptions.ts)
+export type NotesChange =
+  | { op: 'add'; item: NoteItem }
+  | { op: 'update'; item: NoteItem }
+  | { op: 'delete'; id: string }
+
 const NOTES_FILE = 'notes.json'
 
+const log = createLogger('Notes')
+
+// Emits 'change' with a NotesChange after every successful mutation
+export const notesEvents = new EventEmitter()
+
+// Decrypted notes kept in memory so reads don't re-decrypt the file
+let notesCache: NoteItem[] | null = null
+
+// Serializes read-modify-write cycles so concurrent edits don't drop notes
+let mutationQueue: Promise<unknown> = Promise.resolve()
+const enqueueMutation = <T>(mutation: () => Promise<T>): Promise<T> => {
+  const run = mutationQueue.then(mutation)
+  mutationQueue = run.catch(() => undefined)
+  return run
+}
+
 const getNotesPath = (): string => {
   return join(app.getPath('userData'), NOTES_FILE)
 }
 
 export const loadNotes = async (): Promise<NoteItem[]> => {
+  if (notesCache) {
+    return [...notesCache]
+  }
+
   const path = getNotesPath()
   if (!existsSync(path)) {
+    notesCache = []
     return []
   }
   try {
@@ -30,30 +59,33 @@ export const loadNotes = async (): Promise<NoteItem[]> => {
 
     if (version === 1) {
       // Old plaintext format - return as-is, will encrypt on next save
-      console.log('[Notes] Detected plaintext format, will migrate on next save')
-      return Array.isArray(parsed) ? parsed : []
+      log.info('Detected plaintext format, will migrate on next save')
+      notesCache = Array.isArray(parsed) ? parsed : []
+      return [...notesCache]
     } else {
       // Version 2 - encrypted format
       try {
         const decrypted = await decryptData(parsed.data)
-        return decrypted
+        notesCache = decrypted
+        return [...decrypted]
       } catch (error) {
-        console.error('[Notes] Decryption failed:', error)
+        log.error('Decryption failed', () => errorFields(error))
 
         // Create backup of corrupted file
         const backupPath = path + '.corrupted.' + Date.now()
         copyFileSync(path, backupPath)
-        console.error('[Notes] Corrupted file backed up to:', backupPath)
+        log.error('Corrupted file backed up', { backupPath })
 
         return []
       }
     }
   } catch (error) {
-    console.error('[Notes] Failed to load notes:', error)
+    log.error('Failed to load notes', () => errorFields(error))
     return []
   }
 }
 
+// Throws when the write fails, so callers only publish changes that persisted
 export const saveNotes = async (notes: NoteItem[]): Promise<void> => {
   const path = getNotesPath()
   try {
@@ -62,42 +94,59 @@ export const saveNotes = async (notes: NoteItem[]): Promise<void> => {
     const wrapper = { version: 2 as const, data: encrypted }
 
     // Write encrypted data
-    writeFileSync(path, JSON.stringify(wrapper, null, 2), 'utf-8')
-    console.log('[Notes] Saved encrypted notes')
+    writeFileSync(path, JSON.stringify(wrapper), 'utf-8')
+    notesCache = [...notes]
+    log.debug('Saved encrypted notes')
   } catch (error) {
-    console.error('[Notes] Failed to save notes:', error)
+    log.error('Failed to save notes', () => errorFields(error))
+    throw error
   }
 }
 
-export const addNote = async (content: string): Promise<NoteItem> => {
-  const notes = await loadNotes()
+export const addNote = (content: string): Promise<NoteItem> =>
+  enqueueMutation(async () => {
+    const notes = await loadNotes()
 
-  const newItem: NoteItem = {
-    id: uuidv4(),
-    content,
-    timestamp: Date.now()
-  }
+    const newItem: NoteItem = {
+      id: uuidv4(),
+      content,
+      timestamp: Date.now()
+    }
 
-  // Add to beginning
-  notes.unshift(newItem)
+    // Add to beginning
+    notes.unshift(newItem)
 
-  await saveNotes(notes)
+    await saveNotes(notes)
 
-  return newItem
-}
+    const change: NotesChange = { op: 'add', item: newItem }
+    notesEvents.emit('change', change)
 
-export const deleteNote = async (id: string): Promise<void> => {
-  let notes = await loadNotes()
-  notes = notes.filter((item: NoteItem) => item.id !== id)
-  await saveNotes(notes)
-}
+    return newItem
+  })
 
-export const updateNote = async (id: string, content: string): Promise<void> => {
-  const notes = await loadNotes()
-  const index = notes.findIndex((item: NoteItem) => item.id !== id)
-  if (index !== -1) {
-    notes[index].content = content
-    notes[index].timestamp = Date.now()
-    await saveNotes(notes)
-  }
-}
+export const deleteNote = (id: string): Promise<void> =>
+  enqueueMutation(async () => {
+    const notes = await loadNotes()
+    const remaining = notes.filter((item: NoteItem) => item.id !== id)
+    if (remaining.length === notes.length) return
+
+    await saveNotes(remaining)
+
+    const change: NotesChange = { op: 'delete', id }
+    notesEvents.emit('change', change)
+  })
+
+export const updateNote = (id: string, content: string): Promise<void> =>
+  enqueueMutation(async () => {
+    const notes = await loadNotes()
+    const index = notes.findIndex((item: NoteItem) => item.id === id)
+    if (index !== -1) {
+      // Replace rather than mutate - the array is a copy but the items are shared with the cache
+      const updated: NoteItem = { ...notes[index], content, timestamp: Date.now() }
+      notes[index] = updated
+      await saveNotes(notes)
+
+      const change: NotesChange = { op: 'update', item: updated }
+      notesEvents.emit('change', change)
+    }
+  })
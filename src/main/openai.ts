@@ -1,29 +1,33 @@
-import OpenAI from 'openai'
-import { addHistoryEntry } from './history'
+import type OpenAI from 'openai'
 import fs from 'fs'
 import path from 'path'
 import os from 'os'
 import crypto from 'crypto'
-import { exec } from 'child_process'
-import { clipboard } from 'electron'
 import dotenv from 'dotenv'
-import { transcribeLocal } from './whisper-local'
+import { transcribeLocal, transcribeLocalPcm } from './whisper-local'
+import type { LocalTranscriptionOptions } from './whisper-local'
+import { decodeWebmOpus, encodeWav, resamplePcm } from './native'
+import type { DictionaryMatcher } from './dictionary-matcher'
+import { routeFormatting, recordFormattingLatency, DEFAULT_FORMATTING_MODELS } from './format-router'
+import type { FormattingTier } from './format-router'
+import { UsageMeter } from './usage'
+import { countWords } from './text-segmentation'
+import type { UsageRecord } from './usage'
+import { createLogger, errorFields, redactTranscript } from './logger'
+import { StreamingDiarizer, labelTranscript } from './diarization'
+import { runStages, getPluginStages } from './postprocess'
+import type { SpeakerTurn, TimedText } from './diarization'
+
+const log = createLogger('Transcription')
 
 // Explicitly load .env from project root
 const envPath = path.join(process.cwd(), '.env')
 dotenv.config({ path: envPath })
 
-console.log('Loading .env from:', envPath)
-console.log('API Key present:', !!process.env.OPENAI_API_KEY)
+log.debug(() => `Loaded .env from ${envPath}`, () => ({ groqKeyPresent: !!process.env.GROQ_API_KEY }))
 
 let openai: OpenAI | null = null
 
-export interface DictionaryEntry {
-    id: string
-    term: string
-    replacement: string
-}
-
 export interface Settings {
     hotkey: string
     triggerMode: 'toggle' | 'hold'
@@ -32,9 +36,28 @@ export interface Settings {
     style: string
     language: string
     customInstructions: string
-    dictionaryEntries?: DictionaryEntry[]
     transcriptionMode?: 'cloud' | 'local'
     localModel?: string
+    captureBackend?: 'renderer' | 'native' // 'native' records in main (Linux, see capture.ts)
+    localEngine?: 'shared' | 'embedded' // 'shared' (default) uses the per-user engine service
+    latencyTargetMs?: number // End-to-end target for slo-controller.ts; 0 never degrades
+    formattingRouting?: 'auto' | 'large' // 'auto' (default) sends short plain texts to the fast tier
+    formattingModels?: Partial<Record<FormattingTier, string>> // Overrides per tier (format-router.ts)
+    wakeWord?: boolean // Hands-free activation by a spoken phrase (wake-word.ts)
+    wakeWordThreshold?: number // Keyword posterior that fires; higher means fewer false accepts
+}
+
+export interface ProcessAudioResult {
+    text: string // empty when nothing usable was transcribed
+    durationMs: number
+    stageMs?: { transcribe: number; format: number } // For the latency controller (slo-controller.ts)
+    usage?: UsageRecord // Stored with the history entry (usage.ts)
+}
+
+// Per-dictation adjustments from the latency controller
+export interface ProcessAudioOptions {
+    skipFormattingUnderWords?: number | null
+    diarize?: boolean // Long-form notes: transcribe and label each speaker's turns (diarization.ts)
 }
 
 /**
@@ -46,24 +69,26 @@ function secureDelete(filePath: string): void {
         const randomData = crypto.randomBytes(stats.size)
         fs.writeFileSync(filePath, randomData)
         fs.unlinkSync(filePath)
-        console.log('[Security] Securely deleted temp file:', filePath)
+        log.debug(() => `Securely deleted temp file: ${filePath}`)
     } catch (error) {
-        console.error('[Security] Failed to securely delete file:', error)
+        log.error('Failed to securely delete file', () => errorFields(error))
         // Fallback to regular delete
         try {
             fs.unlinkSync(filePath)
         } catch (e) {
-            console.error('[Security] Failed to delete file:', e)
+            log.error('Failed to delete file', () => errorFields(e))
         }
     }
 }
 
-function getOpenAI(): OpenAI {
+// The SDK is loaded on first cloud request - local-only sessions never pay for it
+async function getOpenAI(): Promise<OpenAI> {
     if (!openai) {
         if (!process.env.GROQ_API_KEY) {
             throw new Error('GROQ_API_KEY is missing. Please check your .env file.')
         }
-        openai = new OpenAI({
+        const { default: OpenAIClient } = await import('openai')
+        openai = new OpenAIClient({
             apiKey: process.env.GROQ_API_KEY,
             baseURL: 'https://api.groq.com/openai/v1',
             dangerouslyAllowBrowser: false
@@ -72,57 +97,203 @@ function getOpenAI(): OpenAI {
     return openai
 }
 
-export async function processAudio(buffer: ArrayBuffer, settings: Settings): Promise<string> {
+// Mono 16-bit PCM from main-process capture
+export interface PcmAudio {
+    samples: Int16Array
+    sampleRate: number
+}
+
+// Post-processing budget (postprocess.ts); a stage over budget is skipped, not waited for
+// Formatting has none - its duration grows with the dictation, and the request's own
+// timeout still applies
+const HALLUCINATION_FILTER_BUDGET_MS = 50
+
+const DIARIZE_CHUNK_SAMPLES = 16000 // Fed to the diarizer a second at a time, as a live stream would be
+
+// Speaker turns of a recording, or null when only one voice was found
+function diarize(pcm: PcmAudio): SpeakerTurn[] | null {
+    let samples: Int16Array
+    try {
+        samples = resamplePcm(pcm.samples, pcm.sampleRate, 16000) // The diarizer runs at 16kHz
+    } catch (error) {
+        log.warn('Cannot resample for diarization, transcribing without speaker labels', () => errorFields(error))
+        return null
+    }
+    const diarizer = new StreamingDiarizer()
+    for (let offset = 0; offset < samples.length; offset += DIARIZE_CHUNK_SAMPLES) {
+        diarizer.push(samples.subarray(offset, offset + DIARIZE_CHUNK_SAMPLES))
+    }
+    const result = diarizer.finish()
+    const audioMs = (samples.length / 16000) * 1000
+    log.info('Diarization', () => ({
+        speakers: result.speakers,
+        turns: result.turns.length,
+        realTimeFactor: audioMs > 0 ? Number((result.processingMs / audioMs).toFixed(4)) : 0
+    }))
+    return result.speakers > 1 ? result.turns : null
+}
+
+// Turn boundaries as sample offsets; leading and trailing silence go to the first and last turn
+function turnSamples(pcm: PcmAudio, turns: SpeakerTurn[], index: number): Int16Array {
+    const turn = turns[index]
+    const start = index === 0 ? 0 : Math.floor((turn.startMs * pcm.sampleRate) / 1000)
+    const end =
+        index === turns.length - 1
+            ? pcm.samples.length
+            : Math.min(pcm.samples.length, Math.ceil((turn.endMs * pcm.sampleRate) / 1000))
+    return pcm.samples.subarray(start, end)
+}
+
+/**
+ * Transcribe and format a recording
+ * Runs inside the pipeline utility process - the history write happens in main
+ */
+export async function processAudio(
+    audio: ArrayBuffer | Uint8Array | PcmAudio,
+    settings: Settings,
+    dictionary?: DictionaryMatcher,
+    options: ProcessAudioOptions = {}
+): Promise<ProcessAudioResult> {
     try {
-        // 1. Write buffer to temp file
-        const tempFilePath = path.join(os.tmpdir(), `wispr_recording_${Date.now()}.webm`)
-        fs.writeFileSync(tempFilePath, Buffer.from(buffer))
+        const transcriptionMode = settings.transcriptionMode || 'cloud'
+        const meter = new UsageMeter(transcriptionMode)
+
+        // Recorded WebM is decoded up front when the native decoder is available: the exact
+        // duration and speech time come from the samples, and local mode hands them straight
+        // to WhisperKit. Cloud mode still uploads the (much smaller) WebM
+        const encoded = 'samples' in audio ? null : audio
+        let pcm = 'samples' in audio ? audio : null
+        if (encoded) {
+            const samples = await meter.measure('decode', () =>
+                decodeWebmOpus(encoded instanceof Uint8Array ? encoded : new Uint8Array(encoded), 16000)
+            )
+            if (samples) pcm = { samples, sampleRate: 16000 }
+        }
+        const durationMs = pcm
+            ? (pcm.samples.length / pcm.sampleRate) * 1000
+            : (encoded!.byteLength / 32000) * 1000 // Rough: without a decoder only the size is known
+        meter.setAudio(durationMs, !!pcm, pcm ?? undefined)
+
+        // Notes with several voices are labeled by speaker turn - the transcript is split
+        // at the turn timestamps, and the labeled text is formatted once
+        let turns: SpeakerTurn[] | null = null
+        if (options.diarize) {
+            if (pcm) turns = diarize(pcm)
+            else log.warn('Speaker labels need the native Opus decoder, transcribing without them')
+        }
+        let segments = null as TimedText[] | null
+
+        // 1. Write audio to a temp file - only when something needs a file (cloud upload,
+        // no decoder, fallback); local PCM goes to WhisperKit through shared memory
+        let tempFilePath: string | null = null
+        const getTempFile = (): string => {
+            if (!tempFilePath) {
+                // PCM is wrapped as WAV, which both Groq and WhisperKit take without ffmpeg
+                tempFilePath = path.join(os.tmpdir(), `wispr_recording_${Date.now()}.${encoded ? 'webm' : 'wav'}`)
+                fs.writeFileSync(
+                    tempFilePath,
+                    encoded ? Buffer.from(encoded) : encodeWav(pcm!.samples, pcm!.sampleRate)
+                )
+            }
+            return tempFilePath
+        }
+
+        const transcribeWithGroq = async (): Promise<string> => {
+            const file = getTempFile()
+            const request = {
+                file: fs.createReadStream(file),
+                model: 'whisper-large-v3-turbo', // Ultra fast model
+                language: settings.language === 'auto' ? undefined : settings.language
+            }
+            if (turns) {
+                // Segment timestamps place the text in the speaker turns
+                const transcription = await (await getOpenAI()).audio.transcriptions.create({
+                    ...request,
+                    response_format: 'verbose_json'
+                })
+                meter.addBytes('transcribe', fs.statSync(file).size, Buffer.byteLength(JSON.stringify(transcription)))
+                segments = (transcription.segments ?? []).map((segment) => ({
+                    startMs: segment.start * 1000,
+                    endMs: segment.end * 1000,
+                    text: segment.text.trim()
+                }))
+                return transcription.text.trim()
+            }
+            const transcription = await (await getOpenAI()).audio.transcriptions.create(request)
+            meter.addBytes('transcribe', fs.statSync(file).size, Buffer.byteLength(JSON.stringify(transcription)))
+            return transcription.text.trim()
+        }
+
+        // WhisperKit returns no timestamps, so with speaker turns each turn is transcribed
+        // on its own (in-process PCM, nothing uploaded) and becomes one segment
+        const transcribeTurnsLocal = async (
+            audio: PcmAudio,
+            speakerTurns: SpeakerTurn[],
+            localOptions: LocalTranscriptionOptions
+        ): Promise<string> => {
+            const parts: TimedText[] = []
+            for (const [index, turn] of speakerTurns.entries()) {
+                const samples = turnSamples(audio, speakerTurns, index)
+                const text = await transcribeLocalPcm(samples, audio.sampleRate, localOptions)
+                parts.push({ startMs: turn.startMs, endMs: turn.endMs, text: text.trim() })
+            }
+            segments = parts
+            return parts.map((part) => part.text).filter(Boolean).join(' ')
+        }
+
+        // Cleanup - secure deletion
+        const finish = async (text: string, transcribeMs: number, formatMs: number): Promise<ProcessAudioResult> => {
+            if (tempFilePath) secureDelete(tempFilePath)
+            const usage = await meter.finish()
+            log.debug('Usage', () => ({ ...usage }))
+            return { text, durationMs, stageMs: { transcribe: transcribeMs, format: formatMs }, usage }
+        }
 
         let rawText: string
 
         // 2. Transcribe based on mode (cloud or local)
-        const transcriptionMode = settings.transcriptionMode || 'cloud'
+        const transcribeStarted = performance.now()
 
         if (transcriptionMode === 'local') {
             // Local transcription with WhisperKit
-            console.log('[Transcription] Using local WhisperKit')
-            console.time('Local Transcription (WhisperKit)')
+            const started = performance.now()
 
             try {
-                rawText = await transcribeLocal(tempFilePath, {
+                const localOptions = {
                     modelName: settings.localModel || 'base',
-                    language: settings.language === 'auto' ? undefined : settings.language
-                })
-                console.timeEnd('Local Transcription (WhisperKit)')
+                    language: settings.language === 'auto' ? undefined : settings.language,
+                    sharedEngine: settings.localEngine !== 'embedded'
+                }
+                rawText = await meter.measure('transcribe', () =>
+                    pcm && turns
+                        ? transcribeTurnsLocal(pcm, turns, localOptions)
+                        : pcm
+                          ? transcribeLocalPcm(pcm.samples, pcm.sampleRate, localOptions)
+                          : transcribeLocal(getTempFile(), localOptions)
+                )
+                log.info('Local transcription (WhisperKit)', () => ({ ms: Math.round(performance.now() - started) }))
             } catch (error) {
-                console.error('[Transcription] ❌ LOCAL TRANSCRIPTION FAILED ❌')
-                console.error('[Transcription] Error details:', error)
-                console.error('[Transcription] Error message:', error instanceof Error ? error.message : String(error))
-                console.error('[Transcription] Falling back to cloud (Groq)...')
+                log.error('Local transcription failed, falling back to cloud (Groq)', () => errorFields(error))
                 // Fallback to cloud if local fails
-                console.time('Groq Transcription (Fallback)')
-                const transcription = await getOpenAI().audio.transcriptions.create({
-                    file: fs.createReadStream(tempFilePath),
-                    model: 'whisper-large-v3-turbo',
-                    language: settings.language === 'auto' ? undefined : settings.language
-                })
-                console.timeEnd('Groq Transcription (Fallback)')
-                rawText = transcription.text.trim()
+                const fallbackStarted = performance.now()
+                rawText = await meter.measure('transcribe', transcribeWithGroq)
+                log.info('Groq transcription (fallback)', () => ({ ms: Math.round(performance.now() - fallbackStarted) }))
             }
         } else {
             // Cloud transcription with Groq
-            console.log('[Transcription] Using cloud API (Groq)')
-            console.time('Groq Transcription')
-            const transcription = await getOpenAI().audio.transcriptions.create({
-                file: fs.createReadStream(tempFilePath),
-                model: 'whisper-large-v3-turbo', // Ultra fast model
-                language: settings.language === 'auto' ? undefined : settings.language
-            })
-            console.timeEnd('Groq Transcription')
-            rawText = transcription.text.trim()
+            const started = performance.now()
+            rawText = await meter.measure('transcribe', transcribeWithGroq)
+            log.info('Groq transcription', () => ({ ms: Math.round(performance.now() - started) }))
         }
 
-        console.log('Raw Transcription:', rawText)
+        // Labels go in before post-processing, so the labeled transcript is formatted once
+        const labeled = !!turns && !!segments && segments.length > 0
+        if (labeled) rawText = labelTranscript(segments!, turns!)
+
+        log.info(() => `Raw transcription: ${redactTranscript(rawText)}`)
+
+        const transcribeMs = performance.now() - transcribeStarted
+        const formatStarted = performance.now()
 
         // Filter Hallucinations
         const HALLUCINATIONS = [
@@ -139,36 +310,38 @@ export async function processAudio(buffer: ArrayBuffer, settings: Settings): Pro
         ]
 
         // If text is short and matches a hallucination, or is empty
-        if (
-            !rawText ||
-            (rawText.length < 30 &&
-                HALLUCINATIONS.some((h) => rawText.toLowerCase().includes(h.toLowerCase())))
-        ) {
-            console.log('Filtered hallucination or empty text:', rawText)
-            return ''
+        const filterHallucinations = (text: string): string => {
+            if (
+                !text ||
+                (text.length < 30 && HALLUCINATIONS.some((h) => text.toLowerCase().includes(h.toLowerCase())))
+            ) {
+                log.info(() => `Filtered hallucination or empty text: ${redactTranscript(text)}`)
+                return ''
+            }
+            return text
         }
 
         // 3. Format with Groq Llama 3 (ONLY for cloud mode)
-        let formattedText = rawText
-
-        // Skip formatting entirely for local AI mode - return raw transcription
-        if (transcriptionMode === 'local') {
-            console.log('[Local AI] Skipping cloud-based formatting - returning raw transcription')
-            console.log('Final Text:', formattedText)
-
-            // Save to History
-            const durationMs = (buffer.byteLength / 32000) * 1000
-            addHistoryEntry(formattedText, durationMs)
-
-            // Cleanup - secure deletion
-            secureDelete(tempFilePath)
+        const formatText = async (text: string, signal: AbortSignal): Promise<string> => {
+            // Skip formatting entirely for local AI mode - return raw transcription
+            if (transcriptionMode === 'local') {
+                log.debug('Local mode: skipping cloud-based formatting')
+                return text
+            }
 
-            return formattedText
-        }
+            // Cloud mode formatting - short texts skip it while the latency target is breached
+            const wordCount = countWords(text)
+            const skipShort = !!options.skipFormattingUnderWords && wordCount < options.skipFormattingUnderWords
+            if (skipShort) {
+                log.info('Skipping formatting to stay within the latency target', () => ({ words: wordCount }))
+                return text
+            }
+            if (settings.style === 'verbatim') {
+                log.debug('Verbatim mode: skipping formatting')
+                return text
+            }
 
-        // Cloud mode formatting
-        if (settings.style !== 'verbatim') {
-            console.time('Groq Formatting')
+            const formattingStarted = performance.now()
 
             // Unified Intelligent Prompt - Handles all formatting automatically
             let systemPrompt = `You are an intelligent dictation editor with context-awareness. Your job is to transform raw speech transcription into polished, well-formatted text by automatically detecting the context and applying appropriate formatting.
@@ -249,84 +422,82 @@ CONTEXT DETECTION GUIDELINES:
 - Respect the speaker's apparent intent (casual vs formal tone)
 - Let the content guide the structure, don't impose unnecessary formatting`
 
-            // Add dictionary entries to prompt
-            if (settings.dictionaryEntries && settings.dictionaryEntries.length > 0) {
+            // Add dictionary entries to prompt - only the terms this transcript contains
+            const dictionaryMatches = dictionary?.match(text) ?? []
+            if (dictionaryMatches.length > 0) {
                 systemPrompt += `\n\nPERSONAL DICTIONARY (Word/Phrase Replacements):\n`
                 systemPrompt += `When you encounter these terms in the transcription, replace them with the specified text:\n`
-                settings.dictionaryEntries.forEach((entry) => {
+                dictionaryMatches.forEach((entry) => {
                     systemPrompt += `- "${entry.term}" → "${entry.replacement}"\n`
                 })
             }
 
+            if (labeled) {
+                systemPrompt += `\n\nSPEAKER LABELS:\nThe transcription is split into speaker turns, one paragraph each, starting with "Speaker N:". Keep every label and paragraph break exactly as given and format only the text after each label.`
+            }
+
             if (settings.customInstructions && settings.customInstructions.trim() !== '') {
                 systemPrompt += `\n\nCustom Instructions:\n${settings.customInstructions}`
             }
 
-            const completion = await getOpenAI().chat.completions.create({
-                messages: [
-                    {
-                        role: 'system',
-                        content: systemPrompt
-                    },
-                    { role: 'user', content: rawText }
-                ],
-                model: 'moonshotai/kimi-k2-instruct-0905' // Testing Moonshot AI Kimi for formatting
+            // Short plain dictations don't need the large model
+            const route = routeFormatting({
+                text,
+                style: settings.style,
+                customInstructions: settings.customInstructions,
+                routing: settings.formattingRouting,
+                models: settings.formattingModels
             })
-            console.timeEnd('Groq Formatting')
-
-            formattedText = completion.choices[0].message.content || rawText
-        } else {
-            console.log('Verbatim mode: Skipping Llama formatting')
-        }
-
-        console.log('Final Text:', formattedText)
+            const complete = async (model: string) => {
+                const body = {
+                    messages: [
+                        {
+                            role: 'system' as const,
+                            content: systemPrompt
+                        },
+                        { role: 'user' as const, content: text }
+                    ],
+                    model
+                }
+                const completion = await (await getOpenAI()).chat.completions.create(body, { signal })
+                meter.addBytes('format', Buffer.byteLength(JSON.stringify(body)), Buffer.byteLength(JSON.stringify(completion)))
+                meter.addTokens(completion.usage?.prompt_tokens, completion.usage?.completion_tokens)
+                return completion
+            }
 
-        // Save to History
-        const durationMs = (buffer.byteLength / 32000) * 1000 // Assuming 32000 bytes/sec for audio
-        addHistoryEntry(formattedText, durationMs)
+            let tier = route.tier
+            const completion = await meter.measure('format', async () => {
+                try {
+                    return await complete(route.model)
+                } catch (error) {
+                    if (route.tier === 'large') throw error
+                    // The fast tier is an optimization - never lose a dictation to it
+                    log.warn('Fast formatting tier failed, using the large model', () => errorFields(error))
+                    tier = 'large'
+                    return complete(settings.formattingModels?.large || DEFAULT_FORMATTING_MODELS.large)
+                }
+            })
+            const formattingMs = performance.now() - formattingStarted
+            recordFormattingLatency(tier, formattingMs)
+            log.info('Groq formatting', () => ({ ms: Math.round(formattingMs), tier, reason: route.reason }))
 
-        // 4. Injection is handled by main process after window hide
+            return completion.choices[0].message.content || text
+        }
 
+        // Built-in stages first, then user plugins; a stage over its budget is skipped
+        const { text: formattedText, reports } = await runStages(rawText, [
+            { name: 'hallucination-filter', budgetMs: HALLUCINATION_FILTER_BUDGET_MS, run: filterHallucinations },
+            { name: 'formatting', run: formatText },
+            ...getPluginStages({ mode: transcriptionMode, language: settings.language, style: settings.style })
+        ])
+        log.debug('Post-processing stages', () => ({ stages: reports }))
 
-        // Cleanup - secure deletion
-        secureDelete(tempFilePath)
+        log.info(() => `Final text: ${redactTranscript(formattedText)}`)
 
-        return formattedText
+        // 4. History write and injection are handled by main process after window hide
+        return finish(formattedText, transcribeMs, performance.now() - formatStarted)
     } catch (error) {
-        console.error('Error processing audio:', error)
+        log.error('Error processing audio', () => errorFields(error))
         throw error
     }
 }
-
-// ... (existing code) ...
-
-export async function injectText(text: string): Promise<void> {
-    return new Promise((resolve, reject) => {
-        try {
-            // 1. Set clipboard instantly using Electron API
-            // Note: Previous clipboard restore functionality was removed
-            clipboard.writeText(text)
-
-            // 2. Trigger Paste (Cmd+V) using minimal AppleScript
-            // We use 'osascript -e' to avoid file I/O
-            // Aggressively reduced delay to 0.01s (10ms) for testing
-            const script = `tell application "System Events"
-                delay 0.01
-                key code 9 using command down
-            end tell`
-
-            exec(`osascript -e '${script}'`, (error) => {
-                if (error) {
-                    console.error('Error injecting text:', error)
-                    reject(error)
-                } else {
-                    // 3. Clipboard restoration is disabled - text remains in clipboard
-                    // for manual paste if needed
-                    resolve()
-                }
-            })
-        } catch (error) {
-            reject(error)
-        }
-    })
-}
@@ -0,0 +1,62 @@
+import { test } from 'node:test'
+import assert from 'node:assert/strict'
+import { SlabRing } from './pcm-slab'
+
+test('allocations are contiguous from the start of the ring', () => {
+  const ring = new SlabRing(100)
+  assert.equal(ring.allocate(30), 0)
+  assert.equal(ring.allocate(30), 30)
+  assert.equal(ring.allocate(40), 60)
+  assert.equal(ring.liveCount, 3)
+})
+
+test('empty and oversized requests are refused', () => {
+  const ring = new SlabRing(100)
+  assert.equal(ring.allocate(0), null)
+  assert.equal(ring.allocate(101), null)
+  assert.equal(ring.liveCount, 0)
+})
+
+test('a full ring refuses until the oldest allocation is released', () => {
+  const ring = new SlabRing(100)
+  ring.allocate(60)
+  ring.allocate(30)
+  assert.equal(ring.allocate(20), null)
+
+  ring.release(0)
+  assert.equal(ring.allocate(20), 0) // Wraps around below the new tail (60)
+})
+
+test('a wrapped head stays strictly below the tail', () => {
+  const ring = new SlabRing(100)
+  ring.allocate(40)
+  ring.allocate(40)
+  ring.release(0)
+  assert.equal(ring.allocate(30), 0) // 80 + 30 doesn't fit, 30 < tail 40 does
+  // Filling up to the tail would make a full ring look empty
+  assert.equal(ring.allocate(10), null)
+  assert.equal(ring.allocate(9), 30)
+})
+
+test('out-of-order releases are reclaimed once everything before them is', () => {
+  const ring = new SlabRing(100)
+  ring.allocate(50)
+  ring.allocate(50)
+  ring.release(50)
+  assert.equal(ring.liveCount, 2) // The first allocation still pins the tail
+  assert.equal(ring.allocate(10), null)
+
+  ring.release(0)
+  assert.equal(ring.liveCount, 0)
+  assert.equal(ring.allocate(100), 0) // An empty ring starts over at 0
+})
+
+test('releasing twice or an unknown offset is a no-op', () => {
+  const ring = new SlabRing(100)
+  ring.allocate(40)
+  ring.allocate(40)
+  ring.release(40)
+  ring.release(40)
+  ring.release(7)
+  assert.equal(ring.liveCount, 2)
+})
@@ -0,0 +1,161 @@
+import fs from 'fs'
+import {
+  createSharedMemory,
+  writeSharedMemory,
+  closeSharedMemory,
+  unlinkSharedMemory
+} from './native'
+import type { SharedMemoryHandle } from './native'
+import { createLogger } from './logger'
+
+// Shared-memory slab for handing PCM to the transcription daemon
+// Each utterance is written once into a POSIX shm region owned by this process, and
+// only a descriptor (region name, offset, length, sample rate) travels over the daemon's
+// stdin or the engine socket. Space is handed out as a ring: leases are released when
+// the daemon is done with them and reclaimed in allocation order
+
+const SLAB_BYTES = 16 * 1024 * 1024 // ~8.7 minutes of 16kHz mono 16-bit audio
+const ALIGNMENT = 64
+const NAME_PREFIX = 'wispr-pcm-'
+
+const log = createLogger('PcmSlab')
+
+export interface PcmDescriptor {
+  shm: string // Region name as passed to shm_open
+  offset: number // Bytes
+  samples: number // 16-bit mono samples
+  sampleRate: number
+}
+
+export interface PcmLease {
+  descriptor: PcmDescriptor
+  release: () => void // Idempotent
+}
+
+interface Allocation {
+  offset: number
+  released: boolean
+}
+
+/**
+ * Ring allocator over a fixed byte range
+ * Allocations are contiguous; the oldest live allocation bounds how far the head may
+ * wrap. Out-of-order releases are reclaimed once everything before them is released
+ */
+export class SlabRing {
+  private live: Allocation[] = []
+  private head = 0
+  private capacity: number
+
+  constructor(capacity: number) {
+    this.capacity = capacity
+  }
+
+  allocate(bytes: number): number | null {
+    if (bytes <= 0 || bytes > this.capacity) return null
+    if (this.live.length === 0) this.head = 0
+
+    const tail = this.live.length > 0 ? this.live[0].offset : 0
+    const wrapped = this.live.length > 0 && this.head <= tail
+    let offset: number | null = null
+    if (!wrapped) {
+      if (this.head + bytes <= this.capacity) {
+        offset = this.head
+      } else if (bytes < tail) {
+        offset = 0 // Wrap around; strictly below the tail so full and empty stay distinct
+      }
+    } else if (this.head + bytes < tail) {
+      offset = this.head
+    }
+    if (offset === null) return null
+
+    this.head = offset + bytes
+    this.live.push({ offset, released: false })
+    return offset
+  }
+
+  release(offset: number): void {
+    const allocation = this.live.find((a) => a.offset === offset && !a.released)
+    if (!allocation) return
+    allocation.released = true
+    while (this.live.length > 0 && this.live[0].released) this.live.shift()
+  }
+
+  get liveCount(): number {
+    return this.live.length
+  }
+}
+
+let handle: SharedMemoryHandle | null = null
+let ring: SlabRing | null = null
+let unavailable = false
+const regionName = `/${NAME_PREFIX}${process.pid}`
+
+// Regions of processes that died without unlinking (Linux lists them in /dev/shm)
+const sweepStaleRegions = (): void => {
+  if (process.platform !== 'linux') return
+  try {
+    for (const entry of fs.readdirSync('/dev/shm')) {
+      if (!entry.startsWith(NAME_PREFIX)) continue
+      const pid = Number(entry.slice(NAME_PREFIX.length))
+      try {
+        process.kill(pid, 0)
+      } catch {
+        unlinkSharedMemory(`/${entry}`)
+        log.info(() => `Removed stale region /${entry}`)
+      }
+    }
+  } catch {
+    // No /dev/shm
+  }
+}
+
+const ensureSlab = (): boolean => {
+  if (handle) return true
+  if (unavailable) return false
+
+  sweepStaleRegions()
+  handle = createSharedMemory(regionName, SLAB_BYTES)
+  if (!handle) {
+    unavailable = true // Native module missing - callers use files
+    return false
+  }
+  ring = new SlabRing(SLAB_BYTES)
+  log.info(() => `Created ${SLAB_BYTES / 1024 / 1024}MB PCM slab ${regionName}`)
+  return true
+}
+
+/**
+ * Copy PCM into the slab, or null when shared memory is unavailable or full
+ * (callers fall back to a WAV file)
+ */
+export function leasePcm(samples: Int16Array, sampleRate: number): PcmLease | null {
+  if (!ensureSlab()) return null
+
+  const bytes = Math.ceil(samples.byteLength / ALIGNMENT) * ALIGNMENT
+  const offset = ring!.allocate(bytes)
+  if (offset === null) {
+    log.warn('PCM slab full, using a file', () => ({ bytes, live: ring!.liveCount }))
+    return null
+  }
+  writeSharedMemory(handle!, offset, samples)
+
+  let released = false
+  return {
+    descriptor: { shm: regionName, offset, samples: samples.length, sampleRate },
+    release: () => {
+      if (released) return
+      released = true
+      ring?.release(offset)
+    }
+  }
+}
+
+/**
+ * Unmap and unlink the slab (process shutdown)
+ */
+export function closePcmSlab(): void {
+  if (handle) closeSharedMemory(handle)
+  handle = null
+  ring = null
+}
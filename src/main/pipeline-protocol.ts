@@ -0,0 +1,48 @@
+import type { Settings, ProcessAudioOptions, ProcessAudioResult } from './openai'
+import type { DictionaryChange } from './dictionary-matcher'
+import type { LogEntry, LoggerOptions } from './logger'
+
+/**
+ * Typed messages exchanged between the main process and the audio pipeline
+ * utility process (see pipeline.ts and pipeline-worker.ts)
+ */
+
+export interface PipelineConfig {
+  isPackaged: boolean
+  resourcesPath: string
+  logDirectory: string // Handed to the shared engine service it may launch
+  pluginDirectory: string // User post-processing plugins (see postprocess.ts)
+}
+
+// Main -> pipeline
+export type PipelineRequest =
+  | { type: 'init'; config: PipelineConfig; logging: Pick<LoggerOptions, 'level' | 'logTranscripts'> }
+  | { type: 'process'; id: number; buffer: ArrayBuffer; settings: Settings; options?: ProcessAudioOptions }
+  // Raw mono 16-bit PCM from main-process capture (see capture.ts)
+  | {
+      type: 'process-pcm'
+      id: number
+      pcm: Int16Array
+      sampleRate: number
+      settings: Settings
+      options?: ProcessAudioOptions
+    }
+  | { type: 'dictionary'; change: DictionaryChange }
+  | { type: 'shutdown' }
+
+// Pipeline -> main
+export type PipelineResponse =
+  | { type: 'ready' }
+  | {
+      type: 'result'
+      id: number
+      text: string
+      durationMs: number
+      stageMs?: ProcessAudioResult['stageMs']
+      usage?: ProcessAudioResult['usage']
+    }
+  | { type: 'error'; id: number; message: string }
+  | { type: 'model-download-progress'; model: string; progress: number }
+  | { type: 'daemon-pid'; pid: number | null }
+  // Batched log entries, written by main's logger (the worker has no log file)
+  | { type: 'log'; entries: LogEntry[] }
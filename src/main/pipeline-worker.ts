@@ -0,0 +1,113 @@
+import { join } from 'path'
+import { processAudio } from './openai'
+import { configureWhisperLocal, stopDaemon } from './whisper-local'
+import { DictionaryMatcher } from './dictionary-matcher'
+import { configureNative } from './native'
+import { configureLogger, flushLogs } from './logger'
+import { configureEngineClient, closeEngineClient } from './engine-client'
+import { closePcmSlab } from './pcm-slab'
+import { setUsageEnginePid } from './usage'
+import { configurePlugins, stopPlugins } from './postprocess'
+import type { PipelineRequest, PipelineResponse } from './pipeline-protocol'
+
+// Entry point of the audio pipeline utility process
+// Transcription, ffmpeg and the WhisperKit daemon live here, off the main process
+
+const port = process.parentPort
+
+// Mirror of the main-process dictionary, kept current by 'dictionary' deltas
+const dictionary = new DictionaryMatcher()
+
+const send = (message: PipelineResponse): void => {
+  port.postMessage(message)
+}
+
+configureLogger({ forward: (entries) => send({ type: 'log', entries }) })
+
+const handleProcess = async (
+  request: Extract<PipelineRequest, { type: 'process' | 'process-pcm' }>
+): Promise<void> => {
+  try {
+    const result = await processAudio(
+      request.type === 'process-pcm'
+        ? { samples: request.pcm, sampleRate: request.sampleRate }
+        : request.buffer,
+      request.settings,
+      dictionary,
+      request.options
+    )
+    send({
+      type: 'result',
+      id: request.id,
+      text: result.text,
+      durationMs: result.durationMs,
+      stageMs: result.stageMs,
+      usage: result.usage
+    })
+  } catch (error) {
+    send({
+      type: 'error',
+      id: request.id,
+      message: error instanceof Error ? error.message : String(error)
+    })
+  }
+}
+
+port.on('message', (event) => {
+  const message = event.data as PipelineRequest
+
+  switch (message.type) {
+    case 'init':
+      configureLogger(message.logging)
+      configureNative(message.config)
+      configureWhisperLocal({
+        ...message.config,
+        onDownloadProgress: (model, progress) => {
+          send({ type: 'model-download-progress', model, progress })
+        },
+        onDaemonPid: (pid) => {
+          setUsageEnginePid(pid)
+          send({ type: 'daemon-pid', pid })
+        }
+      })
+      configureEngineClient({
+        servicePath: join(__dirname, 'engine-service.js'),
+        isPackaged: message.config.isPackaged,
+        resourcesPath: message.config.resourcesPath,
+        logDir: message.config.logDirectory,
+        clientName: `pipeline-${process.pid}`,
+        onDownloadProgress: (model, progress) => {
+          send({ type: 'model-download-progress', model, progress })
+        },
+        onDaemonPid: (pid) => {
+          setUsageEnginePid(pid)
+          send({ type: 'daemon-pid', pid })
+        }
+      })
+      configurePlugins({
+        pluginDirectory: message.config.pluginDirectory,
+        hostPath: join(__dirname, 'plugin-host.js')
+      })
+      send({ type: 'ready' })
+      break
+    case 'process':
+    case 'process-pcm':
+      handleProcess(message)
+      break
+    case 'dictionary':
+      dictionary.apply(message.change)
+      break
+    case 'shutdown':
+      stopDaemon()
+      closeEngineClient()
+      closePcmSlab()
+      stopPlugins()
+      flushLogs().finally(() => process.exit(0))
+  }
+})
+
+// Never leave an orphaned daemon behind
+process.on('exit', () => {
+  stopDaemon()
+  closePcmSlab()
+})
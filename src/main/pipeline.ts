@@ -0,0 +1,212 @@
+import { app, utilityProcess, UtilityProcess } from 'electron'
+import { join } from 'path'
+import type { Settings, ProcessAudioOptions, ProcessAudioResult } from './openai'
+import type { PipelineRequest, PipelineResponse } from './pipeline-protocol'
+import type { DictionaryEntry, DictionaryChange } from './dictionary-matcher'
+import { createLogger, errorFields, getLoggerOptions, writeLogEntries } from './logger'
+
+// Host side of the audio pipeline utility process
+// Keeps transcription off the main process and restarts the worker if it dies
+
+const RESTART_BASE_DELAY_MS = 500
+const RESTART_MAX_DELAY_MS = 10000
+const STABLE_RUN_MS = 30000 // A worker that lived this long resets the backoff
+
+const log = createLogger('Pipeline')
+
+export interface PipelineEvents {
+  onModelDownloadProgress?: (model: string, progress: number) => void
+  onDaemonPid?: (pid: number | null) => void
+  // Full dictionary, sent to every new worker before it receives deltas
+  loadDictionary?: () => Promise<DictionaryEntry[]>
+}
+
+let child: UtilityProcess | null = null
+let events: PipelineEvents = {}
+let stopping = false
+let restartAttempts = 0
+let startedAt = 0
+let nextRequestId = 1
+// Dictionary deltas held back until the new worker has its snapshot
+let queuedDictionaryChanges: DictionaryChange[] | null = null
+const pendingRequests: Map<
+  number,
+  {
+    resolve: (value: ProcessAudioResult) => void
+    reject: (reason: Error) => void
+  }
+> = new Map()
+
+const send = (message: PipelineRequest): void => {
+  child?.postMessage(message)
+}
+
+const handleMessage = (message: PipelineResponse): void => {
+  switch (message.type) {
+    case 'ready':
+      log.info('Worker ready')
+      break
+    case 'result': {
+      const request = pendingRequests.get(message.id)
+      pendingRequests.delete(message.id)
+      request?.resolve({
+        text: message.text,
+        durationMs: message.durationMs,
+        stageMs: message.stageMs,
+        usage: message.usage
+      })
+      break
+    }
+    case 'error': {
+      const request = pendingRequests.get(message.id)
+      pendingRequests.delete(message.id)
+      request?.reject(new Error(message.message))
+      break
+    }
+    case 'model-download-progress':
+      events.onModelDownloadProgress?.(message.model, message.progress)
+      break
+    case 'daemon-pid':
+      events.onDaemonPid?.(message.pid)
+      break
+    case 'log':
+      writeLogEntries(message.entries)
+      break
+  }
+}
+
+// Changes made while the snapshot loads are replayed after it (they are idempotent)
+const sendDictionarySnapshot = (): void => {
+  if (!child || !events.loadDictionary) return
+  const worker = child
+  queuedDictionaryChanges = []
+  events
+    .loadDictionary()
+    .then((entries) => {
+      if (child !== worker) return
+      send({ type: 'dictionary', change: { op: 'reset', entries } })
+      queuedDictionaryChanges?.forEach((change) => send({ type: 'dictionary', change }))
+    })
+    .catch((error) => log.error('Failed to load dictionary', () => errorFields(error)))
+    .finally(() => {
+      if (child === worker) queuedDictionaryChanges = null
+    })
+}
+
+const spawnWorker = (): void => {
+  startedAt = Date.now()
+  child = utilityProcess.fork(join(__dirname, 'pipeline-worker.js'), [], {
+    serviceName: 'Wispr Audio Pipeline'
+  })
+
+  child.on('message', handleMessage)
+
+  child.on('exit', (code) => {
+    log.info(() => `Worker exited with code ${code}`)
+    child = null
+    events.onDaemonPid?.(null) // The daemon is stopped along with the worker
+
+    // In-flight dictations are lost with the worker
+    for (const request of pendingRequests.values()) {
+      request.reject(new Error('Audio pipeline exited unexpectedly'))
+    }
+    pendingRequests.clear()
+
+    if (stopping) return
+
+    // Restart in the background with exponential backoff
+    if (Date.now() - startedAt > STABLE_RUN_MS) {
+      restartAttempts = 0
+    }
+    const delay = Math.min(RESTART_BASE_DELAY_MS * 2 ** restartAttempts, RESTART_MAX_DELAY_MS)
+    restartAttempts++
+    log.info(() => `Restarting worker in ${delay}ms`)
+    setTimeout(() => {
+      if (!stopping && !child) spawnWorker()
+    }, delay)
+  })
+
+  send({
+    type: 'init',
+    config: {
+      isPackaged: app.isPackaged,
+      resourcesPath: process.resourcesPath,
+      logDirectory: join(app.getPath('userData'), 'logs'),
+      pluginDirectory: join(app.getPath('userData'), 'plugins')
+    },
+    logging: getLoggerOptions()
+  })
+  sendDictionarySnapshot()
+}
+
+/**
+ * Start the pipeline utility process (call once after app is ready)
+ */
+export function startPipeline(pipelineEvents: PipelineEvents = {}): void {
+  events = pipelineEvents
+  stopping = false
+  // An early dictation may have spawned the worker before the events were set,
+  // in which case it has no dictionary yet
+  if (child) sendDictionarySnapshot()
+  else spawnWorker()
+}
+
+/**
+ * Stop the pipeline and its WhisperKit daemon
+ */
+export function stopPipeline(): void {
+  stopping = true
+  if (child) {
+    send({ type: 'shutdown' })
+  }
+}
+
+/**
+ * Forward a dictionary change to the worker's matcher
+ */
+export function updatePipelineDictionary(change: DictionaryChange): void {
+  if (queuedDictionaryChanges) {
+    queuedDictionaryChanges.push(change)
+  } else {
+    send({ type: 'dictionary', change })
+  }
+}
+
+const request = (
+  message: Extract<PipelineRequest, { type: 'process' | 'process-pcm' }>
+): Promise<ProcessAudioResult> => {
+  if (stopping) {
+    return Promise.reject(new Error('Audio pipeline is shutting down'))
+  }
+
+  // Don't wait out a restart backoff when the user is dictating
+  if (!child) spawnWorker()
+
+  return new Promise((resolve, reject) => {
+    pendingRequests.set(message.id, { resolve, reject })
+    send(message)
+  })
+}
+
+/**
+ * Run a recording through the pipeline (transcription + formatting)
+ */
+export function runPipeline(
+  buffer: ArrayBuffer,
+  settings: Settings,
+  options?: ProcessAudioOptions
+): Promise<ProcessAudioResult> {
+  return request({ type: 'process', id: nextRequestId++, buffer, settings, options })
+}
+
+/**
+ * Run PCM captured in the main process through the pipeline
+ */
+export function runPipelinePcm(
+  pcm: Int16Array,
+  sampleRate: number,
+  settings: Settings,
+  options?: ProcessAudioOptions
+): Promise<ProcessAudioResult> {
+  return request({ type: 'process-pcm', id: nextRequestId++, pcm, sampleRate, settings, options })
+}
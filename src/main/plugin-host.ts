@@ -0,0 +1,98 @@
+import { parentPort, workerData } from 'worker_threads'
+import { readFileSync } from 'fs'
+import vm from 'vm'
+
+// Worker thread hosting one post-processing plugin (see postprocess.ts)
+// JS plugins run in a fresh vm context that holds no host objects (no require, process,
+// timers or console) - text goes in as a string, context as JSON. WASM plugins get no
+// imports at all. A vm context is not a security boundary against hostile code; it
+// keeps well-meaning plugins away from Node. The thread is what bounds them: the
+// pipeline terminates it when a call overruns its budget
+
+export interface PluginHostData {
+  kind: 'js' | 'wasm'
+  entry: string // Absolute path of the script or module
+}
+
+export type PluginHostRequest = { id: number; text: string; context: PluginContext }
+
+export type PluginHostResponse =
+  | { type: 'ready' }
+  | { type: 'load-error'; message: string }
+  | { id: number; text: string }
+  | { id: number; error: string }
+
+// What a plugin learns about the dictation
+export interface PluginContext {
+  mode: 'cloud' | 'local'
+  language: string
+  style: string
+}
+
+type Transform = (text: string, context: PluginContext) => string | Promise<string>
+
+const { kind, entry } = workerData as PluginHostData
+const port = parentPort!
+
+const LOAD_TIMEOUT_MS = 1000
+
+// module.exports.transform = (text, context) => string | Promise<string>
+const loadScript = (): Transform => {
+  const sandbox = vm.createContext(Object.create(null))
+  vm.runInContext('var module = { exports: {} }; var exports = module.exports', sandbox)
+  new vm.Script(readFileSync(entry, 'utf-8'), { filename: entry }).runInContext(sandbox, {
+    timeout: LOAD_TIMEOUT_MS
+  })
+  // Built inside the context so the plugin never holds a host function
+  const call = vm.runInContext(
+    `(function (text, context) {
+      if (typeof module.exports.transform !== 'function') return undefined
+      return module.exports.transform(text, JSON.parse(context))
+    })`,
+    sandbox
+  ) as (text: string, context: string) => string | Promise<string> | undefined
+  if (vm.runInContext('typeof module.exports.transform', sandbox) !== 'function') {
+    throw new Error('Plugin does not export transform(text, context)')
+  }
+  return (text, context) => call(text, JSON.stringify(context)) as string | Promise<string>
+}
+
+// ABI: memory, alloc(bytes) -> ptr, transform(ptr, len) -> ptr, output_len() -> len (UTF-8)
+const loadWasm = async (): Promise<Transform> => {
+  const { instance } = await WebAssembly.instantiate(readFileSync(entry), {})
+  const { memory, alloc, transform, output_len } = instance.exports as {
+    memory: WebAssembly.Memory
+    alloc: (bytes: number) => number
+    transform: (ptr: number, len: number) => number
+    output_len: () => number
+  }
+  if (!(memory instanceof WebAssembly.Memory) || typeof alloc !== 'function' || typeof transform !== 'function') {
+    throw new Error('WASM plugin must export memory, alloc, transform and output_len')
+  }
+  const encoder = new TextEncoder()
+  const decoder = new TextDecoder()
+  return (text) => {
+    const input = encoder.encode(text)
+    const ptr = alloc(input.length)
+    new Uint8Array(memory.buffer, ptr, input.length).set(input)
+    const out = transform(ptr, input.length)
+    return decoder.decode(new Uint8Array(memory.buffer, out, output_len()))
+  }
+}
+
+const send = (message: PluginHostResponse): void => port.postMessage(message)
+
+;(kind === 'wasm' ? loadWasm() : Promise.resolve().then(loadScript))
+  .then((transform) => {
+    port.on('message', async ({ id, text, context }: PluginHostRequest) => {
+      try {
+        const result = await transform(text, context)
+        if (typeof result !== 'string') throw new Error('transform must return a string')
+        send({ id, text: result })
+      } catch (error) {
+        send({ id, error: error instanceof Error ? error.message : String(error) })
+      }
+    })
+    send({ type: 'ready' })
+  })
+  .catch((error) => send({ type: 'load-error', message: error instanceof Error ? error.message : String(error) }))
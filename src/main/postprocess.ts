@@ -0,0 +1,279 @@
+import { Worker } from 'worker_threads'
+import fs from 'fs'
+import path from 'path'
+import { createLogger, errorFields } from './logger'
+import type { PluginContext, PluginHostData, PluginHostResponse } from './plugin-host'
+
+// Post-processing pipeline between transcription and the result
+// Each stage has a time budget. A stage that overruns or fails is skipped (its input
+// passes through unchanged) so one slow transform never costs a dictation. Built-in
+// stages run in-process and receive an AbortSignal; user plugins (JS or WASM, under
+// <userData>/plugins/<name>/plugin.json) each live in their own worker thread, which
+// is terminated and respawned on overrun. Latency is tracked per stage
+
+export interface PostProcessStage {
+  name: string
+  budgetMs?: number // Omitted: no budget, the stage relies on its own timeouts
+  // Returns the new text; an empty string drops the dictation and ends the pipeline
+  run: (text: string, signal: AbortSignal) => Promise<string> | string
+}
+
+export type StageOutcome = 'ok' | 'overrun' | 'error'
+
+export interface StageReport {
+  name: string
+  ms: number
+  outcome: StageOutcome
+}
+
+// plugin.json
+interface PluginManifest {
+  name?: string
+  entry: string // Relative to the plugin directory; .wasm loads as WebAssembly
+  budgetMs?: number
+  enabled?: boolean
+}
+
+const DEFAULT_PLUGIN_BUDGET_MS = 100
+const MAX_PLUGIN_BUDGET_MS = 2000
+const PLUGIN_MEMORY_MB = 64
+const STATS_WINDOW = 200 // Most recent runs per stage
+const STATS_LOG_EVERY = 25
+
+const log = createLogger('PostProcess')
+
+const latencies: Map<string, number[]> = new Map()
+const outcomes: Map<string, Record<StageOutcome, number>> = new Map()
+let runs = 0
+
+let hostPath: string | null = null
+let plugins: PluginWorker[] = []
+
+class StageOverrunError extends Error {}
+
+/**
+ * Run text through the stages in order
+ */
+export async function runStages(
+  text: string,
+  stages: PostProcessStage[]
+): Promise<{ text: string; reports: StageReport[] }> {
+  const reports: StageReport[] = []
+  let current = text
+
+  for (const stage of stages) {
+    const controller = new AbortController()
+    let timer: NodeJS.Timeout | undefined
+    const started = performance.now()
+    let outcome: StageOutcome = 'ok'
+
+    try {
+      const result = Promise.resolve(stage.run(current, controller.signal))
+      if (stage.budgetMs === undefined) {
+        current = await result
+      } else {
+        const budgetMs = stage.budgetMs
+        const overrun = new Promise<never>((_, reject) => {
+          timer = setTimeout(() => {
+            controller.abort()
+            reject(new StageOverrunError())
+          }, budgetMs)
+        })
+        current = await Promise.race([result, overrun])
+      }
+    } catch (error) {
+      outcome = error instanceof StageOverrunError ? 'overrun' : 'error'
+      if (outcome === 'error') log.warn(() => `Stage ${stage.name} failed, skipping it`, () => errorFields(error))
+      else log.warn(() => `Stage ${stage.name} overran its ${stage.budgetMs}ms budget, skipping it`)
+    } finally {
+      clearTimeout(timer)
+    }
+
+    const ms = performance.now() - started
+    reports.push({ name: stage.name, ms: Math.round(ms), outcome })
+    recordStage(stage.name, ms, outcome)
+    if (!current) break
+  }
+
+  if (++runs % STATS_LOG_EVERY === 0) log.info('Post-processing latency by stage', () => getPostProcessStats())
+  return { text: current, reports }
+}
+
+const recordStage = (name: string, ms: number, outcome: StageOutcome): void => {
+  const window = latencies.get(name) ?? []
+  window.push(ms)
+  if (window.length > STATS_WINDOW) window.shift()
+  latencies.set(name, window)
+
+  const counts = outcomes.get(name) ?? { ok: 0, overrun: 0, error: 0 }
+  counts[outcome]++
+  outcomes.set(name, counts)
+}
+
+const percentile = (sorted: number[], q: number): number =>
+  sorted.length ? Math.round(sorted[Math.min(sorted.length - 1, Math.ceil(q * sorted.length) - 1)]) : 0
+
+export function getPostProcessStats(): Record<string, { p50Ms: number; p95Ms: number } & Record<StageOutcome, number>> {
+  return Object.fromEntries(
+    [...latencies.entries()].map(([name, window]) => {
+      const sorted = [...window].sort((a, b) => a - b)
+      return [name, { p50Ms: percentile(sorted, 0.5), p95Ms: percentile(sorted, 0.95), ...outcomes.get(name)! }]
+    })
+  )
+}
+
+// One plugin in its own worker thread; calls are serialized (one dictation at a time)
+class PluginWorker {
+  readonly name: string
+  readonly budgetMs: number
+  private readonly data: PluginHostData
+  private worker: Worker | null = null
+  private ready: Promise<void> | null = null
+  private nextId = 1
+  private pending: Map<number, { resolve: (text: string) => void; reject: (error: Error) => void }> = new Map()
+  disabled = false
+
+  constructor(name: string, budgetMs: number, data: PluginHostData) {
+    this.name = name
+    this.budgetMs = budgetMs
+    this.data = data
+  }
+
+  private start(): Promise<void> {
+    const worker = new Worker(hostPath!, {
+      workerData: this.data,
+      env: {}, // No API keys or paths from this process
+      resourceLimits: { maxOldGenerationSizeMb: PLUGIN_MEMORY_MB }
+    })
+    this.worker = worker
+    this.ready = new Promise<void>((resolve, reject) => {
+      worker.on('message', (message: PluginHostResponse) => {
+        if ('type' in message) {
+          if (message.type === 'ready') resolve()
+          else {
+            // A plugin that can't load won't load next time either
+            this.disabled = true
+            log.error(() => `Plugin ${this.name} failed to load: ${message.message}`)
+            reject(new Error(message.message))
+          }
+          return
+        }
+        const call = this.pending.get(message.id)
+        this.pending.delete(message.id)
+        if ('error' in message) call?.reject(new Error(message.error))
+        else call?.resolve(message.text)
+      })
+      worker.on('error', (error) => {
+        reject(error)
+        this.fail(error)
+      })
+      worker.on('exit', () => {
+        if (this.worker === worker) this.fail(new Error('Plugin worker exited'))
+      })
+    })
+    return this.ready
+  }
+
+  private fail(error: Error): void {
+    this.pending.forEach((call) => call.reject(error))
+    this.pending.clear()
+    this.worker = null
+    this.ready = null
+  }
+
+  // Started at configure time, so thread startup isn't charged to a dictation's budget
+  warm(): Promise<void> {
+    return this.ready ?? this.start()
+  }
+
+  async transform(text: string, context: PluginContext, signal: AbortSignal): Promise<string> {
+    await this.warm()
+    const worker = this.worker
+    if (!worker) throw new Error('Plugin worker exited')
+    const id = this.nextId++
+    const result = new Promise<string>((resolve, reject) => this.pending.set(id, { resolve, reject }))
+    // An overrunning plugin may be stuck in a loop - only terminating the thread stops it
+    const onAbort = (): void => {
+      if (this.worker !== worker) return
+      this.fail(new StageOverrunError())
+      worker.terminate()
+    }
+    signal.addEventListener('abort', onAbort, { once: true })
+    worker.postMessage({ id, text, context })
+    try {
+      return await result
+    } finally {
+      signal.removeEventListener('abort', onAbort)
+    }
+  }
+
+  stop(): void {
+    const worker = this.worker
+    this.fail(new Error('Plugin stopped'))
+    worker?.terminate()
+  }
+}
+
+const readPlugin = (directory: string): PluginWorker | null => {
+  const manifestPath = path.join(directory, 'plugin.json')
+  if (!fs.existsSync(manifestPath)) return null
+  try {
+    const manifest = JSON.parse(fs.readFileSync(manifestPath, 'utf-8')) as PluginManifest
+    if (manifest.enabled === false) return null
+    const entry = path.resolve(directory, manifest.entry)
+    // The entry must stay inside the plugin's own directory
+    if (path.relative(directory, entry).startsWith('..') || !fs.existsSync(entry)) {
+      throw new Error(`entry ${manifest.entry} not found in the plugin directory`)
+    }
+    const budgetMs = Math.min(MAX_PLUGIN_BUDGET_MS, Math.max(1, manifest.budgetMs ?? DEFAULT_PLUGIN_BUDGET_MS))
+    return new PluginWorker(manifest.name || path.basename(directory), budgetMs, {
+      kind: entry.endsWith('.wasm') ? 'wasm' : 'js',
+      entry
+    })
+  } catch (error) {
+    log.error(() => `Skipping plugin in ${directory}`, () => errorFields(error))
+    return null
+  }
+}
+
+/**
+ * Load user plugins (one directory each, run in name order) and start their workers
+ */
+export function configurePlugins(options: { pluginDirectory: string; hostPath: string }): void {
+  stopPlugins()
+  hostPath = options.hostPath
+  let directories: string[] = []
+  try {
+    directories = fs
+      .readdirSync(options.pluginDirectory, { withFileTypes: true })
+      .filter((entry) => entry.isDirectory())
+      .map((entry) => path.join(options.pluginDirectory, entry.name))
+      .sort()
+  } catch {
+    return // No plugin directory - nothing installed
+  }
+
+  plugins = directories.map(readPlugin).filter((plugin): plugin is PluginWorker => plugin !== null)
+  for (const plugin of plugins) plugin.warm().catch(() => undefined)
+  if (plugins.length > 0) {
+    log.info('Post-processing plugins', () => ({ plugins: plugins.map((p) => `${p.name} (${p.budgetMs}ms)`) }))
+  }
+}
+
+/**
+ * Stages for the installed plugins, run after the built-in ones
+ */
+export function getPluginStages(context: PluginContext): PostProcessStage[] {
+  return plugins
+    .filter((plugin) => !plugin.disabled)
+    .map((plugin) => ({
+      name: `plugin:${plugin.name}`,
+      budgetMs: plugin.budgetMs,
+      run: (text, signal) => plugin.transform(text, context, signal)
+    }))
+}
+
+export function stopPlugins(): void {
+  plugins.forEach((plugin) => plugin.stop())
+  plugins = []
+}
@@ -0,0 +1,201 @@
+import { app } from 'electron'
+import { monitorEventLoopDelay, PerformanceObserver, IntervalHistogram } from 'perf_hooks'
+import { readFile } from 'fs/promises'
+import { execFile } from 'child_process'
+import { promisify } from 'util'
+import { createLogger, errorFields } from './logger'
+
+// Sampling resource monitor for the whole app
+// Every interval records RSS and CPU% per Electron process (main, renderers, pipeline
+// worker), the WhisperKit daemon, main-process event-loop delay and GC pauses.
+// Samples are kept in a bounded in-memory series for the Settings diagnostics panel
+
+const execFileAsync = promisify(execFile)
+
+const SAMPLE_INTERVAL_MS = 5000
+const MAX_SAMPLES = 720 // One hour at the default interval
+const CLOCK_TICKS_PER_SECOND = 100 // USER_HZ on Linux
+
+const log = createLogger('ResourceMonitor')
+
+export interface ProcessSample {
+  pid: number
+  type: string // Electron process type, or 'daemon'
+  name: string
+  rssMB: number
+  cpuPercent: number
+}
+
+export interface ResourceSample {
+  timestamp: number
+  processes: ProcessSample[]
+  mainHeapUsedMB: number
+  eventLoopDelayMs: { p50: number; p99: number; max: number }
+  gc: { count: number; totalMs: number; maxMs: number }
+}
+
+let samples: ResourceSample[] = []
+let timer: NodeJS.Timeout | null = null
+let histogram: IntervalHistogram | null = null
+let gcObserver: PerformanceObserver | null = null
+let gcStats = { count: 0, totalMs: 0, maxMs: 0 }
+let daemonPid: number | null = null
+let daemonCpuTicks: { ticks: number; at: number } | null = null
+let onSample: ((sample: ResourceSample) => void) | null = null
+
+const round = (value: number, digits = 1): number => {
+  const factor = 10 ** digits
+  return Math.round(value * factor) / factor
+}
+
+/**
+ * Track the WhisperKit daemon (its pid lives in the pipeline utility process)
+ */
+export function setDaemonPid(pid: number | null): void {
+  daemonPid = pid
+  daemonCpuTicks = null
+}
+
+// Linux: RSS from /proc/<pid>/status, CPU from utime+stime deltas in /proc/<pid>/stat
+const sampleProcLinux = async (pid: number): Promise<{ rssMB: number; cpuPercent: number }> => {
+  const [status, stat] = await Promise.all([
+    readFile(`/proc/${pid}/status`, 'utf-8'),
+    readFile(`/proc/${pid}/stat`, 'utf-8')
+  ])
+
+  const rssKB = Number(/VmRSS:\s+(\d+)/.exec(status)?.[1] ?? 0)
+
+  // The command name can contain spaces - fields are counted after its closing paren
+  const fields = stat.slice(stat.lastIndexOf(')') + 2).split(' ')
+  const ticks = Number(fields[11]) + Number(fields[12]) // utime + stime
+  const now = Date.now()
+  let cpuPercent = 0
+  if (daemonCpuTicks) {
+    const elapsedSeconds = (now - daemonCpuTicks.at) / 1000
+    cpuPercent = ((ticks - daemonCpuTicks.ticks) / CLOCK_TICKS_PER_SECOND / elapsedSeconds) * 100
+  }
+  daemonCpuTicks = { ticks, at: now }
+
+  return { rssMB: rssKB / 1024, cpuPercent }
+}
+
+// macOS has no /proc - ps reports the same two numbers
+const sampleProcPs = async (pid: number): Promise<{ rssMB: number; cpuPercent: number }> => {
+  const { stdout } = await execFileAsync('ps', ['-o', 'rss=,%cpu=', '-p', String(pid)])
+  const [rssKB, cpu] = stdout.trim().split(/\s+/).map(Number)
+  return { rssMB: (rssKB || 0) / 1024, cpuPercent: cpu || 0 }
+}
+
+const sampleDaemon = async (): Promise<ProcessSample | null> => {
+  if (daemonPid === null) return null
+  try {
+    const usage =
+      process.platform === 'linux' ? await sampleProcLinux(daemonPid) : await sampleProcPs(daemonPid)
+    return {
+      pid: daemonPid,
+      type: 'daemon',
+      name: 'WhisperKit daemon',
+      rssMB: round(usage.rssMB),
+      cpuPercent: round(usage.cpuPercent)
+    }
+  } catch {
+    return null // Exited between samples
+  }
+}
+
+const takeSample = async (): Promise<ResourceSample> => {
+  const processes: ProcessSample[] = app.getAppMetrics().map((metric) => ({
+    pid: metric.pid,
+    type: metric.type,
+    name: metric.serviceName || metric.name || metric.type,
+    rssMB: round(metric.memory.workingSetSize / 1024),
+    cpuPercent: round(metric.cpu.percentCPUUsage)
+  }))
+
+  const daemon = await sampleDaemon()
+  if (daemon) processes.push(daemon)
+
+  const eventLoopDelayMs = histogram
+    ? {
+        p50: round(histogram.percentile(50) / 1e6, 2),
+        p99: round(histogram.percentile(99) / 1e6, 2),
+        max: round(histogram.max / 1e6, 2)
+      }
+    : { p50: 0, p99: 0, max: 0 }
+  histogram?.reset()
+
+  const gc = { count: gcStats.count, totalMs: round(gcStats.totalMs, 2), maxMs: round(gcStats.maxMs, 2) }
+  gcStats = { count: 0, totalMs: 0, maxMs: 0 }
+
+  return {
+    timestamp: Date.now(),
+    processes,
+    mainHeapUsedMB: round(process.memoryUsage().heapUsed / 1024 / 1024),
+    eventLoopDelayMs,
+    gc
+  }
+}
+
+/**
+ * Start sampling (call once after startup; the timer never keeps the app alive)
+ */
+export function startResourceMonitor(listener?: (sample: ResourceSample) => void): void {
+  if (timer) return
+  onSample = listener ?? null
+
+  histogram = monitorEventLoopDelay({ resolution: 10 })
+  histogram.enable()
+
+  gcObserver = new PerformanceObserver((list) => {
+    for (const entry of list.getEntries()) {
+      gcStats.count++
+      gcStats.totalMs += entry.duration
+      gcStats.maxMs = Math.max(gcStats.maxMs, entry.duration)
+    }
+  })
+  gcObserver.observe({ entryTypes: ['gc'] })
+
+  timer = setInterval(() => {
+    takeSample()
+      .then((sample) => {
+        samples.push(sample)
+        if (samples.length > MAX_SAMPLES) samples = samples.slice(-MAX_SAMPLES)
+        onSample?.(sample)
+      })
+      .catch((error) => log.error('Sample failed', () => errorFields(error)))
+  }, SAMPLE_INTERVAL_MS)
+  timer.unref()
+}
+
+export function stopResourceMonitor(): void {
+  if (timer) clearInterval(timer)
+  timer = null
+  histogram?.disable()
+  histogram = null
+  gcObserver?.disconnect()
+  gcObserver = null
+}
+
+export function getResourceSamples(): ResourceSample[] {
+  return [...samples]
+}
+
+/**
+ * The collected series plus enough context to compare runs (and any related records)
+ */
+export function exportResourceSamples(extra: Record<string, unknown> = {}): string {
+  return JSON.stringify(
+    {
+      exportedAt: new Date().toISOString(),
+      appVersion: app.getVersion(),
+      platform: process.platform,
+      arch: process.arch,
+      versions: { electron: process.versions.electron, node: process.versions.node },
+      intervalMs: SAMPLE_INTERVAL_MS,
+      samples,
+      ...extra
+    },
+    null,
+    2
+  )
+}
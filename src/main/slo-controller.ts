@@ -0,0 +1,157 @@
+import { createLogger } from './logger'
+
+// End-to-end latency controller for dictation
+// Tracks a rolling (EWMA) latency per pipeline stage and compares their sum against
+// the configured target (key release -> text injected). While the target is breached
+// it steps down through degradation levels, one at a time; once there is clear
+// headroom again it steps back up. Levels that can't help in the current mode (e.g.
+// formatting in local mode, which never formats) are skipped
+
+export type LatencyStage = 'capture' | 'transcribe' | 'format' | 'inject'
+
+const STAGES: LatencyStage[] = ['capture', 'transcribe', 'format', 'inject']
+
+export const DEFAULT_LATENCY_TARGET_MS = 1500
+const EWMA_ALPHA = 0.3
+const BREACH_SAMPLES = 2 // Consecutive dictations over target before degrading
+const RECOVERY_SAMPLES = 5 // Consecutive dictations with headroom before recovering
+const HEADROOM_RATIO = 0.6 // "Headroom" means under 60% of the target
+const MIN_SAMPLES_BETWEEN_TRANSITIONS = 3 // Let the new level show its effect first
+// Transcription time grows with audio length; longer dictations are scaled down to
+// this reference so one long note doesn't read as a slow engine
+const REFERENCE_AUDIO_MS = 10_000
+
+const SHORT_TEXT_WORDS = 12
+const DEGRADED_TRAILING_CAPTURE_MS = 30
+
+// One size down, keeping English-only models English-only
+const SMALLER_MODEL: Record<string, string> = {
+  'large-v3': 'medium',
+  medium: 'small',
+  'medium.en': 'small.en',
+  small: 'base',
+  'small.en': 'base.en',
+  base: 'tiny',
+  'base.en': 'tiny.en'
+}
+
+type Level = 'normal' | 'skip-short-formatting' | 'smaller-model' | 'short-capture-tail'
+
+const LEVELS: Level[] = ['normal', 'skip-short-formatting', 'smaller-model', 'short-capture-tail']
+
+/**
+ * What the current level changes for the next dictation (levels are cumulative)
+ */
+export interface DegradationPlan {
+  level: Level
+  skipFormattingUnderWords: number | null
+  localModel: string | null // Override for settings.localModel
+  trailingCaptureMs: number | null // Override for the capture tail after key release
+}
+
+export interface DictationTiming {
+  stages: Partial<Record<LatencyStage, number>>
+  audioMs: number
+  mode: 'cloud' | 'local'
+  localModel?: string
+}
+
+const log = createLogger('LatencySLO')
+
+let targetMs = DEFAULT_LATENCY_TARGET_MS
+let levelIndex = 0
+const ewma: Partial<Record<LatencyStage, number>> = {}
+let breaches = 0
+let healthy = 0
+let samplesSinceTransition = 0
+
+/**
+ * Set the end-to-end target; 0 disables degradation (and resets to normal)
+ */
+export function setLatencyTarget(ms: number): void {
+  targetMs = ms
+  if (ms <= 0 && levelIndex > 0) {
+    log.info('Latency target disabled, back to normal')
+    levelIndex = 0
+  }
+}
+
+const isApplicable = (level: Level, timing: DictationTiming): boolean => {
+  switch (level) {
+    case 'skip-short-formatting':
+      return timing.mode === 'cloud'
+    case 'smaller-model':
+      return timing.mode === 'local' && !!timing.localModel && timing.localModel in SMALLER_MODEL
+    default:
+      return true
+  }
+}
+
+const estimateMs = (): number => STAGES.reduce((total, stage) => total + (ewma[stage] ?? 0), 0)
+
+const stageSummary = (): Record<string, number> =>
+  Object.fromEntries(STAGES.filter((stage) => ewma[stage] !== undefined).map((stage) => [stage, Math.round(ewma[stage]!)]))
+
+const transition = (next: number, reason: string): void => {
+  log.info(
+    () => `Degradation ${LEVELS[levelIndex]} -> ${LEVELS[next]} (${reason})`,
+    () => ({ targetMs, estimateMs: Math.round(estimateMs()), stages: stageSummary() })
+  )
+  levelIndex = next
+  breaches = 0
+  healthy = 0
+  samplesSinceTransition = 0
+}
+
+/**
+ * Feed the stage timings of a finished dictation
+ */
+export function recordDictation(timing: DictationTiming): void {
+  for (const stage of STAGES) {
+    let value = timing.stages[stage]
+    if (value === undefined) continue
+    if (stage === 'transcribe' && timing.audioMs > REFERENCE_AUDIO_MS) {
+      value *= REFERENCE_AUDIO_MS / timing.audioMs
+    }
+    const previous = ewma[stage]
+    ewma[stage] = previous === undefined ? value : previous + EWMA_ALPHA * (value - previous)
+  }
+  if (targetMs <= 0) return
+
+  samplesSinceTransition++
+  const estimate = estimateMs()
+  breaches = estimate > targetMs ? breaches + 1 : 0
+  healthy = estimate < targetMs * HEADROOM_RATIO ? healthy + 1 : 0
+  if (samplesSinceTransition < MIN_SAMPLES_BETWEEN_TRANSITIONS) return
+
+  if (breaches >= BREACH_SAMPLES) {
+    let next = levelIndex + 1
+    while (next < LEVELS.length && !isApplicable(LEVELS[next], timing)) next++
+    if (next < LEVELS.length) {
+      transition(next, `over target for ${breaches} dictations`)
+    } else {
+      log.sampled('exhausted', 60_000).warn('Over latency target at the lowest level', () => ({
+        targetMs,
+        estimateMs: Math.round(estimate),
+        stages: stageSummary()
+      }))
+    }
+  } else if (healthy >= RECOVERY_SAMPLES && levelIndex > 0) {
+    let next = levelIndex - 1
+    while (next > 0 && !isApplicable(LEVELS[next], timing)) next--
+    transition(next, `headroom for ${healthy} dictations`)
+  }
+}
+
+/**
+ * Adjustments for the next dictation under the current level
+ */
+export function getDegradationPlan(localModel?: string): DegradationPlan {
+  const atLeast = (level: Level): boolean => levelIndex >= LEVELS.indexOf(level)
+  return {
+    level: LEVELS[levelIndex],
+    skipFormattingUnderWords: atLeast('skip-short-formatting') ? SHORT_TEXT_WORDS : null,
+    localModel: atLeast('smaller-model') && localModel ? (SMALLER_MODEL[localModel] ?? null) : null,
+    trailingCaptureMs: atLeast('short-capture-tail') ? DEGRADED_TRAILING_CAPTURE_MS : null
+  }
+}
@@ -0,0 +1,59 @@
+import { app } from 'electron'
+import { join } from 'path'
+import { writeFile } from 'fs'
+import { createLogger, errorFields } from './logger'
+
+// Startup trace - marks are relative to process start so module loading is included
+// Written as Chrome trace events (open in chrome://tracing or ui.perfetto.dev)
+
+const STARTUP_TRACE_FILE = 'startup-trace.json'
+
+const log = createLogger('Startup')
+
+interface StartupMark {
+  name: string
+  ms: number
+}
+
+const marks: StartupMark[] = []
+let finished = false
+
+// performance.now() is relative to timeOrigin, which is set when the process starts
+const sinceProcessStart = (): number => performance.now()
+
+/**
+ * Record a named point in the startup sequence
+ */
+export const markStartup = (name: string): void => {
+  if (finished) return
+  marks.push({ name, ms: sinceProcessStart() })
+}
+
+/**
+ * Log the startup timeline and write it to userData (call once the hotkey is live)
+ */
+export const finishStartupTrace = (): void => {
+  if (finished) return
+  markStartup('startup-complete')
+  finished = true
+
+  log.info(() => marks.map((m) => `${m.name}=${m.ms.toFixed(0)}ms`).join(' '))
+
+  const traceEvents = marks.map((m) => ({
+    name: m.name,
+    cat: 'startup',
+    ph: 'i',
+    s: 'g',
+    ts: Math.round(m.ms * 1000), // microseconds
+    pid: process.pid,
+    tid: 0
+  }))
+
+  writeFile(
+    join(app.getPath('userData'), STARTUP_TRACE_FILE),
+    JSON.stringify({ traceEvents }),
+    (error) => {
+      if (error) log.error('Failed to write startup trace', () => errorFields(error))
+    }
+  )
+}
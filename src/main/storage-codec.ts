@@ -0,0 +1,59 @@
+import zlib from 'zlib'
+
+// Codecs applied to store plaintext before encryption (recorded in the payload header)
+export type StorageCodec = 'none' | 'deflate-d1'
+
+// Codec used for all new writes
+export const DEFAULT_CODEC: StorageCodec = 'deflate-d1'
+
+/**
+ * Preset deflate dictionary for short dictation text (version 1)
+ * Seeded with the JSON shapes of our stores and the most frequent words in
+ * English dictation. Deflate favours matches near the end of the dictionary,
+ * so the most common fragments come last. Never edit this string - add a new
+ * codec version instead, or existing stores become unreadable.
+ */
+const DICTIONARY_V1 = Buffer.from(
+  [
+    'email meeting tomorrow today yesterday morning afternoon evening week month',
+    'please thanks thank you hello hey hi sorry sure okay yes no maybe',
+    'could would should might will can need want think know like just really',
+    'about after before because between during from into through with without',
+    'message send call check update review project team client document',
+    'this that these those there their they them then than what when where which who',
+    'have has had been being was were are is the and for not but you your our',
+    '"customInstructions":"","dictionaryEntries":[{"id":"","term":"","replacement":""}',
+    '"hotkey":"CommandOrControl+Shift+Space","triggerMode":"toggle","holdKey":null',
+    '"startOnLogin":false,"style":"polished","language":"auto","transcriptionMode":"cloud"',
+    '[{"id":"","content":"","timestamp":1',
+    '[{"id":"","text":"","timestamp":1,"duration":0,"wpm":0},{"id":"'
+  ].join(' ')
+)
+
+/**
+ * Compress serialized store data with the given codec
+ */
+export const compress = (plaintext: Buffer, codec: StorageCodec = DEFAULT_CODEC): Buffer => {
+  switch (codec) {
+    case 'deflate-d1':
+      return zlib.deflateRawSync(plaintext, { level: 6, dictionary: DICTIONARY_V1 })
+    case 'none':
+      return plaintext
+    default:
+      throw new Error(`Unknown storage codec: ${codec}`)
+  }
+}
+
+/**
+ * Reverse of compress - payloads written before compression have no codec
+ */
+export const decompress = (data: Buffer, codec: StorageCodec = 'none'): Buffer => {
+  switch (codec) {
+    case 'deflate-d1':
+      return zlib.inflateRawSync(data, { dictionary: DICTIONARY_V1 })
+    case 'none':
+      return data
+    default:
+      throw new Error(`Unknown storage codec: ${codec}`)
+  }
+}
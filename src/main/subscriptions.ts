@@ -0,0 +1,115 @@
+import { ipcMain, WebContents } from 'electron'
+
+// Reactive store subscriptions over IPC
+// A window subscribes to a topic, receives a snapshot once, then only deltas
+// pushed on the 'store-delta' channel when the underlying store changes
+// Every delta carries a per-topic sequence number; snapshots report the sequence
+// they include so a subscriber can spot a missed delta and resync
+
+export type StoreTopic =
+  | 'history'
+  | 'notes'
+  | 'stats'
+  | 'settings'
+  | 'dictionary'
+  | 'diagnostics'
+  | 'capture-health'
+
+type SnapshotProvider = () => unknown | Promise<unknown>
+
+const snapshotProviders: Map<StoreTopic, SnapshotProvider> = new Map()
+const subscribers: Map<StoreTopic, Set<WebContents>> = new Map()
+const sequences: Map<StoreTopic, number> = new Map()
+// Windows with a 'destroyed' cleanup attached - one per window, however often it
+// subscribes (pooled windows live long and resubscribe on every open)
+const tracked: WeakSet<WebContents> = new WeakSet()
+
+export interface StoreSnapshot {
+  seq: number
+  data: unknown
+}
+
+/**
+ * Register the snapshot source for a topic
+ */
+export const registerStoreTopic = (topic: StoreTopic, getSnapshot: SnapshotProvider): void => {
+  snapshotProviders.set(topic, getSnapshot)
+  if (!subscribers.has(topic)) {
+    subscribers.set(topic, new Set())
+    sequences.set(topic, 0)
+  }
+}
+
+/**
+ * Push a delta to every window subscribed to the topic
+ */
+export const publishStoreDelta = (topic: StoreTopic, delta: unknown): void => {
+  // Advance even with no listeners so sequence numbers never repeat
+  const seq = (sequences.get(topic) ?? 0) + 1
+  sequences.set(topic, seq)
+
+  const targets = subscribers.get(topic)
+  if (!targets || targets.size === 0) return
+
+  for (const contents of targets) {
+    if (contents.isDestroyed()) {
+      targets.delete(contents)
+      continue
+    }
+    contents.send('store-delta', topic, seq, delta)
+  }
+}
+
+/**
+ * Whether any window currently listens to a topic (lets publishers skip work)
+ */
+export const hasStoreSubscribers = (topic: StoreTopic): boolean => {
+  return (subscribers.get(topic)?.size ?? 0) > 0
+}
+
+const removeSubscriber = (topic: StoreTopic, contents: WebContents): void => {
+  subscribers.get(topic)?.delete(contents)
+}
+
+const takeSnapshot = async (topic: StoreTopic): Promise<StoreSnapshot> => {
+  const getSnapshot = snapshotProviders.get(topic)
+  if (!getSnapshot) {
+    throw new Error(`Unknown store topic: ${topic}`)
+  }
+  // Read the sequence first: the snapshot contains at least every delta up to it,
+  // and replaying a later delta that also made it in is harmless
+  const seq = sequences.get(topic) ?? 0
+  return { seq, data: await getSnapshot() }
+}
+
+/**
+ * Register the subscribe/unsubscribe IPC handlers (call once on startup)
+ */
+export const initStoreSubscriptions = (): void => {
+  ipcMain.handle('store-subscribe', async (event, topic: StoreTopic) => {
+    if (!snapshotProviders.has(topic)) {
+      throw new Error(`Unknown store topic: ${topic}`)
+    }
+
+    // Subscribe before taking the snapshot - deltas are idempotent, so a change
+    // that lands in both is harmless while one that lands in neither would be lost
+    const contents = event.sender
+    const targets = subscribers.get(topic)!
+    targets.add(contents)
+    if (!tracked.has(contents)) {
+      tracked.add(contents)
+      contents.once('destroyed', () => {
+        for (const topicTargets of subscribers.values()) topicTargets.delete(contents)
+      })
+    }
+
+    return takeSnapshot(topic)
+  })
+
+  // Resync after a sequence gap - the window stays subscribed
+  ipcMain.handle('store-snapshot', (_, topic: StoreTopic) => takeSnapshot(topic))
+
+  ipcMain.on('store-unsubscribe', (event, topic: StoreTopic) => {
+    removeSubscriber(topic, event.sender)
+  })
+}
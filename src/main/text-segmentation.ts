@@ -0,0 +1,32 @@
+// Script-aware word counting
+// Whitespace splitting sees a whole Chinese, Japanese, Thai or Khmer utterance as one
+// word. Intl.Segmenter runs ICU's break iterators natively: dictionary-based for
+// scripts written without spaces, UAX #29 rules for the rest. Punctuation and
+// whitespace segments are not word-like, so they never count
+
+// Segmenters are costly to construct and stateless to use - share one
+const wordSegmenter = new Intl.Segmenter(undefined, { granularity: 'word' })
+
+// Scripts that need the dictionary segmenter; anything else splits on whitespace
+export const UNSPACED_SCRIPT =
+  /[\p{Script=Han}\p{Script=Hiragana}\p{Script=Katakana}\p{Script=Thai}\p{Script=Khmer}\p{Script=Lao}\p{Script=Myanmar}]/u
+const WORD_CHARACTER = /[\p{L}\p{N}]/u
+
+/**
+ * Number of words in text, in any script
+ */
+export function countWords(text: string): number {
+  if (!UNSPACED_SCRIPT.test(text)) {
+    let words = 0
+    for (const token of text.split(/\s+/)) {
+      if (WORD_CHARACTER.test(token)) words++
+    }
+    return words
+  }
+
+  let words = 0
+  for (const segment of wordSegmenter.segment(text)) {
+    if (segment.isWordLike) words++
+  }
+  return words
+}
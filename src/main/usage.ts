@@ -0,0 +1,238 @@
+import fs from 'fs'
+import { execFile } from 'child_process'
+import { promisify } from 'util'
+
+// Per-dictation cost accounting
+// The pipeline worker meters each run (exact audio and speech duration, payload bytes,
+// LLM tokens, CPU time per stage, engine CPU and peak memory) into a compact
+// UsageRecord. Main stores it on the history entry; summarizeUsage() aggregates
+// records for capacity planning
+
+const execFileAsync = promisify(execFile)
+
+const CLOCK_TICKS_PER_SECOND = 100 // USER_HZ on Linux
+const VAD_FRAME_MS = 20
+const VAD_HANGOVER_FRAMES = 10 // Bridge pauses up to 200ms inside speech
+const VAD_MIN_DBFS = -50 // Anything quieter is never speech
+const VAD_MARGIN_DB = 10 // Over the estimated noise floor
+
+export type UsageStage = 'decode' | 'transcribe' | 'format'
+
+export interface StageUsage {
+  ms: number
+  cpuMs: number // This process (user + system)
+  bytesUp?: number // Request payload (audio, prompt) - excludes HTTP/TLS overhead
+  bytesDown?: number // Response payload
+}
+
+export interface UsageRecord {
+  mode: 'cloud' | 'local'
+  audioMs: number
+  audioExact: boolean // False when only the encoded size was known
+  speechMs: number | null
+  stages: Partial<Record<UsageStage, StageUsage>>
+  tokens?: { prompt: number; completion: number }
+  engine?: { cpuMs: number; peakMB: number } // WhisperKit daemon (local mode)
+}
+
+export interface UsageSummary {
+  days: { date: string; dictations: number; audioSeconds: number; speechSeconds: number; bytes: number; tokens: number; cpuMs: number }[]
+  totals: {
+    dictations: number
+    audioSeconds: number
+    speechSeconds: number
+    bytesUp: number
+    bytesDown: number
+    promptTokens: number
+    completionTokens: number
+    cpuMs: number
+    engineCpuMs: number
+    peakEngineMB: number
+  }
+}
+
+let enginePid: number | null = null
+
+/**
+ * Daemon to meter in local mode (the pipeline worker learns it from onDaemonPid)
+ */
+export function setUsageEnginePid(pid: number | null): void {
+  enginePid = pid
+}
+
+// CPU time and peak RSS of another process; peak is VmHWM on Linux, current RSS elsewhere
+const readProcessUsage = async (pid: number): Promise<{ cpuMs: number; peakMB: number } | null> => {
+  try {
+    if (process.platform === 'linux') {
+      const [stat, status] = await Promise.all([
+        fs.promises.readFile(`/proc/${pid}/stat`, 'utf-8'),
+        fs.promises.readFile(`/proc/${pid}/status`, 'utf-8')
+      ])
+      const fields = stat.slice(stat.lastIndexOf(')') + 2).split(' ')
+      const ticks = Number(fields[11]) + Number(fields[12]) // utime + stime
+      return {
+        cpuMs: (ticks / CLOCK_TICKS_PER_SECOND) * 1000,
+        peakMB: Number(/VmHWM:\s+(\d+)/.exec(status)?.[1] ?? 0) / 1024
+      }
+    }
+    const { stdout } = await execFileAsync('ps', ['-o', 'time=,rss=', '-p', String(pid)])
+    const [time, rss] = stdout.trim().split(/\s+/)
+    // [[dd-]hh:]mm:ss.cc
+    const seconds = time
+      .split(/[-:]/)
+      .map(Number)
+      .reduce((total, part, index, parts) => {
+        const weights = parts.length === 4 ? [86400, 3600, 60, 1] : [3600, 60, 1].slice(-parts.length)
+        return total + part * weights[index]
+      }, 0)
+    return { cpuMs: seconds * 1000, peakMB: Number(rss) / 1024 }
+  } catch {
+    return null
+  }
+}
+
+/**
+ * Milliseconds of speech in 16-bit mono PCM (energy gate over an adaptive noise floor)
+ */
+export function measureSpeechMs(samples: Int16Array, sampleRate: number): number {
+  const frameLength = Math.round((sampleRate * VAD_FRAME_MS) / 1000)
+  const frameCount = Math.floor(samples.length / frameLength)
+  if (frameCount === 0) return 0
+
+  const levels = new Float64Array(frameCount)
+  for (let frame = 0; frame < frameCount; frame++) {
+    let sum = 0
+    for (let i = frame * frameLength; i < (frame + 1) * frameLength; i++) sum += samples[i] * samples[i]
+    const rms = Math.sqrt(sum / frameLength) / 32768
+    levels[frame] = rms > 0 ? 20 * Math.log10(rms) : -120
+  }
+
+  // Noise floor: the quietest tenth of the recording
+  const sorted = Float64Array.from(levels).sort()
+  const threshold = Math.max(sorted[Math.floor(frameCount * 0.1)] + VAD_MARGIN_DB, VAD_MIN_DBFS)
+
+  let speechFrames = 0
+  let hangover = 0
+  for (const level of levels) {
+    if (level > threshold) {
+      speechFrames++
+      hangover = VAD_HANGOVER_FRAMES
+    } else if (hangover > 0) {
+      speechFrames++
+      hangover--
+    }
+  }
+  return speechFrames * VAD_FRAME_MS
+}
+
+/**
+ * Collects one pipeline run's usage
+ */
+export class UsageMeter {
+  private record: UsageRecord
+  private engineStart: Promise<{ cpuMs: number; peakMB: number } | null> | null = null
+
+  constructor(mode: 'cloud' | 'local') {
+    this.record = { mode, audioMs: 0, audioExact: false, speechMs: null, stages: {} }
+    if (mode === 'local' && enginePid) this.engineStart = readProcessUsage(enginePid)
+  }
+
+  setAudio(audioMs: number, exact: boolean, pcm?: { samples: Int16Array; sampleRate: number }): void {
+    this.record.audioMs = Math.round(audioMs)
+    this.record.audioExact = exact
+    if (pcm) this.record.speechMs = measureSpeechMs(pcm.samples, pcm.sampleRate)
+  }
+
+  /**
+   * Time a stage (wall clock and this process's CPU); nested or repeated calls add up
+   */
+  async measure<T>(stage: UsageStage, run: () => Promise<T>): Promise<T> {
+    const started = performance.now()
+    const cpu = process.cpuUsage()
+    try {
+      return await run()
+    } finally {
+      const used = process.cpuUsage(cpu)
+      const entry = (this.record.stages[stage] ??= { ms: 0, cpuMs: 0 })
+      entry.ms += Math.round(performance.now() - started)
+      entry.cpuMs += Math.round((used.user + used.system) / 1000)
+    }
+  }
+
+  addBytes(stage: UsageStage, up: number, down: number): void {
+    const entry = (this.record.stages[stage] ??= { ms: 0, cpuMs: 0 })
+    entry.bytesUp = (entry.bytesUp ?? 0) + up
+    entry.bytesDown = (entry.bytesDown ?? 0) + down
+  }
+
+  addTokens(prompt = 0, completion = 0): void {
+    const tokens = (this.record.tokens ??= { prompt: 0, completion: 0 })
+    tokens.prompt += prompt
+    tokens.completion += completion
+  }
+
+  async finish(): Promise<UsageRecord> {
+    const before = await this.engineStart
+    const after = before && enginePid ? await readProcessUsage(enginePid) : null
+    // A restarted daemon in between makes the delta meaningless
+    if (before && after && after.cpuMs >= before.cpuMs) {
+      this.record.engine = {
+        cpuMs: Math.round(after.cpuMs - before.cpuMs),
+        peakMB: Math.round(Math.max(before.peakMB, after.peakMB))
+      }
+    }
+    return this.record
+  }
+}
+
+/**
+ * Per-day and overall totals of stored records (newest day first)
+ */
+export function summarizeUsage(entries: { timestamp: number; usage?: UsageRecord }[]): UsageSummary {
+  const totals: UsageSummary['totals'] = {
+    dictations: 0,
+    audioSeconds: 0,
+    speechSeconds: 0,
+    bytesUp: 0,
+    bytesDown: 0,
+    promptTokens: 0,
+    completionTokens: 0,
+    cpuMs: 0,
+    engineCpuMs: 0,
+    peakEngineMB: 0
+  }
+  const days = new Map<string, UsageSummary['days'][number]>()
+
+  for (const { timestamp, usage } of entries) {
+    if (!usage) continue
+    const stages = Object.values(usage.stages)
+    const bytesUp = stages.reduce((total, stage) => total + (stage.bytesUp ?? 0), 0)
+    const bytesDown = stages.reduce((total, stage) => total + (stage.bytesDown ?? 0), 0)
+    const cpuMs = stages.reduce((total, stage) => total + stage.cpuMs, 0) + (usage.engine?.cpuMs ?? 0)
+    const tokens = (usage.tokens?.prompt ?? 0) + (usage.tokens?.completion ?? 0)
+    const speechSeconds = (usage.speechMs ?? usage.audioMs) / 1000
+
+    totals.dictations++
+    totals.audioSeconds += usage.audioMs / 1000
+    totals.speechSeconds += speechSeconds
+    totals.bytesUp += bytesUp
+    totals.bytesDown += bytesDown
+    totals.promptTokens += usage.tokens?.prompt ?? 0
+    totals.completionTokens += usage.tokens?.completion ?? 0
+    totals.cpuMs += cpuMs
+    totals.engineCpuMs += usage.engine?.cpuMs ?? 0
+    totals.peakEngineMB = Math.max(totals.peakEngineMB, usage.engine?.peakMB ?? 0)
+
+    const date = new Date(timestamp).toISOString().slice(0, 10)
+    const day = days.get(date) ?? { date, dictations: 0, audioSeconds: 0, speechSeconds: 0, bytes: 0, tokens: 0, cpuMs: 0 }
+    day.dictations++
+    day.audioSeconds += usage.audioMs / 1000
+    day.speechSeconds += speechSeconds
+    day.bytes += bytesUp + bytesDown
+    day.tokens += tokens
+    day.cpuMs += cpuMs
+    days.set(date, day)
+  }
+
+  return { days: [...days.values()].sort((a, b) => b.date.localeCompare(a.date)), totals }
+}
@@ -0,0 +1,118 @@
+import fs from 'fs'
+import path from 'path'
+import { startKeywordListening, stopKeywordListening, isKeywordListening } from './capture'
+import { toDbfs } from './capture-health'
+import { getNativeCapabilities } from './native'
+import { createLogger } from './logger'
+
+// Hands-free activation (opt-in)
+// The microphone stays open in the native module, where a small int8 keyword model
+// (native/cloudkit/src/kws.cc) runs on the capture thread - nothing reaches JS until it
+// fires. A detection starts the same dictation as the hotkey, with a short pre-roll so
+// words spoken right after the wake phrase are kept, and the dictation ends on the
+// hotkey, Escape or trailing silence (SilenceEndpointer)
+
+export const WAKE_WORD_MODEL_FILE = 'wake-word.kws'
+export const DEFAULT_WAKE_WORD_THRESHOLD = 0.8
+// Detection lags the end of the phrase by the posterior smoothing window
+export const WAKE_WORD_PREROLL_MS = 300
+
+const RETRY_DELAY_MS = 5000 // After the device fails while listening
+const ENDPOINT_SILENCE_MS = 1500
+const NO_SPEECH_TIMEOUT_MS = 5000 // Woken, but nothing said
+const SPEECH_MARGIN_DB = 10 // Over the running noise floor
+const SPEECH_MIN_DBFS = -50
+const NOISE_RISE_DB = 0.05 // Per level update (~1.5 dB/s), so speech can't become the floor
+
+export interface WakeWordConfig {
+  modelPath: string
+  threshold: number
+  onWake: (score: number) => void
+}
+
+const log = createLogger('WakeWord')
+
+let config: WakeWordConfig | null = null
+let retryTimer: NodeJS.Timeout | null = null
+
+/**
+ * The keyword model: the user's own in <userData>/models, else the bundled one
+ */
+export function findWakeWordModel(userDataPath: string, resourcesPath: string): string | null {
+  const candidates = [
+    path.join(userDataPath, 'models', WAKE_WORD_MODEL_FILE),
+    path.join(resourcesPath, WAKE_WORD_MODEL_FILE)
+  ]
+  return candidates.find((candidate) => fs.existsSync(candidate)) ?? null
+}
+
+export function isWakeWordSupported(): boolean {
+  const capabilities = getNativeCapabilities()
+  return capabilities.keyword && capabilities.capture.length > 0
+}
+
+const listen = (): void => {
+  if (!config) return
+  const backend = startKeywordListening({
+    modelPath: config.modelPath,
+    threshold: config.threshold,
+    onKeyword: (score) => {
+      log.info(() => `Wake phrase detected (score ${score.toFixed(2)})`)
+      config?.onWake(score)
+    },
+    onError: () => scheduleRetry()
+  })
+  if (!backend) scheduleRetry()
+}
+
+const scheduleRetry = (): void => {
+  if (retryTimer || !config) return
+  retryTimer = setTimeout(() => {
+    retryTimer = null
+    if (config && !isKeywordListening()) listen()
+  }, RETRY_DELAY_MS)
+}
+
+/**
+ * Start (or restart with new settings) listening for the wake phrase
+ */
+export function startWakeWord(options: WakeWordConfig): void {
+  config = options
+  listen()
+}
+
+export function stopWakeWord(): void {
+  config = null
+  if (retryTimer) clearTimeout(retryTimer)
+  retryTimer = null
+  stopKeywordListening()
+}
+
+/**
+ * Decides when a hands-free dictation is over, from the capture level updates
+ */
+export class SilenceEndpointer {
+  private readonly startedAt: number
+  private noiseDbfs: number | null = null
+  private heardSpeech = false
+  private lastSpeechAt = 0
+
+  constructor(startedAt = performance.now()) {
+    this.startedAt = startedAt
+  }
+
+  /**
+   * Feed one level (RMS in 0..1); true once the speaker has stopped
+   */
+  push(level: number, now = performance.now()): boolean {
+    const dbfs = toDbfs(level)
+    this.noiseDbfs =
+      this.noiseDbfs === null || dbfs < this.noiseDbfs ? dbfs : this.noiseDbfs + NOISE_RISE_DB
+    if (dbfs > Math.max(this.noiseDbfs + SPEECH_MARGIN_DB, SPEECH_MIN_DBFS)) {
+      this.heardSpeech = true
+      this.lastSpeechAt = now
+    }
+    if (!this.heardSpeech) return now - this.startedAt > NO_SPEECH_TIMEOUT_MS
+    return now - this.lastSpeechAt > ENDPOINT_SILENCE_MS
+  }
+}
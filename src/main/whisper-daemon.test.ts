@@ -0,0 +1,70 @@
+import { test, after } from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'fs'
+import os from 'os'
+import path from 'path'
+import { configureWhisperDaemon, stopDaemon, transcribeWithDaemon } from './whisper-daemon'
+import type { DaemonInput } from './whisper-daemon'
+
+// Drives the supervisor against test/fixtures/fake-whisper-cli.mjs
+const FAKE_DAEMON = path.join(process.cwd(), 'test', 'fixtures', 'fake-whisper-cli.mjs')
+
+const audioDirectory = fs.mkdtempSync(path.join(os.tmpdir(), 'wispr-daemon-test-'))
+const audioFile = (name: string): string => {
+  const file = path.join(audioDirectory, `${name}.wav`)
+  fs.writeFileSync(file, Buffer.alloc(44 + 3200))
+  return file
+}
+
+// A shared-memory input that counts how often its lease is released
+const pcmInput = (offset: number): { input: DaemonInput; releases: () => number } => {
+  let releases = 0
+  return {
+    input: {
+      pcm: { shm: '/wispr-pcm-test', offset, samples: 1600, sampleRate: 16000 },
+      release: () => releases++
+    },
+    releases: () => releases
+  }
+}
+
+after(() => {
+  stopDaemon()
+  fs.rmSync(audioDirectory, { recursive: true, force: true })
+})
+
+test('a daemon that fails to start releases the PCM lease', async () => {
+  configureWhisperDaemon({ resolveBinary: () => path.join(audioDirectory, 'missing-whisper-cli') })
+  const { input, releases } = pcmInput(0)
+
+  await assert.rejects(transcribeWithDaemon('base', input))
+  assert.equal(releases(), 1)
+})
+
+test('a duplicate job releases its own PCM lease and leaves the first one running', async () => {
+  configureWhisperDaemon({ resolveBinary: () => FAKE_DAEMON })
+  const first = pcmInput(64)
+  const duplicate = pcmInput(64)
+
+  // Start the daemon first, so the order the two jobs reach it is known
+  await transcribeWithDaemon('base', { audioFile: audioFile('warm-up') })
+  const running = transcribeWithDaemon('base', first.input)
+  await new Promise((resolve) => setTimeout(resolve, 50))
+  await assert.rejects(transcribeWithDaemon('base', duplicate.input), /already being transcribed/)
+  assert.equal(duplicate.releases(), 1)
+
+  assert.equal(await running, 'base:/wispr-pcm-test')
+  assert.equal(first.releases(), 1)
+})
+
+test('switching models waits for jobs in flight on the current one', async () => {
+  configureWhisperDaemon({ resolveBinary: () => FAKE_DAEMON })
+  const a = audioFile('a')
+  const b = audioFile('b')
+
+  const onBase = transcribeWithDaemon('base', { audioFile: a })
+  await new Promise((resolve) => setTimeout(resolve, 50))
+  const onSmall = transcribeWithDaemon('small', { audioFile: b })
+
+  assert.deepEqual(await Promise.all([onBase, onSmall]), [`base:${a}`, `small:${b}`])
+})
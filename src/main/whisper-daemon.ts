@@ -0,0 +1,602 @@
+import { spawn, execFile, ChildProcess } from 'child_process'
+import { promisify } from 'util'
+import fs from 'fs'
+import { createLogger, errorFields, redactTranscript } from './logger'
+import type { PcmDescriptor } from './pcm-slab'
+
+// Supervisor for the persistent WhisperKit daemon (`whisper-cli daemon <model>`)
+// - A daemon that dies after loading its model is restarted right away in the
+//   background (exponential backoff), and its in-flight jobs are replayed once
+// - RSS growth and real-time-factor drift are tracked per daemon; a daemon that
+//   degrades is recycled while idle by warming a replacement before retiring it
+// - A model switch waits until the current daemon has no jobs in flight, since those
+//   may belong to other clients of the engine service (engine-service.ts)
+// Runs in the pipeline utility process (see whisper-local.ts)
+
+const execFileAsync = promisify(execFile)
+
+const STARTUP_TIMEOUT_MS = 30000
+const JOB_TIMEOUT_MS = 120000
+const MAX_JOB_REPLAYS = 1 // A job that crashes the daemon twice is failed, not retried forever
+const RESTART_BASE_DELAY_MS = 500
+const RESTART_MAX_DELAY_MS = 30000
+const MAX_RESTART_ATTEMPTS = 6 // Then wait for the next dictation to start one
+const STABLE_RUN_MS = 60000 // A daemon that lived this long resets the backoff
+const HEALTH_CHECK_INTERVAL_MS = 30000
+const IDLE_BEFORE_RECYCLE_MS = 60000
+const RSS_GROWTH_LIMIT_MB = 512 // Over the RSS measured once the model was loaded
+const LATENCY_BASELINE_JOBS = 5 // Jobs after startup that define the baseline
+const LATENCY_WINDOW = 10 // Recent jobs compared against the baseline
+const LATENCY_DRIFT_RATIO = 1.5
+const WAV_BYTES_PER_SECOND = 32000 // 16kHz mono 16-bit, what whisper-local hands over
+
+const log = createLogger('WhisperDaemon')
+// Progress and stderr arrive many times per second while a model downloads
+const progressLog = log.sampled('download-progress', 1000)
+const stderrLog = log.sampled('stderr', 250)
+
+export interface DaemonConfig {
+  resolveBinary: () => string
+  onDownloadProgress?: (model: string, progress: number) => void
+  onDaemonPid?: (pid: number | null) => void // For the resource monitor
+}
+
+/**
+ * What a job transcribes: a 16kHz WAV file, or PCM in shared memory (see pcm-slab.ts).
+ * `release` runs once the daemon no longer needs the PCM - when it answers (even
+ * after the caller timed out) or exits
+ */
+export type DaemonInput = { audioFile: string } | { pcm: PcmDescriptor; release?: () => void }
+
+// Daemons that predate shared-memory input don't advertise this feature
+export class SharedPcmUnsupportedError extends Error {}
+
+interface DaemonMessage {
+  success: boolean
+  transcription?: string
+  model?: string
+  id?: string // Echoed job key
+  audioFile?: string
+  features?: string[]
+  error?: string
+  status?: string
+  progress?: number
+  downloadedBytes?: number
+  totalBytes?: number
+}
+
+interface Job {
+  key: string // Matches the daemon's answer to the job
+  input: DaemonInput
+  language?: string
+  audioSeconds: number
+  attempts: number
+  sentAt: number
+  timedOut: boolean // Caller gave up; kept until the daemon answers so its PCM isn't reused early
+  timer: NodeJS.Timeout
+  resolve: (text: string) => void
+  reject: (reason: Error) => void
+}
+
+interface Daemon {
+  model: string
+  process: ChildProcess
+  startedAt: number
+  ready: boolean
+  readyPromise: Promise<void>
+  jobs: Map<string, Job> // Keyed by Job.key
+  features: string[] // From the ready message
+  exited: boolean
+  intentional: boolean // Quit on purpose - no restart
+  rssAtReadyMB: number | null
+  // Milliseconds of processing per second of audio
+  baselineRtf: number[]
+  recentRtf: number[]
+  idleWaiters: (() => void)[] // Resolved once no jobs are in flight (see whenIdle)
+}
+
+let config: DaemonConfig = { resolveBinary: () => 'whisper-cli' }
+let active: Daemon | null = null
+let retiring: Daemon[] = [] // Replaced by a recycle, quit once their jobs drain
+let desiredModel: string | null = null // Model of the last daemon that loaded
+let orphanJobs: Job[] = [] // Waiting for a restarted daemon
+let restartAttempts = 0
+let restartTimer: NodeJS.Timeout | null = null
+let healthTimer: NodeJS.Timeout | null = null
+let warming: Daemon | null = null // Replacement being loaded by a recycle
+let lastJobAt = 0
+
+export function configureWhisperDaemon(options: DaemonConfig): void {
+  config = options
+}
+
+const median = (values: number[]): number => {
+  const sorted = [...values].sort((a, b) => a - b)
+  return sorted[Math.floor(sorted.length / 2)]
+}
+
+// RSS of another process: /proc on Linux, ps elsewhere (the daemon is macOS-only today)
+const readRssMB = async (pid: number): Promise<number | null> => {
+  try {
+    if (process.platform === 'linux') {
+      const status = await fs.promises.readFile(`/proc/${pid}/status`, 'utf-8')
+      return Number(/VmRSS:\s+(\d+)/.exec(status)?.[1] ?? 0) / 1024
+    }
+    const { stdout } = await execFileAsync('ps', ['-o', 'rss=', '-p', String(pid)])
+    return Number(stdout.trim()) / 1024 || null
+  } catch {
+    return null
+  }
+}
+
+const publishPid = (): void => {
+  config.onDaemonPid?.(active?.process.pid ?? null)
+}
+
+const releaseJob = (job: Job): void => {
+  if ('pcm' in job.input) job.input.release?.()
+}
+
+const whenIdle = (daemon: Daemon): Promise<void> =>
+  daemon.exited || daemon.jobs.size === 0
+    ? Promise.resolve()
+    : new Promise((resolve) => daemon.idleWaiters.push(resolve))
+
+const notifyIdle = (daemon: Daemon): void => {
+  const waiters = daemon.idleWaiters
+  daemon.idleWaiters = []
+  waiters.forEach((resolve) => resolve())
+}
+
+const sendJob = (daemon: Daemon, job: Job): void => {
+  job.sentAt = performance.now()
+  daemon.jobs.set(job.key, job)
+  const language = job.language || undefined
+  const request =
+    'pcm' in job.input
+      ? { id: job.key, ...job.input.pcm, language }
+      : { id: job.key, audioFile: job.input.audioFile, language }
+  daemon.process.stdin?.write(JSON.stringify(request) + '\n')
+}
+
+const finishJob = (daemon: Daemon, job: Job, message: DaemonMessage): void => {
+  daemon.jobs.delete(job.key)
+  clearTimeout(job.timer)
+  releaseJob(job)
+  lastJobAt = Date.now()
+
+  if (job.timedOut) {
+    // The caller already got a timeout error
+  } else if (!message.success || !message.transcription) {
+    job.reject(new Error(message.error || 'Transcription failed'))
+  } else {
+    const elapsed = performance.now() - job.sentAt
+    if (job.audioSeconds > 0) {
+      const rtf = elapsed / job.audioSeconds
+      if (daemon.baselineRtf.length < LATENCY_BASELINE_JOBS) {
+        daemon.baselineRtf.push(rtf)
+      } else {
+        daemon.recentRtf.push(rtf)
+        if (daemon.recentRtf.length > LATENCY_WINDOW) daemon.recentRtf.shift()
+      }
+    }
+    log.debug('Job finished', () => ({
+      ms: Math.round(elapsed),
+      audioSeconds: job.audioSeconds,
+      transcription: redactTranscript(message.transcription)
+    }))
+    job.resolve(message.transcription)
+  }
+
+  if (daemon.jobs.size === 0) {
+    // A retired daemon quits as soon as it has nothing left to do
+    if (retiring.includes(daemon)) quitDaemon(daemon)
+    notifyIdle(daemon)
+  }
+}
+
+const handleMessage = (
+  daemon: Daemon,
+  message: DaemonMessage,
+  markReady: () => void,
+  keepAlive: () => void
+): void => {
+  if (message.status === 'downloading') {
+    keepAlive()
+    // Model is downloading (first-time only) - forwarded to the renderer by the host
+    progressLog.info(() => `Downloading model: ${message.model} (${Math.round((message.progress || 0) * 100)}%)`)
+    config.onDownloadProgress?.(message.model || daemon.model, message.progress || 0)
+  } else if (message.status === 'loading') {
+    keepAlive() // Loading starts a fresh window once a download has finished
+    log.info(() => `Loading cached model: ${message.model}`)
+  } else if (message.status === 'ready') {
+    log.info('Model loaded and ready', () => ({ model: daemon.model, pid: daemon.process.pid }))
+    daemon.features = message.features ?? []
+    markReady()
+  } else {
+    // Older daemons echo only the audio file, which was the key back then
+    const job = daemon.jobs.get(message.id ?? message.audioFile ?? '')
+    if (job) finishJob(daemon, job, message)
+  }
+}
+
+const spawnDaemon = (model: string): Daemon => {
+  log.info(() => `Starting daemon with model: ${model}`)
+  const child = spawn(config.resolveBinary(), ['daemon', model])
+
+  let markReady: () => void = () => undefined
+  let failStartup: (error: Error) => void = () => undefined
+  const daemon: Daemon = {
+    model,
+    process: child,
+    startedAt: Date.now(),
+    ready: false,
+    readyPromise: new Promise<void>((resolve, reject) => {
+      markReady = resolve
+      failStartup = reject
+    }),
+    jobs: new Map(),
+    features: [],
+    exited: false,
+    intentional: false,
+    rssAtReadyMB: null,
+    baselineRtf: [],
+    recentRtf: [],
+    idleWaiters: []
+  }
+  // Background restarts and recycles may never await it
+  daemon.readyPromise.catch(() => undefined)
+
+  // The timeout measures silence, not total startup time: a first-time model download
+  // can take minutes, so every progress message restarts it. Only a daemon that has
+  // stopped reporting anything is given up on
+  let startupTimer: NodeJS.Timeout | null = null
+  const armStartupTimer = (): void => {
+    if (daemon.ready || daemon.exited) return
+    if (startupTimer) clearTimeout(startupTimer)
+    startupTimer = setTimeout(() => {
+      failStartup(new Error('Daemon startup timeout'))
+      quitDaemon(daemon)
+    }, STARTUP_TIMEOUT_MS)
+  }
+  armStartupTimer()
+
+  const onReady = (): void => {
+    if (startupTimer) clearTimeout(startupTimer)
+    daemon.ready = true
+    markReady()
+    readRssMB(child.pid!).then((rss) => {
+      daemon.rssAtReadyMB = rss
+    })
+  }
+
+  // stdout carries one JSON object per message (possibly split across chunks)
+  let jsonBuffer = ''
+  let braceCount = 0
+  child.stdout?.on('data', (data) => {
+    for (const char of data.toString()) {
+      jsonBuffer += char
+      if (char === '{') {
+        braceCount++
+      } else if (char === '}') {
+        braceCount--
+        if (braceCount === 0 && jsonBuffer.trim().length > 0) {
+          try {
+            handleMessage(daemon, JSON.parse(jsonBuffer.trim()), onReady, armStartupTimer)
+          } catch (e) {
+            log.error('JSON parse error', () => errorFields(e))
+            braceCount = 0
+          }
+          jsonBuffer = ''
+        }
+      }
+    }
+  })
+
+  child.stderr?.on('data', (data) => {
+    stderrLog.debug(() => data.toString().trim())
+  })
+
+  // Writes racing an exit fail with EPIPE - the exit handler deals with the jobs
+  child.stdin?.on('error', () => undefined)
+
+  const onGone = (code: number | null): void => {
+    if (startupTimer) clearTimeout(startupTimer)
+    failStartup(new Error('Daemon exited during startup')) // No-op once ready
+    handleExit(daemon, code)
+  }
+  // Spawn failures (missing binary) arrive as 'error' without an 'exit'
+  child.on('error', (error) => {
+    log.error('Daemon process error', () => errorFields(error))
+    onGone(null)
+  })
+  child.on('exit', onGone)
+
+  return daemon
+}
+
+const quitDaemon = (daemon: Daemon): void => {
+  if (daemon.exited) return
+  daemon.intentional = true
+  daemon.process.stdin?.write('quit\n')
+  daemon.process.kill()
+}
+
+const rejectJob = (job: Job, error: Error): void => {
+  clearTimeout(job.timer)
+  releaseJob(job)
+  if (!job.timedOut) job.reject(error)
+}
+
+const failOrphans = (error: Error): void => {
+  orphanJobs.forEach((job) => rejectJob(job, error))
+  orphanJobs = []
+}
+
+const handleExit = (daemon: Daemon, code: number | null): void => {
+  if (daemon.exited) return
+  daemon.exited = true
+  log.info(() => `Process exited with code ${code}`, () => ({ model: daemon.model, pid: daemon.process.pid }))
+
+  retiring = retiring.filter((d) => d !== daemon)
+  const wasActive = active === daemon
+  if (wasActive) {
+    active = null
+    publishPid()
+  }
+
+  // A serving daemon that died on its own is restarted and its jobs replayed;
+  // startup failures are handled by whoever started it (see startActive)
+  const crashed = wasActive && daemon.ready && !daemon.intentional && desiredModel === daemon.model
+  for (const job of daemon.jobs.values()) {
+    if (crashed && !job.timedOut && job.attempts < MAX_JOB_REPLAYS) {
+      job.attempts++
+      orphanJobs.push(job)
+    } else {
+      rejectJob(job, new Error('Daemon process exited unexpectedly'))
+    }
+  }
+  daemon.jobs.clear()
+  notifyIdle(daemon)
+
+  if (crashed) scheduleRestart(Date.now() - daemon.startedAt > STABLE_RUN_MS)
+}
+
+const scheduleRestart = (stable: boolean): void => {
+  if (stable) restartAttempts = 0
+  if (restartAttempts >= MAX_RESTART_ATTEMPTS) {
+    log.error('Daemon keeps failing, giving up until the next dictation')
+    failOrphans(new Error('Daemon process exited unexpectedly'))
+    stopHealthChecks()
+    restartAttempts = 0
+    return
+  }
+
+  const delay = Math.min(RESTART_BASE_DELAY_MS * 2 ** restartAttempts, RESTART_MAX_DELAY_MS)
+  restartAttempts++
+  log.warn(() => `Restarting daemon in ${delay}ms`, () => ({ replaying: orphanJobs.length }))
+  if (restartTimer) clearTimeout(restartTimer)
+  restartTimer = setTimeout(() => {
+    restartTimer = null
+    if (active || !desiredModel) return
+    startActive(desiredModel).catch(() => {
+      // startActive already scheduled the next attempt
+    })
+  }, delay)
+}
+
+/**
+ * Make a daemon for `model` the active one and wait until it can take jobs
+ * Orphaned jobs from a crashed daemon are replayed once it is ready
+ */
+const startActive = async (model: string): Promise<Daemon> => {
+  if (restartTimer) {
+    clearTimeout(restartTimer)
+    restartTimer = null
+  }
+  const daemon = spawnDaemon(model)
+  active = daemon
+  publishPid()
+
+  try {
+    await daemon.readyPromise
+  } catch (error) {
+    if (active === daemon) {
+      active = null
+      publishPid()
+    }
+    // Keep retrying in the background only for the model that was already serving
+    if (desiredModel === model) {
+      scheduleRestart(false)
+    } else {
+      failOrphans(error as Error)
+    }
+    throw error
+  }
+
+  desiredModel = model
+  startHealthChecks()
+
+  const replay = orphanJobs
+  orphanJobs = []
+  if (replay.length > 0) log.info(() => `Replaying ${replay.length} in-flight job(s)`)
+  replay.forEach((job) => sendJob(daemon, job))
+  return daemon
+}
+
+/**
+ * A ready daemon for `model`, starting or switching as needed
+ */
+const ensureDaemon = async (model: string): Promise<Daemon> => {
+  for (;;) {
+    const current = active
+    if (current && current.model === model) {
+      if (!current.ready) await current.readyPromise
+      return current
+    }
+    // A user waiting on a dictation doesn't sit out a restart backoff
+    if (!current) return startActive(model)
+
+    // Quitting now would fail whatever the current daemon is doing for other
+    // callers - switch once it has started and drained, then look again
+    if (!current.ready || current.jobs.size > 0) {
+      log.debug(() => `Waiting for ${current.model} to go idle before switching to ${model}`)
+      await current.readyPromise.catch(() => undefined)
+      await whenIdle(current)
+      continue
+    }
+
+    log.info(() => `Switching from ${current.model} to ${model}`)
+    quitDaemon(current)
+    active = null
+    return startActive(model)
+  }
+}
+
+const latencyDrift = (daemon: Daemon): number | null => {
+  if (daemon.baselineRtf.length < LATENCY_BASELINE_JOBS || daemon.recentRtf.length < LATENCY_WINDOW) {
+    return null
+  }
+  return median(daemon.recentRtf) / median(daemon.baselineRtf)
+}
+
+const checkHealth = async (): Promise<void> => {
+  const daemon = active
+  if (!daemon || !daemon.ready || warming) return
+
+  const rss = await readRssMB(daemon.process.pid!)
+  const growth = rss !== null && daemon.rssAtReadyMB !== null ? rss - daemon.rssAtReadyMB : 0
+  const drift = latencyDrift(daemon)
+  log.debug('Health', () => ({ pid: daemon.process.pid, rssMB: rss, growthMB: growth, latencyDrift: drift }))
+
+  const idle = daemon.jobs.size === 0 && Date.now() - lastJobAt >= IDLE_BEFORE_RECYCLE_MS
+  if (!idle) return
+
+  if (growth > RSS_GROWTH_LIMIT_MB) {
+    recycle(daemon, `RSS grew ${Math.round(growth)}MB since load`)
+  } else if (drift !== null && drift > LATENCY_DRIFT_RATIO) {
+    recycle(daemon, `latency drifted to ${drift.toFixed(2)}x baseline`)
+  }
+}
+
+/**
+ * Replace a degraded daemon without a cold window: the old one keeps serving until
+ * the replacement has loaded the model
+ */
+const recycle = async (daemon: Daemon, reason: string): Promise<void> => {
+  log.info(() => `Recycling daemon: ${reason}`, () => ({ pid: daemon.process.pid }))
+  try {
+    const fresh = spawnDaemon(daemon.model)
+    warming = fresh
+    await fresh.readyPromise
+
+    if (active !== daemon) {
+      // Model switched or daemon died meanwhile - the replacement is not needed
+      quitDaemon(fresh)
+      return
+    }
+    active = fresh
+    publishPid()
+    if (daemon.jobs.size === 0) {
+      quitDaemon(daemon)
+    } else {
+      retiring.push(daemon)
+    }
+  } catch (error) {
+    log.warn('Recycle failed, keeping the current daemon', () => errorFields(error))
+  } finally {
+    warming = null
+  }
+}
+
+const startHealthChecks = (): void => {
+  if (healthTimer) return
+  healthTimer = setInterval(() => {
+    checkHealth().catch((error) => log.error('Health check failed', () => errorFields(error)))
+  }, HEALTH_CHECK_INTERVAL_MS)
+  healthTimer.unref()
+}
+
+const stopHealthChecks = (): void => {
+  if (healthTimer) clearInterval(healthTimer)
+  healthTimer = null
+}
+
+/**
+ * Transcribe a 16kHz WAV file with the daemon for `model`
+ */
+export async function transcribeWithDaemon(
+  model: string,
+  input: DaemonInput,
+  language?: string
+): Promise<string> {
+  let daemon: Daemon
+  let key: string
+  let audioSeconds: number
+  try {
+    daemon = await ensureDaemon(model)
+    if ('pcm' in input) {
+      if (!daemon.features.includes('pcm-shm')) {
+        throw new SharedPcmUnsupportedError('Daemon does not accept shared-memory PCM')
+      }
+      key = `${input.pcm.shm}@${input.pcm.offset}`
+      audioSeconds = input.pcm.samples / input.pcm.sampleRate
+    } else {
+      key = input.audioFile
+      audioSeconds = Math.max(0, (fs.statSync(input.audioFile).size - 44) / WAV_BYTES_PER_SECOND)
+    }
+    // Results are matched by key, so one file can't be in flight twice
+    if (daemon.jobs.has(key) || orphanJobs.some((job) => job.key === key)) {
+      throw new Error('Audio is already being transcribed')
+    }
+  } catch (error) {
+    // Never became a job, so nothing else will release the PCM
+    if ('pcm' in input) input.release?.()
+    throw error
+  }
+
+  return new Promise<string>((resolve, reject) => {
+    const job: Job = {
+      key,
+      input,
+      language,
+      audioSeconds,
+      attempts: 0,
+      sentAt: 0,
+      timedOut: false,
+      resolve,
+      reject,
+      timer: setTimeout(() => {
+        job.timedOut = true
+        reject(new Error('Transcription timeout'))
+        // Not sent anywhere yet: nothing else will release it
+        if (orphanJobs.includes(job)) {
+          orphanJobs = orphanJobs.filter((j) => j !== job)
+          releaseJob(job)
+        }
+      }, JOB_TIMEOUT_MS)
+    }
+    sendJob(daemon, job)
+  })
+}
+
+/**
+ * Stop every daemon without restarting (worker shutdown)
+ */
+export function stopDaemon(): void {
+  desiredModel = null
+  stopHealthChecks()
+  if (restartTimer) clearTimeout(restartTimer)
+  restartTimer = null
+  failOrphans(new Error('Daemon stopped'))
+
+  for (const daemon of [active, warming, ...retiring]) {
+    if (daemon) {
+      log.info('Stopping daemon')
+      quitDaemon(daemon)
+    }
+  }
+  active = null
+  retiring = []
+  publishPid()
+}
@@ -1,20 +1,49 @@
-import { exec, spawn, ChildProcess } from 'child_process'
+import { exec } from 'child_process'
 import { promisify } from 'util'
 import path from 'path'
-import { app } from 'electron'
 import fs from 'fs'
+import os from 'os'
 import readline from 'readline'
+import { decodeWebmOpus, encodeWav, resamplePcm } from './native'
+import { createLogger, errorFields } from './logger'
+import {
+  configureWhisperDaemon,
+  transcribeWithDaemon,
+  SharedPcmUnsupportedError
+} from './whisper-daemon'
+import type { DaemonInput } from './whisper-daemon'
+import { transcribeViaEngine, EngineUnavailableError } from './engine-client'
+import { leasePcm } from './pcm-slab'
+
+export { stopDaemon } from './whisper-daemon'
 
 const execAsync = promisify(exec)
+const log = createLogger('WhisperLocal')
 
-// Persistent daemon process
-let daemonProcess: ChildProcess | null = null
-let daemonReady = false
-let currentModel: string | null = null
-let pendingRequests: Map<string, {
-  resolve: (value: string) => void
-  reject: (reason: any) => void
-}> = new Map()
+/**
+ * Host-provided configuration (this module runs in the pipeline utility process,
+ * which has no access to Electron's `app`)
+ */
+export interface WhisperLocalConfig {
+  isPackaged: boolean
+  resourcesPath: string
+  onDownloadProgress?: (model: string, progress: number) => void
+  onDaemonPid?: (pid: number | null) => void // For the resource monitor
+}
+
+let config: WhisperLocalConfig = {
+  isPackaged: false,
+  resourcesPath: process.resourcesPath
+}
+
+export function configureWhisperLocal(options: WhisperLocalConfig): void {
+  config = options
+  configureWhisperDaemon({
+    resolveBinary: getWhisperCLIPath,
+    onDownloadProgress: options.onDownloadProgress,
+    onDaemonPid: options.onDaemonPid
+  })
+}
 
 /**
  * Get path to the whisper-cli executable
@@ -22,9 +51,9 @@ let pendingRequests: Map<string, {
  * In production: use the bundled binary from app resources
  */
 function getWhisperCLIPath(): string {
-  if (app.isPackaged) {
+  if (config.isPackaged) {
     // Production: bundled with app
-    return path.join(process.resourcesPath, 'whisper-cli')
+    return path.join(config.resourcesPath, 'whisper-cli')
   } else {
     // Development: use the built binary
     const devPath = path.join(process.cwd(), 'swift-whisper', '.build', 'arm64-apple-macosx', 'release', 'whisper-cli')
@@ -42,160 +71,89 @@ function getWhisperCLIPath(): string {
 export interface LocalTranscriptionOptions {
   modelName?: string
   language?: string
-}
-
-export interface TranscriptionResult {
-  success: boolean
-  transcription?: string
-  model?: string
-  audioFile?: string
-  error?: string
-  status?: string
-  progress?: number
-  downloadedBytes?: number
-  totalBytes?: number
+  sharedEngine?: boolean // Use the per-user engine service (engine-service.ts)
 }
 
 /**
- * Start the WhisperKit daemon process with a specific model
- * This keeps the model loaded in memory for fast subsequent transcriptions
+ * Transcribe with the shared engine service, or the in-process daemon when the
+ * service can't be reached
  */
-async function startDaemon(modelName: string): Promise<void> {
-  if (daemonProcess && currentModel === modelName && daemonReady) {
-    console.log(`[WhisperDaemon] Already running with model: ${modelName}`)
-    return
-  }
-
-  // Stop existing daemon if different model
-  if (daemonProcess && currentModel !== modelName) {
-    console.log(`[WhisperDaemon] Switching from ${currentModel} to ${modelName}`)
-    stopDaemon()
+async function transcribeShared(modelName: string, input: DaemonInput, language?: string): Promise<string> {
+  let handedToDaemon = false
+  try {
+    return await transcribeViaEngine(modelName, input, language)
+  } catch (error) {
+    if (!(error instanceof EngineUnavailableError)) throw error
+    log.warn('Shared engine unavailable, using the in-process daemon', () => errorFields(error))
+    handedToDaemon = true // The daemon releases the PCM lease itself
+    return transcribeWithDaemon(modelName, input, language)
+  } finally {
+    if (!handedToDaemon && 'pcm' in input) input.release?.()
   }
+}
 
-  console.log(`[WhisperDaemon] Starting daemon with model: ${modelName}`)
-  const whisperBinary = getWhisperCLIPath()
-
-  daemonProcess = spawn(whisperBinary, ['daemon', modelName])
-  currentModel = modelName
-  daemonReady = false
-
-  // Handle stdout (JSON responses)
-  let jsonBuffer = ''
-  let braceCount = 0
-
-  daemonProcess.stdout?.on('data', (data) => {
-    const chunk = data.toString()
-
-    for (const char of chunk) {
-      jsonBuffer += char
-
-      if (char === '{') {
-        braceCount++
-      } else if (char === '}') {
-        braceCount--
-
-        // Complete JSON object received
-        if (braceCount === 0 && jsonBuffer.trim().length > 0) {
-          try {
-            const result: TranscriptionResult = JSON.parse(jsonBuffer.trim())
-            jsonBuffer = '' // Reset buffer
-
-            console.log('[WhisperDaemon] Received:', JSON.stringify(result))
-
-            if (result.status === 'downloading') {
-              // Model is downloading (first-time only) - emit to renderer
-              const progressPercent = Math.round((result.progress || 0) * 100)
-              console.log(`[WhisperDaemon] Downloading model: ${result.model} (${progressPercent}%)`)
-
-              // Emit download progress event to renderer
-              const mainWindow = (global as any).getMainWindow?.()
-              if (mainWindow) {
-                mainWindow.webContents.send('model-download-progress', {
-                  model: result.model,
-                  progress: result.progress || 0,
-                  isLoading: true
-                })
-              }
-            } else if (result.status === 'loading') {
-              // Model is loading from cache - just log, don't show UI
-              console.log(`[WhisperDaemon] Loading cached model: ${result.model}`)
-            } else if (result.status === 'ready') {
-              // Model loaded - just set ready flag, don't show UI
-              console.log('[WhisperDaemon] Model loaded and ready!')
-              daemonReady = true
-            } else if (result.audioFile && pendingRequests.has(result.audioFile)) {
-              const request = pendingRequests.get(result.audioFile)!
-              pendingRequests.delete(result.audioFile)
-
-              if (result.success && result.transcription) {
-                request.resolve(result.transcription)
-              } else {
-                request.reject(new Error(result.error || 'Transcription failed'))
-              }
-            }
-          } catch (e) {
-            console.error('[WhisperDaemon] JSON parse error:', e)
-            jsonBuffer = '' // Reset on error
-            braceCount = 0
-          }
-        }
-      }
-    }
-  })
-
-  // Handle stderr (logs)
-  daemonProcess.stderr?.on('data', (data) => {
-    console.log('[WhisperDaemon]', data.toString().trim())
-  })
-
-  // Handle process exit
-  daemonProcess.on('exit', (code) => {
-    console.log(`[WhisperDaemon] Process exited with code ${code}`)
-    daemonProcess = null
-    daemonReady = false
-    currentModel = null
-
-    // Reject all pending requests
-    for (const [audioFile, request] of pendingRequests) {
-      request.reject(new Error('Daemon process exited unexpectedly'))
-    }
-    pendingRequests.clear()
-  })
-
-  // Wait for ready signal
-  await new Promise<void>((resolve, reject) => {
-    const timeout = setTimeout(() => {
-      reject(new Error('Daemon startup timeout'))
-    }, 30000)
-
-    const checkReady = setInterval(() => {
-      if (daemonReady) {
-        clearTimeout(timeout)
-        clearInterval(checkReady)
-        resolve()
-      }
-    }, 100)
-  })
+const transcribeInput = (
+  modelName: string,
+  input: DaemonInput,
+  language: string | undefined,
+  sharedEngine: boolean
+): Promise<string> => {
+  // The supervisor starts (or reuses) the daemon for this model; a daemon that
+  // crashes mid-job is restarted and the job replayed
+  return sharedEngine
+    ? transcribeShared(modelName, input, language)
+    : transcribeWithDaemon(modelName, input, language)
 }
 
 /**
- * Stop the WhisperKit daemon process
+ * Transcribe mono PCM already in memory
+ * The samples go to the daemon through shared memory, so no WAV file is written;
+ * falls back to a temp file when shared memory is unavailable, full, or the
+ * daemon predates it
  */
-function stopDaemon(): void {
-  if (daemonProcess) {
-    console.log('[WhisperDaemon] Stopping daemon...')
-    daemonProcess.stdin?.write('quit\n')
-    daemonProcess.kill()
-    daemonProcess = null
-    daemonReady = false
-    currentModel = null
+export async function transcribeLocalPcm(
+  samples: Int16Array,
+  sampleRate: number,
+  options: LocalTranscriptionOptions = {}
+): Promise<string> {
+  const { modelName = 'base', language, sharedEngine = false } = options
+  const pcm = sampleRate === 16000 ? samples : resamplePcm(samples, sampleRate, 16000)
+  const transcriptionStart = performance.now()
+
+  const lease = leasePcm(pcm, 16000)
+  if (lease) {
+    try {
+      const transcription = await transcribeInput(
+        modelName,
+        { pcm: lease.descriptor, release: lease.release },
+        language,
+        sharedEngine
+      )
+      log.info('Transcription successful', () => ({
+        transport: 'shm',
+        samples: pcm.length,
+        ms: Math.round(performance.now() - transcriptionStart)
+      }))
+      return transcription
+    } catch (error) {
+      if (!(error instanceof SharedPcmUnsupportedError)) throw error
+      log.info('Daemon cannot read shared memory, using a WAV file')
+    }
   }
-}
 
-// Cleanup on app quit
-app.on('will-quit', () => {
-  stopDaemon()
-})
+  const wavPath = path.join(os.tmpdir(), `wispr_pcm_${process.pid}_${Date.now()}.wav`)
+  fs.writeFileSync(wavPath, encodeWav(pcm, 16000))
+  try {
+    const transcription = await transcribeInput(modelName, { audioFile: wavPath }, language, sharedEngine)
+    log.info('Transcription successful', () => ({
+      transport: 'file',
+      ms: Math.round(performance.now() - transcriptionStart)
+    }))
+    return transcription
+  } finally {
+    fs.promises.unlink(wavPath).catch(() => undefined)
+  }
+}
 
 /**
  * Transcribe audio file using local WhisperKit (with persistent daemon for speed)
@@ -206,85 +164,73 @@ export async function transcribeLocal(
 ): Promise<string> {
   const {
     modelName = 'base',
-    language
+    language,
+    sharedEngine = false
   } = options
 
-  console.log('━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━')
-  console.log('[WhisperLocal] 🎯 STARTING LOCAL TRANSCRIPTION')
-  console.log('[WhisperLocal] Model:', modelName)
-  console.log('[WhisperLocal] Language:', language || 'auto-detect')
-  console.log('[WhisperLocal] Audio file:', audioFilePath)
-  console.log('[WhisperLocal] File exists:', fs.existsSync(audioFilePath))
-  console.log('━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━')
+  log.info('Starting local transcription', () => ({
+    model: modelName,
+    language: language || 'auto-detect',
+    audioFile: audioFilePath
+  }))
 
   // Verify audio file exists
   if (!fs.existsSync(audioFilePath)) {
     const error = `Audio file not found: ${audioFilePath}`
-    console.error('[WhisperLocal] ❌ ERROR:', error)
+    log.error(error)
     throw new Error(error)
   }
 
   try {
-    // Convert WebM to WAV format (WhisperKit needs AVFoundation-compatible format)
-    console.log('[WhisperLocal] Converting WebM to WAV for WhisperKit compatibility...')
-    console.time('[WhisperLocal] ⏱️  Audio Conversion Time')
     const wavPath = audioFilePath.replace('.webm', '.wav')
-
-    try {
-      // Use ffmpeg to convert WebM to WAV (16kHz mono, 16-bit PCM)
-      await execAsync(
-        `ffmpeg -i "${audioFilePath}" -ar 16000 -ac 1 -sample_fmt s16 "${wavPath}" -y`,
-        { timeout: 30000 }
-      )
-      console.timeEnd('[WhisperLocal] ⏱️  Audio Conversion Time')
-      console.log('[WhisperLocal] Audio converted to WAV successfully')
-    } catch (convError) {
-      console.timeEnd('[WhisperLocal] ⏱️  Audio Conversion Time')
-      console.error('[WhisperLocal] Audio conversion failed:', convError)
-      throw new Error('Failed to convert audio to compatible format. Make sure ffmpeg is installed.')
+    // Main-process capture already hands over 16kHz WAV
+    const needsConversion = wavPath !== audioFilePath
+
+    if (needsConversion) {
+      // Convert WebM to WAV format (WhisperKit needs AVFoundation-compatible format)
+      const conversionStart = performance.now()
+
+      // Decode in-process with the native module when available, otherwise ffmpeg
+      let pcm: Int16Array | null
+      try {
+        pcm = await decodeWebmOpus(fs.readFileSync(audioFilePath), 16000)
+        if (!pcm) {
+          // Use ffmpeg to convert WebM to WAV (16kHz mono, 16-bit PCM)
+          await execAsync(
+            `ffmpeg -i "${audioFilePath}" -ar 16000 -ac 1 -sample_fmt s16 "${wavPath}" -y`,
+            { timeout: 30000 }
+          )
+        }
+        log.info('Audio converted', () => ({
+          decoder: pcm ? 'native' : 'ffmpeg',
+          ms: Math.round(performance.now() - conversionStart)
+        }))
+      } catch (convError) {
+        log.error('Audio conversion failed', () => errorFields(convError))
+        throw new Error('Failed to convert audio to compatible format. Make sure ffmpeg is installed.')
+      }
+      // Natively decoded PCM never touches disk
+      if (pcm) return await transcribeLocalPcm(pcm, 16000, options)
     }
 
-    // Ensure daemon is running with correct model
-    console.time('[WhisperLocal] ⏱️  Daemon Startup Time')
-    await startDaemon(modelName)
-    console.timeEnd('[WhisperLocal] ⏱️  Daemon Startup Time')
-
-    // Send transcription request to daemon
-    console.time('[WhisperLocal] ⏱️  WhisperKit Transcription Time')
-    const transcription = await new Promise<string>((resolve, reject) => {
-      pendingRequests.set(wavPath, { resolve, reject })
-
-      const request = JSON.stringify({
-        audioFile: wavPath,
-        language: language || undefined
-      })
-
-      daemonProcess?.stdin?.write(request + '\n')
-
-      // Timeout after 120 seconds
-      setTimeout(() => {
-        if (pendingRequests.has(wavPath)) {
-          pendingRequests.delete(wavPath)
-          reject(new Error('Transcription timeout'))
-        }
-      }, 120000)
-    })
-    console.timeEnd('[WhisperLocal] ⏱️  WhisperKit Transcription Time')
+    const transcriptionStart = performance.now()
+    const transcription = await transcribeInput(modelName, { audioFile: wavPath }, language, sharedEngine)
 
-    // Clean up the WAV file
+    // Clean up the WAV file (the caller owns the input file)
     try {
-      if (fs.existsSync(wavPath)) {
+      if (needsConversion && fs.existsSync(wavPath)) {
         fs.unlinkSync(wavPath)
-        console.log('[WhisperLocal] Cleaned up temporary WAV file')
       }
     } catch (cleanupError) {
-      console.warn('[WhisperLocal] Failed to clean up WAV file:', cleanupError)
+      log.warn('Failed to clean up WAV file', () => errorFields(cleanupError))
     }
 
-    console.log('[WhisperLocal] Transcription successful')
+    log.info('Transcription successful', () => ({
+      ms: Math.round(performance.now() - transcriptionStart)
+    }))
     return transcription
   } catch (error) {
-    console.error('[WhisperLocal] Transcription failed:', error)
+    log.error('Transcription failed', () => errorFields(error))
 
     // Provide helpful error messages
     if (error instanceof Error) {
@@ -320,7 +266,7 @@ export async function listAvailableModels(): Promise<string[]> {
 
     return []
   } catch (error) {
-    console.error('[WhisperLocal] Failed to list models:', error)
+    log.error('Failed to list models', () => errorFields(error))
     return []
   }
 }
@@ -0,0 +1,204 @@
+import { app, BrowserWindow } from 'electron'
+import { join } from 'path'
+import { is } from '@electron-toolkit/utils'
+import { createLogger } from './logger'
+
+// Settings and Examples windows from a pool of one prewarmed hidden renderer
+// The spare window loads index.html at idle after startup (the '#/prewarm' route
+// renders nothing but fetches the view chunks), so opening a window is a hash
+// navigation and a show instead of a process launch and a bundle load. Closing
+// hides the window and parks it as the spare again, back on the prewarm route so its
+// views unmount and drop their subscriptions. A spare that sits unused for too long,
+// or whose renderer has grown past the memory cap, is destroyed instead of kept
+
+export type PooledWindowKind = 'settings' | 'examples'
+
+const PREWARM_ROUTE = 'prewarm'
+const SPARE_IDLE_TEARDOWN_MS = 10 * 60 * 1000
+const SPARE_MEMORY_CAP_MB = 200 // Working set past which a hidden renderer isn't worth keeping
+
+interface KindOptions {
+  title: string
+  width: number
+  height: number
+  resizable: boolean
+}
+
+const KIND_OPTIONS: Record<PooledWindowKind, KindOptions> = {
+  settings: { title: 'Settings', width: 1000, height: 700, resizable: true },
+  examples: { title: 'Custom Instruction Examples', width: 500, height: 600, resizable: false }
+}
+
+interface PooledWindow {
+  window: BrowserWindow
+  loaded: boolean // index.html has finished loading - hash navigation works
+  kind: PooledWindowKind | null // null while it is the spare
+}
+
+const log = createLogger('WindowPool')
+
+let preloadPath = ''
+let onHidden: ((kind: PooledWindowKind) => void) | null = null
+let spare: PooledWindow | null = null
+let spareIdleTimer: NodeJS.Timeout | null = null
+const active: Map<PooledWindowKind, PooledWindow> = new Map()
+let quitting = false
+
+const loadRoute = (window: BrowserWindow, route: string): void => {
+  if (is.dev && process.env['ELECTRON_RENDERER_URL']) {
+    window.loadURL(`${process.env['ELECTRON_RENDERER_URL']}#/${route}`)
+  } else {
+    window.loadFile(join(__dirname, '../renderer/index.html'), { hash: route })
+  }
+}
+
+// Hash navigation inside an already loaded renderer (App.tsx listens for it)
+const navigate = (pooled: PooledWindow, route: string): void => {
+  if (pooled.loaded) pooled.window.webContents.send('navigate', `#/${route}`)
+  else loadRoute(pooled.window, route)
+}
+
+const createPooledWindow = (route: string): PooledWindow => {
+  const window = new BrowserWindow({
+    width: KIND_OPTIONS.settings.width,
+    height: KIND_OPTIONS.settings.height,
+    show: false,
+    autoHideMenuBar: true,
+    webPreferences: {
+      preload: preloadPath,
+      sandbox: false
+    }
+  })
+  const pooled: PooledWindow = { window, loaded: false, kind: null }
+
+  window.webContents.on('did-finish-load', () => {
+    pooled.loaded = true
+  })
+  // Hide and recycle instead of closing, except when the app is quitting
+  window.on('close', (event) => {
+    if (quitting) return
+    event.preventDefault()
+    recycle(pooled)
+  })
+  window.on('closed', () => {
+    if (spare === pooled) spare = null
+    if (pooled.kind && active.get(pooled.kind) === pooled) {
+      active.delete(pooled.kind)
+      onHidden?.(pooled.kind)
+    }
+  })
+
+  loadRoute(window, route)
+  return pooled
+}
+
+const clearSpareIdleTimer = (): void => {
+  if (spareIdleTimer) clearTimeout(spareIdleTimer)
+  spareIdleTimer = null
+}
+
+const destroySpare = (reason: string): void => {
+  clearSpareIdleTimer()
+  if (!spare) return
+  log.info(() => `Destroying the spare window: ${reason}`)
+  const window = spare.window
+  spare = null
+  if (!window.isDestroyed()) window.destroy()
+}
+
+const workingSetMB = (window: BrowserWindow): number => {
+  const pid = window.webContents.getOSProcessId()
+  const metric = app.getAppMetrics().find((candidate) => candidate.pid === pid)
+  return metric ? metric.memory.workingSetSize / 1024 : 0
+}
+
+const recycle = (pooled: PooledWindow): void => {
+  const kind = pooled.kind
+  pooled.window.hide()
+  if (kind && active.get(kind) === pooled) {
+    active.delete(kind)
+    pooled.kind = null
+    onHidden?.(kind)
+  }
+
+  // One spare is enough; a renderer that has grown large is cheaper to start again
+  const memoryMB = workingSetMB(pooled.window)
+  if (spare || memoryMB > SPARE_MEMORY_CAP_MB) {
+    log.info(() => `Closing a hidden window (${Math.round(memoryMB)} MB)`)
+    pooled.window.destroy()
+    if (!spare) setImmediate(prewarmWindow)
+    return
+  }
+
+  navigate(pooled, PREWARM_ROUTE)
+  spare = pooled
+  clearSpareIdleTimer()
+  spareIdleTimer = setTimeout(() => destroySpare('idle'), SPARE_IDLE_TEARDOWN_MS)
+  spareIdleTimer.unref()
+}
+
+export function configureWindowPool(options: {
+  preloadPath: string
+  onHidden?: (kind: PooledWindowKind) => void
+}): void {
+  preloadPath = options.preloadPath
+  onHidden = options.onHidden ?? null
+  app.on('before-quit', () => {
+    quitting = true
+    clearSpareIdleTimer()
+  })
+}
+
+/**
+ * Create the hidden spare if there isn't one (called at idle after startup)
+ */
+export function prewarmWindow(): void {
+  if (spare || quitting) return
+  spare = createPooledWindow(PREWARM_ROUTE)
+  clearSpareIdleTimer()
+  spareIdleTimer = setTimeout(() => destroySpare('idle'), SPARE_IDLE_TEARDOWN_MS)
+  spareIdleTimer.unref()
+}
+
+/**
+ * Show the window for kind at route (e.g. 'settings/shortcuts'), reusing the spare
+ */
+export function showPooledWindow(kind: PooledWindowKind, route: string): BrowserWindow {
+  const open = active.get(kind)
+  if (open && !open.window.isDestroyed()) {
+    navigate(open, route)
+    open.window.focus()
+    return open.window
+  }
+
+  clearSpareIdleTimer()
+  const warm = spare !== null && !spare.window.isDestroyed()
+  const pooled = warm ? spare! : createPooledWindow(route)
+  spare = null
+  pooled.kind = kind
+  active.set(kind, pooled)
+
+  const options = KIND_OPTIONS[kind]
+  const window = pooled.window
+  window.setTitle(options.title)
+  window.setResizable(options.resizable)
+  window.setSize(options.width, options.height)
+  window.center()
+
+  if (warm) {
+    navigate(pooled, route)
+    window.show()
+  } else {
+    // Cold start - show once there is something to paint, to prevent flicker
+    window.once('ready-to-show', () => {
+      if (pooled.kind === kind) window.show()
+    })
+  }
+  log.debug(() => `Showing ${kind} (${warm ? 'prewarmed' : 'cold'})`)
+  return window
+}
+
+export function getPooledWindow(kind: PooledWindowKind): BrowserWindow | null {
+  const pooled = active.get(kind)
+  return pooled && !pooled.window.isDestroyed() ? pooled.window : null
+}
@@ -1,11 +1,105 @@
 import { ElectronAPI } from '@electron-toolkit/preload'
 
+// Store subscription payloads (mirrors src/main/history.ts, notes.ts, dictionary-matcher.ts,
+// resource-monitor.ts, capture-health.ts, subscriptions.ts)
+export interface HistoryItem {
+  id: string
+  text: string
+  timestamp: number
+  duration: number
+  wpm: number
+  words?: number
+}
+
+export interface Stats {
+  totalWords: number
+  weeklyWords: number
+  averageWpm: number
+}
+
+export interface NoteItem {
+  id: string
+  content: string
+  timestamp: number
+}
+
+export type HistoryChange = { op: 'add'; item: HistoryItem } | { op: 'delete'; id: string }
+
+export type NotesChange =
+  | { op: 'add'; item: NoteItem }
+  | { op: 'update'; item: NoteItem }
+  | { op: 'delete'; id: string }
+
+export interface DictionaryEntry {
+  key: string
+  term: string
+  replacement: string
+}
+
+export type DictionaryChange =
+  | { op: 'upsert'; entries: DictionaryEntry[] }
+  | { op: 'delete'; keys: string[] }
+  | { op: 'reset'; entries: DictionaryEntry[] }
+
+export interface ResourceSample {
+  timestamp: number
+  processes: { pid: number; type: string; name: string; rssMB: number; cpuPercent: number }[]
+  mainHeapUsedMB: number
+  eventLoopDelayMs: { p50: number; p99: number; max: number }
+  gc: { count: number; totalMs: number; maxMs: number }
+}
+
+// One utterance's capture health (src/main/capture-health.ts)
+export interface CaptureHealthRecord {
+  timestamp: number
+  source: 'pulse' | 'alsa' | 'renderer'
+  startLatencyMs: number | null
+  durationMs: number
+  chunks: number
+  droppedChunks: number
+  discontinuities: number
+  longestGapMs: number
+  overruns: number | null
+  sampleDeficitMs: number | null
+  peakDbfs: number
+  rmsDbfs: number
+  clippedRatio: number
+}
+
+export interface SettingsChange {
+  key: string
+  value: unknown
+}
+
+export interface StoreTypes {
+  history: { snapshot: HistoryItem[]; delta: HistoryChange }
+  notes: { snapshot: NoteItem[]; delta: NotesChange }
+  stats: { snapshot: Stats; delta: Stats }
+  settings: { snapshot: Record<string, any>; delta: SettingsChange }
+  dictionary: { snapshot: DictionaryEntry[]; delta: DictionaryChange }
+  diagnostics: { snapshot: ResourceSample[]; delta: ResourceSample }
+  'capture-health': { snapshot: CaptureHealthRecord[]; delta: CaptureHealthRecord }
+}
+
+export type StoreTopic = keyof StoreTypes
+
+export interface StoreAPI {
+  subscribe: <T extends StoreTopic>(
+    topic: T,
+    onDelta: (delta: StoreTypes[T]['delta'], seq: number) => void
+  ) => Promise<{ id: number; seq: number; snapshot: StoreTypes[T]['snapshot'] }>
+  snapshot: <T extends StoreTopic>(
+    topic: T
+  ) => Promise<{ seq: number; snapshot: StoreTypes[T]['snapshot'] }>
+  unsubscribe: (id: number) => void
+}
+
 declare global {
   interface Window {
     electron: ElectronAPI & {
       exportEncryptionKey: () => Promise<{ success: boolean; key?: string; error?: string }>
       importEncryptionKey: (key: string) => Promise<{ success: boolean; error?: string }>
     }
-    api: unknown
+    api: StoreAPI
   }
 }
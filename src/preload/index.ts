@@ -1,8 +1,60 @@
 import { contextBridge, ipcRenderer } from 'electron'
 import { electronAPI } from '@electron-toolkit/preload'
 
+// Store subscriptions: listeners per topic, multiplexed over one 'store-delta' channel
+type StoreTopic =
+  | 'history'
+  | 'notes'
+  | 'stats'
+  | 'settings'
+  | 'dictionary'
+  | 'diagnostics'
+  | 'capture-health'
+type DeltaListener = (delta: unknown, seq: number) => void
+const storeListeners: Map<number, { topic: StoreTopic; onDelta: DeltaListener }> = new Map()
+let nextSubscriptionId = 1
+
+ipcRenderer.on('store-delta', (_, topic: StoreTopic, seq: number, delta: unknown) => {
+  for (const listener of storeListeners.values()) {
+    if (listener.topic === topic) listener.onDelta(delta, seq)
+  }
+})
+
 // Custom APIs for renderer
-const api = {}
+const api = {
+  /**
+   * Subscribe to a store. Resolves with the current snapshot and its sequence
+   * number; `onDelta` then receives every change with its own sequence number.
+   * Returns an id for `unsubscribe`.
+   */
+  subscribe: async (
+    topic: StoreTopic,
+    onDelta: DeltaListener
+  ): Promise<{ id: number; seq: number; snapshot: unknown }> => {
+    const id = nextSubscriptionId++
+    storeListeners.set(id, { topic, onDelta })
+    const { seq, data } = await ipcRenderer.invoke('store-subscribe', topic)
+    return { id, seq, snapshot: data }
+  },
+  /**
+   * Fetch a fresh snapshot without resubscribing (used to resync after a gap)
+   */
+  snapshot: async (topic: StoreTopic): Promise<{ seq: number; snapshot: unknown }> => {
+    const { seq, data } = await ipcRenderer.invoke('store-snapshot', topic)
+    return { seq, snapshot: data }
+  },
+  unsubscribe: (id: number): void => {
+    const listener = storeListeners.get(id)
+    if (!listener) return
+    storeListeners.delete(id)
+
+    // Tell main once the last listener for this topic in this window is gone
+    const stillListening = [...storeListeners.values()].some((l) => l.topic === listener.topic)
+    if (!stillListening) {
+      ipcRenderer.send('store-unsubscribe', listener.topic)
+    }
+  }
+}
 
 // Encryption key management APIs
 const encryptionAPI = {
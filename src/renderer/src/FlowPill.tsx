@@ -0,0 +1,419 @@
+import { useEffect, useState, useRef } from 'react'
+
+import ModelDownloadProgress from './components/ModelDownloadProgress'
+import { useStoreSubscription } from './hooks/useStoreSubscription'
+
+// The always-on-top flow pill (its own renderer entry, pill.html)
+// Resident all day, so it only bundles what the pill shows: recording, the
+// visualizer and model download progress. Settings and examples live in index.html
+
+const RECORDER_TIMESLICE_MS = 250 // Chunk cadence; late chunks show up as discontinuities
+const STATS_FFT_SIZE = 2048 // Time-domain window for level and clipping statistics
+
+// MediaStreamTrack.stats (Chromium): frames the track produced vs. delivered
+interface AudioTrackStats {
+  deliveredFramesDuration: number
+  totalFramesDuration: number
+}
+
+// Per-utterance capture statistics sent with 'audio-data' (src/main/capture-health.ts)
+interface RecordingHealth {
+  hotkeyAt: number | null // Wall-clock hotkey time from 'window-shown'
+  startedAt: number | null
+  lastTimecode: number | null
+  chunks: number
+  discontinuities: number
+  longestGapMs: number
+  peak: number
+  sumSquares: number
+  samples: number
+  clipped: number
+}
+
+const newRecordingHealth = (hotkeyAt: number | null): RecordingHealth => ({
+  hotkeyAt,
+  startedAt: null,
+  lastTimecode: null,
+  chunks: 0,
+  discontinuities: 0,
+  longestGapMs: 0,
+  peak: 0,
+  sumSquares: 0,
+  samples: 0,
+  clipped: 0
+})
+
+const toDbfs = (level: number): number =>
+  level > 0 ? Math.max(-120, Math.round(20 * Math.log10(level) * 10) / 10) : -120
+
+function FlowPill(): React.JSX.Element {
+  const [isListening, setIsListening] = useState(false)
+  const [isProcessing, setIsProcessing] = useState(false)
+  const [audioData, setAudioData] = useState<number[]>(new Array(24).fill(2)) // 24 bars
+  const mediaRecorderRef = useRef<MediaRecorder | null>(null)
+  const chunksRef = useRef<BlobPart[]>([])
+  const audioContextRef = useRef<AudioContext | null>(null)
+  const analyserRef = useRef<AnalyserNode | null>(null)
+  const sourceRef = useRef<MediaStreamAudioSourceNode | null>(null)
+  const animationFrameRef = useRef<number | null>(null)
+  const healthRef = useRef<RecordingHealth>(newRecordingHealth(null))
+
+  // New state for the waiting pill and hint
+  const [showHint, setShowHint] = useState(false)
+  const [hotkey, setHotkey] = useState('CommandOrControl+Shift+Space') // Default value
+
+  // Recording Logic extracted from useEffect
+  const startRecording = async (hotkeyAt: number | null = null): Promise<void> => {
+    try {
+      const health = newRecordingHealth(hotkeyAt)
+      healthRef.current = health
+      const stream = await navigator.mediaDevices.getUserMedia({ audio: true })
+
+      // Setup Audio Context for Visualizer
+      const audioContext = new AudioContext()
+      const analyser = audioContext.createAnalyser()
+      analyser.fftSize = 128
+      analyser.smoothingTimeConstant = 0.8
+      const source = audioContext.createMediaStreamSource(stream)
+      source.connect(analyser)
+
+      // Levels and clipping come from a wider time-domain window, sampled per frame
+      const statsAnalyser = audioContext.createAnalyser()
+      statsAnalyser.fftSize = STATS_FFT_SIZE
+      source.connect(statsAnalyser)
+      const timeDomain = new Float32Array(STATS_FFT_SIZE)
+      let statsTime = audioContext.currentTime
+
+      audioContextRef.current = audioContext
+      analyserRef.current = analyser
+      sourceRef.current = source
+
+      // Start Visualizer Loop
+      const updateVisualizer = (): void => {
+        const dataArray = new Uint8Array(analyser.frequencyBinCount)
+        analyser.getByteFrequencyData(dataArray)
+
+        const bars: number[] = []
+        const step = Math.floor(dataArray.length / 24)
+
+        for (let i = 0; i < 12; i++) {
+          const value = dataArray[i * step + 2]
+          bars.push(Math.max(2, (value / 255) * 12))
+        }
+
+        const mirroredBars = [...bars.slice().reverse(), ...bars]
+        setAudioData(mirroredBars)
+
+        // Windows of consecutive frames overlap - only the samples that arrived since the
+        // last frame (the tail of the window) are counted
+        statsAnalyser.getFloatTimeDomainData(timeDomain)
+        const now = audioContext.currentTime
+        const fresh = Math.min(timeDomain.length, Math.round((now - statsTime) * audioContext.sampleRate))
+        statsTime = now
+        for (let i = timeDomain.length - fresh; i < timeDomain.length; i++) {
+          const magnitude = Math.abs(timeDomain[i])
+          if (magnitude > health.peak) health.peak = magnitude
+          if (magnitude >= 0.999) health.clipped++
+          health.sumSquares += timeDomain[i] * timeDomain[i]
+        }
+        health.samples += fresh
+
+        animationFrameRef.current = requestAnimationFrame(updateVisualizer)
+      }
+      updateVisualizer()
+
+      // Setup MediaRecorder
+      const mediaRecorder = new MediaRecorder(stream)
+      mediaRecorderRef.current = mediaRecorder
+      chunksRef.current = []
+
+      mediaRecorder.onstart = (): void => {
+        health.startedAt = Date.now()
+      }
+
+      mediaRecorder.ondataavailable = (e): void => {
+        if (e.data.size > 0) chunksRef.current.push(e.data)
+        health.chunks++
+        if (health.lastTimecode !== null) {
+          const gap = e.timecode - health.lastTimecode
+          if (gap > RECORDER_TIMESLICE_MS * 2) health.discontinuities++
+          health.longestGapMs = Math.max(health.longestGapMs, gap)
+        }
+        health.lastTimecode = e.timecode
+      }
+
+      mediaRecorder.onstop = async (): Promise<void> => {
+        console.time('Total Latency')
+        console.log('[Performance] Recording stopped at:', new Date().toISOString())
+
+        const blob = new Blob(chunksRef.current, { type: 'audio/webm' })
+        const buffer = await blob.arrayBuffer()
+
+        // Frames the track produced but never delivered were lost before the recorder
+        const trackStats = (stream.getAudioTracks()[0] as MediaStreamTrack & { stats?: AudioTrackStats })
+          ?.stats
+        const durationMs = health.startedAt !== null ? Date.now() - health.startedAt : 0
+        const captureHealth = {
+          startLatencyMs:
+            health.hotkeyAt !== null && health.startedAt !== null
+              ? Math.max(0, health.startedAt - health.hotkeyAt)
+              : null,
+          durationMs,
+          chunks: health.chunks,
+          droppedChunks: 0,
+          discontinuities: health.discontinuities,
+          longestGapMs: Math.round(health.longestGapMs),
+          overruns: null,
+          sampleDeficitMs: trackStats
+            ? Math.max(0, Math.round(trackStats.totalFramesDuration - trackStats.deliveredFramesDuration))
+            : null,
+          peakDbfs: toDbfs(health.peak),
+          rmsDbfs: toDbfs(Math.sqrt(health.sumSquares / Math.max(1, health.samples))),
+          clippedRatio: health.samples > 0 ? health.clipped / health.samples : 0
+        }
+
+        console.log('[Performance] Sending audio to main process...')
+        window.electron.ipcRenderer.send('audio-data', buffer, captureHealth)
+      }
+
+      mediaRecorder.start(RECORDER_TIMESLICE_MS)
+      setIsListening(true)
+      setIsProcessing(false)
+    } catch (err) {
+      console.error('Error accessing microphone:', err)
+    }
+  }
+
+  const stopRecording = (trailingMs = 100): void => {
+    // Delay stopping to capture trailing audio after key release
+    setTimeout(() => {
+      if (mediaRecorderRef.current && mediaRecorderRef.current.state !== 'inactive') {
+        mediaRecorderRef.current.stop()
+        mediaRecorderRef.current.stream.getTracks().forEach((track) => track.stop())
+      }
+
+      // Cleanup Audio Context
+      if (animationFrameRef.current) cancelAnimationFrame(animationFrameRef.current)
+      if (audioContextRef.current) audioContextRef.current.close()
+    }, trailingMs) // Reduced delay for speed; main shortens it further under load
+  }
+
+  // Keep the hint's hotkey in sync with settings
+  useStoreSubscription<Record<string, any>, { key: string; value: unknown }>('settings', {
+    onSnapshot: (settings) => {
+      if (settings.hotkey) setHotkey(settings.hotkey)
+    },
+    onDelta: ({ key, value }) => {
+      if (key === 'hotkey' && typeof value === 'string') setHotkey(value)
+    }
+  })
+
+  // Register IPC listeners once on mount - they should always be active
+  useEffect(() => {
+    const onShow = (_: unknown, hotkeyAt?: number): void => {
+      console.log('[IPC] window-shown received')
+      startRecording(hotkeyAt ?? null)
+    }
+
+    const onHide = (_: unknown, trailingMs?: number | null): void => {
+      console.log('[IPC] window-hidden received')
+      // Key released or stop requested -> Switch to processing state
+      setIsListening(false)
+      setIsProcessing(true)
+      stopRecording(trailingMs ?? undefined)
+    }
+
+    // Main-process capture: the microphone is already open, just show the listening pill
+    const onCaptureStarted = (): void => {
+      console.log('[IPC] capture-started received')
+      setIsListening(true)
+      setIsProcessing(false)
+    }
+
+    // Levels from main-process capture drive the visualizer (no analyser in this path)
+    const onCaptureLevel = (_: unknown, level: number): void => {
+      const bars: number[] = []
+      for (let i = 0; i < 12; i++) {
+        const falloff = 1 - i / 14 // Taller bars towards the centre
+        bars.push(Math.max(2, Math.min(12, level * 48 * falloff)))
+      }
+      setAudioData([...bars.slice().reverse(), ...bars])
+    }
+
+    const onReset = (): void => {
+      console.log('[IPC] reset-ui received')
+      // Processing complete -> Reset to idle state
+      setIsListening(false)
+      setIsProcessing(false)
+    }
+
+    window.electron.ipcRenderer.on('window-shown', onShow)
+    window.electron.ipcRenderer.on('window-hidden', onHide)
+    window.electron.ipcRenderer.on('reset-ui', onReset)
+    window.electron.ipcRenderer.on('capture-started', onCaptureStarted)
+    window.electron.ipcRenderer.on('capture-level', onCaptureLevel)
+
+    // Signal to main process that renderer is ready
+    console.log('[Renderer] IPC listeners registered, ready to receive events')
+
+    return (): void => {
+      window.electron.ipcRenderer.removeAllListeners('window-shown')
+      window.electron.ipcRenderer.removeAllListeners('window-hidden')
+      window.electron.ipcRenderer.removeAllListeners('reset-ui')
+      window.electron.ipcRenderer.removeAllListeners('capture-started')
+      window.electron.ipcRenderer.removeAllListeners('capture-level')
+    }
+  }, []) // Empty dependency array - register once on mount
+
+  // Sync recording state with Main for toggle logic
+  useEffect(() => {
+    window.electron.ipcRenderer.send('recording-state-changed', isListening)
+  }, [isListening])
+
+  // Pill size/position and click-through
+  useEffect(() => {
+    window.electron.ipcRenderer.send('set-window-mode', 'flow')
+  }, [])
+
+  // Interactive Area Handlers (Click-through logic)
+  const ignoreMouseEvents = useRef(true) // Track current state
+  const containerRef = useRef<HTMLDivElement>(null)
+
+  useEffect(() => {
+    const handleMouseMove = (e: MouseEvent) => {
+      // Safety check
+      if (!containerRef.current) return
+
+      // Check if mouse is over the pill container
+      const isOver = containerRef.current.contains(e.target as Node)
+
+      if (isOver) {
+        // We are hovering the pill
+        if (ignoreMouseEvents.current) {
+          ignoreMouseEvents.current = false
+          window.electron.ipcRenderer.send('set-ignore-mouse-events', false)
+        }
+      } else {
+        // We are outside the pill
+        if (!ignoreMouseEvents.current) {
+          ignoreMouseEvents.current = true
+          window.electron.ipcRenderer.send('set-ignore-mouse-events', true, { forward: true })
+        }
+      }
+    }
+
+    window.addEventListener('mousemove', handleMouseMove)
+    return () => window.removeEventListener('mousemove', handleMouseMove)
+  }, [])
+
+  const handleCancel = (): void => {
+    setIsListening(false)
+    setIsProcessing(false)
+    if (mediaRecorderRef.current) {
+      chunksRef.current = [] // Clear chunks to prevent processing
+      mediaRecorderRef.current.stop()
+      mediaRecorderRef.current.stream.getTracks().forEach((track) => track.stop())
+    }
+    window.electron.ipcRenderer.send('hide-window')
+  }
+
+  const formatHotkeyForDisplay = (key: string): string => {
+    try {
+      const isMac = navigator.platform.toUpperCase().indexOf('MAC') >= 0
+      if (isMac) {
+        return key.replace('CommandOrControl', '⌘').replace('Shift', '⇧').replace('Space', 'Space')
+      }
+      return key.replace('CommandOrControl', 'Ctrl')
+    } catch (e) {
+      return key
+    }
+  }
+
+  return (
+    <>
+      <ModelDownloadProgress />
+      <div className="h-screen w-screen flex items-end justify-center pb-2 bg-transparent select-none overflow-hidden">
+        <div className="relative" ref={containerRef}>
+        {(isListening || isProcessing) ? (
+          // Active recording/processing pill
+          <div
+            className={`flex items-center gap-3 px-4 py-2 bg-black/90 backdrop-blur-xl rounded-full border border-zinc-800 shadow-2xl min-w-[200px] justify-between transition-all duration-300 pointer-events-auto ${isProcessing ? 'scale-105 border-blue-500/50' : ''}`}
+          >
+            {/* Close Button */}
+            <button
+              onClick={handleCancel}
+              className="w-6 h-6 flex items-center justify-center rounded-full bg-zinc-800 hover:bg-zinc-700 transition-colors group"
+            >
+              <svg
+                width="12"
+                height="12"
+                viewBox="0 0 24 24"
+                fill="none"
+                stroke="currentColor"
+                strokeWidth="3"
+                strokeLinecap="round"
+                strokeLinejoin="round"
+                className="text-zinc-400 group-hover:text-white"
+              >
+                <line x1="18" y1="6" x2="6" y2="18"></line>
+                <line x1="6" y1="6" x2="18" y2="18"></line>
+              </svg>
+            </button>
+
+            {/* Visualizer / Processing State */}
+            <div className="flex items-end gap-[2px] h-5 justify-center flex-1 mx-2 pb-1">
+              {isProcessing ? (
+                // Processing Animation (Indeterminate Wave)
+                <div className="flex gap-1 items-center h-full">
+                  {[...Array(5)].map((_, i) => (
+                    <div
+                      key={i}
+                      className="w-1 bg-blue-500 rounded-full animate-pulse"
+                      style={{ height: '12px', animationDelay: `${i * 0.1}s` }}
+                    ></div>
+                  ))}
+                </div>
+              ) : (
+                // Audio Visualizer
+                audioData.map((height, i) => (
+                  <div
+                    key={i}
+                    className="w-1 bg-white rounded-full transition-all duration-75 ease-out"
+                    style={{ height: `${height}px` }}
+                  ></div>
+                ))
+              )}
+            </div>
+
+            {/* Status Indicator (Wrapped for centering) */}
+            <div className="w-6 h-6 flex items-center justify-center">
+              <div
+                className={`w-2 h-2 rounded-full ${isProcessing ? 'bg-blue-500 animate-ping' : isListening ? 'bg-red-500 animate-pulse' : 'bg-zinc-600'}`}
+              ></div>
+            </div>
+          </div>
+        ) : (
+          // Waiting for recording pill
+          <div
+            className="relative pointer-events-auto"
+            onMouseEnter={() => setShowHint(true)}
+            onMouseLeave={() => setShowHint(false)}
+            onClick={() => startRecording()}
+          >
+            {showHint && (
+              <div className="absolute -top-14 left-1/2 -translate-x-1/2 bg-black/90 backdrop-blur-md text-zinc-100 text-sm font-medium px-4 py-2 rounded-full shadow-xl whitespace-nowrap border border-zinc-800 animate-in fade-in slide-in-from-bottom-2 duration-200">
+                Click or hold <span className="text-white font-bold mx-1">{formatHotkeyForDisplay(hotkey || 'Super+M')}</span> to start dictating
+              </div>
+            )}
+            <div className="w-20 h-6 bg-black/40 hover:bg-black/60 border border-zinc-700/50 hover:border-zinc-500 rounded-full flex items-center justify-center transition-all duration-300 cursor-pointer backdrop-blur-sm">
+              <div className="w-1.5 h-1.5 bg-zinc-400 rounded-full animate-pulse" />
+            </div>
+          </div>
+        )}
+      </div>
+    </div>
+    </>
+  )
+}
+
+export default FlowPill
\ No newline at end of file
@@ -1,10 +1,12 @@
-import React, { useState } from 'react'
+import React, { Suspense, lazy, useEffect, useState } from 'react'
 import { Sidebar } from './Sidebar'
-import HistoryView from './HistoryView'
-import StyleView from './StyleView'
-import DictionaryView from './DictionaryView'
-import SettingsView from './SettingsView'
-import NotesView from './NotesView'
+
+// Each tab is its own chunk, fetched the first time it's opened
+const HistoryView = lazy(() => import('./HistoryView'))
+const StyleView = lazy(() => import('./StyleView'))
+const DictionaryView = lazy(() => import('./DictionaryView'))
+const SettingsView = lazy(() => import('./SettingsView'))
+const NotesView = lazy(() => import('./NotesView'))
 
 // Helper to get initial view from hash (e.g., #/settings/shortcuts -> 'settings')
 const getInitialTab = (): string => {
@@ -19,6 +21,13 @@ const getInitialTab = (): string => {
 function Dashboard(): React.JSX.Element {
   const [activeView, setActiveView] = useState(getInitialTab)
 
+  // The window is reused (window-pool.ts), so a tab route can arrive while mounted
+  useEffect(() => {
+    const onHashChange = (): void => setActiveView(getInitialTab())
+    window.addEventListener('hashchange', onHashChange)
+    return (): void => window.removeEventListener('hashchange', onHashChange)
+  }, [])
+
   const renderContent = () => {
     switch (activeView) {
       case 'home':
@@ -62,7 +71,7 @@ function Dashboard(): React.JSX.Element {
   return (
     <div className="flex h-screen w-screen bg-white font-sans text-zinc-900 select-none overflow-hidden">
       <Sidebar activeView={activeView} onNavigate={setActiveView} />
-      {renderContent()}
+      <Suspense fallback={<div className="flex-1 bg-white" />}>{renderContent()}</Suspense>
     </div>
   )
 }
@@ -0,0 +1,259 @@
+import React, { useEffect, useState } from 'react'
+import { useStoreSubscription } from '../hooks/useStoreSubscription'
+
+interface ProcessSample {
+  pid: number
+  type: string
+  name: string
+  rssMB: number
+  cpuPercent: number
+}
+
+interface ResourceSample {
+  timestamp: number
+  processes: ProcessSample[]
+  mainHeapUsedMB: number
+  eventLoopDelayMs: { p50: number; p99: number; max: number }
+  gc: { count: number; totalMs: number; maxMs: number }
+}
+
+// Aggregated per-dictation usage records (src/main/usage.ts)
+interface UsageTotals {
+  dictations: number
+  audioSeconds: number
+  speechSeconds: number
+  bytesUp: number
+  bytesDown: number
+  promptTokens: number
+  completionTokens: number
+  cpuMs: number
+  engineCpuMs: number
+  peakEngineMB: number
+}
+
+// Per-utterance capture health (src/main/capture-health.ts)
+interface CaptureHealthRecord {
+  timestamp: number
+  source: string
+  startLatencyMs: number | null
+  durationMs: number
+  droppedChunks: number
+  discontinuities: number
+  longestGapMs: number
+  overruns: number | null
+  sampleDeficitMs: number | null
+  peakDbfs: number
+  rmsDbfs: number
+  clippedRatio: number
+}
+
+const CAPTURE_ROWS = 8
+const CHART_SAMPLES = 120 // Ten minutes at the monitor's 5s interval
+const CHART_WIDTH = 240
+const CHART_HEIGHT = 40
+
+const totalRss = (sample: ResourceSample): number =>
+  sample.processes.reduce((sum, p) => sum + p.rssMB, 0)
+
+// Total RSS over time, so growth is visible at a glance
+function RssSparkline({ samples }: { samples: ResourceSample[] }): React.JSX.Element | null {
+  if (samples.length < 2) return null
+  const values = samples.map(totalRss)
+  const max = Math.max(...values)
+  const min = Math.min(...values)
+  const range = Math.max(1, max - min)
+  const points = values
+    .map((value, i) => {
+      const x = (i / (values.length - 1)) * CHART_WIDTH
+      const y = CHART_HEIGHT - ((value - min) / range) * CHART_HEIGHT
+      return `${x.toFixed(1)},${y.toFixed(1)}`
+    })
+    .join(' ')
+
+  return (
+    <div className="flex items-center gap-3">
+      <svg width={CHART_WIDTH} height={CHART_HEIGHT} className="bg-zinc-50 rounded">
+        <polyline points={points} fill="none" stroke="#7c3aed" strokeWidth="1.5" />
+      </svg>
+      <div className="text-xs text-zinc-500">
+        {min.toFixed(0)}-{max.toFixed(0)} MB total
+      </div>
+    </div>
+  )
+}
+
+function DiagnosticsPanel(): React.JSX.Element {
+  const [samples, setSamples] = useState<ResourceSample[]>([])
+  const [exportMessage, setExportMessage] = useState<string | null>(null)
+  const [usage, setUsage] = useState<UsageTotals | null>(null)
+  const [captures, setCaptures] = useState<CaptureHealthRecord[]>([])
+
+  useEffect(() => {
+    window.electron.ipcRenderer
+      .invoke('get-usage-summary')
+      .then((summary: { totals: UsageTotals }) => setUsage(summary.totals))
+  }, [])
+
+  useStoreSubscription<ResourceSample[], ResourceSample>('diagnostics', {
+    onSnapshot: (snapshot) => setSamples(snapshot.slice(-CHART_SAMPLES)),
+    onDelta: (sample) => setSamples((prev) => [...prev, sample].slice(-CHART_SAMPLES))
+  })
+
+  useStoreSubscription<CaptureHealthRecord[], CaptureHealthRecord>('capture-health', {
+    onSnapshot: (snapshot) => setCaptures(snapshot.slice(-CAPTURE_ROWS)),
+    onDelta: (record) => setCaptures((prev) => [...prev, record].slice(-CAPTURE_ROWS))
+  })
+
+  const handleExport = async (): Promise<void> => {
+    const result = await window.electron.ipcRenderer.invoke('diagnostics-export')
+    if (result.success) {
+      setExportMessage(`Exported to ${result.filePath}`)
+    } else if (result.error) {
+      setExportMessage(`Export failed: ${result.error}`)
+    }
+  }
+
+  const latest = samples[samples.length - 1]
+
+  return (
+    <div className="space-y-4">
+      {!latest ? (
+        <p className="text-sm text-zinc-500">Collecting the first sample...</p>
+      ) : (
+        <>
+          <div className="grid grid-cols-3 gap-3 text-sm">
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">Event loop delay (p50 / p99 / max)</div>
+              <div className="font-medium text-zinc-900">
+                {latest.eventLoopDelayMs.p50} / {latest.eventLoopDelayMs.p99} /{' '}
+                {latest.eventLoopDelayMs.max} ms
+              </div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">GC pauses (count / total / max)</div>
+              <div className="font-medium text-zinc-900">
+                {latest.gc.count} / {latest.gc.totalMs} / {latest.gc.maxMs} ms
+              </div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">Main JS heap</div>
+              <div className="font-medium text-zinc-900">{latest.mainHeapUsedMB} MB</div>
+            </div>
+          </div>
+
+          <RssSparkline samples={samples} />
+
+          <table className="w-full text-sm">
+            <thead>
+              <tr className="text-left text-xs text-zinc-500 border-b border-zinc-100">
+                <th className="py-1.5 font-medium">Process</th>
+                <th className="py-1.5 font-medium">PID</th>
+                <th className="py-1.5 font-medium text-right">Memory</th>
+                <th className="py-1.5 font-medium text-right">CPU</th>
+              </tr>
+            </thead>
+            <tbody>
+              {latest.processes.map((p) => (
+                <tr key={p.pid} className="border-b border-zinc-50 text-zinc-800">
+                  <td className="py-1.5">{p.name}</td>
+                  <td className="py-1.5 text-zinc-500">{p.pid}</td>
+                  <td className="py-1.5 text-right">{p.rssMB.toFixed(0)} MB</td>
+                  <td className="py-1.5 text-right">{p.cpuPercent.toFixed(1)}%</td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        </>
+      )}
+
+      {usage && usage.dictations > 0 && (
+        <div className="space-y-2">
+          <div className="text-xs font-medium text-zinc-500">
+            Usage of the {usage.dictations} dictations in history
+          </div>
+          <div className="grid grid-cols-3 gap-3 text-sm">
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">Audio (speech)</div>
+              <div className="font-medium text-zinc-900">
+                {(usage.audioSeconds / 60).toFixed(1)} ({(usage.speechSeconds / 60).toFixed(1)}) min
+              </div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">Uploaded / downloaded</div>
+              <div className="font-medium text-zinc-900">
+                {(usage.bytesUp / 1048576).toFixed(1)} / {(usage.bytesDown / 1048576).toFixed(2)} MB
+              </div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">LLM tokens (prompt / completion)</div>
+              <div className="font-medium text-zinc-900">
+                {usage.promptTokens} / {usage.completionTokens}
+              </div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">CPU (pipeline + engine)</div>
+              <div className="font-medium text-zinc-900">{(usage.cpuMs / 1000).toFixed(1)} s</div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">Engine CPU</div>
+              <div className="font-medium text-zinc-900">{(usage.engineCpuMs / 1000).toFixed(1)} s</div>
+            </div>
+            <div className="p-3 bg-zinc-50 rounded-lg">
+              <div className="text-xs text-zinc-500">Peak engine memory</div>
+              <div className="font-medium text-zinc-900">{usage.peakEngineMB} MB</div>
+            </div>
+          </div>
+        </div>
+      )}
+
+      {captures.length > 0 && (
+        <div className="space-y-2">
+          <div className="text-xs font-medium text-zinc-500">Capture health of recent dictations</div>
+          <table className="w-full text-sm">
+            <thead>
+              <tr className="text-left text-xs text-zinc-500 border-b border-zinc-100">
+                <th className="py-1.5 font-medium">Source</th>
+                <th className="py-1.5 font-medium text-right">Start</th>
+                <th className="py-1.5 font-medium text-right">Gaps (longest)</th>
+                <th className="py-1.5 font-medium text-right">Lost (events / ms)</th>
+                <th className="py-1.5 font-medium text-right">Peak / RMS</th>
+                <th className="py-1.5 font-medium text-right">Clipped</th>
+              </tr>
+            </thead>
+            <tbody>
+              {[...captures].reverse().map((c) => (
+                <tr key={c.timestamp} className="border-b border-zinc-50 text-zinc-800">
+                  <td className="py-1.5">{c.source}</td>
+                  <td className="py-1.5 text-right">
+                    {c.startLatencyMs === null ? '-' : `${c.startLatencyMs} ms`}
+                  </td>
+                  <td className="py-1.5 text-right">
+                    {c.discontinuities} ({c.longestGapMs} ms)
+                  </td>
+                  <td className="py-1.5 text-right">
+                    {c.droppedChunks + (c.overruns ?? 0)} / {c.sampleDeficitMs ?? '-'} ms
+                  </td>
+                  <td className="py-1.5 text-right">
+                    {c.peakDbfs} / {c.rmsDbfs} dB
+                  </td>
+                  <td className="py-1.5 text-right">{(c.clippedRatio * 100).toFixed(2)}%</td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        </div>
+      )}
+
+      <button
+        onClick={handleExport}
+        disabled={samples.length === 0}
+        className="py-2 px-4 bg-zinc-600 hover:bg-zinc-700 disabled:bg-zinc-300 text-white font-medium rounded-lg transition-colors text-sm"
+      >
+        Export Time Series
+      </button>
+      {exportMessage && <p className="text-xs text-zinc-500">{exportMessage}</p>}
+    </div>
+  )
+}
+
+export default DiagnosticsPanel
@@ -1,23 +1,67 @@
-import React, { useEffect, useState } from 'react'
+import React, { useMemo, useState } from 'react'
+import { useStoreSubscription } from '../hooks/useStoreSubscription'
 
 interface DictionaryEntry {
-  id: string
+  key: string // Normalized term
   term: string
   replacement: string
 }
 
+type DictionaryChange =
+  | { op: 'upsert'; entries: DictionaryEntry[] }
+  | { op: 'delete'; keys: string[] }
+  | { op: 'reset'; entries: DictionaryEntry[] }
+
+// Large imported glossaries are searched rather than rendered in full
+const MAX_VISIBLE_ENTRIES = 200
+
 function DictionaryView(): React.JSX.Element {
   const [customInstructions, setCustomInstructions] = useState('')
-  const [dictionaryEntries, setDictionaryEntries] = useState<DictionaryEntry[]>([])
+  const [dictionary, setDictionary] = useState<Map<string, DictionaryEntry>>(new Map())
   const [newTerm, setNewTerm] = useState('')
   const [newReplacement, setNewReplacement] = useState('')
+  const [searchQuery, setSearchQuery] = useState('')
+  const [importStatus, setImportStatus] = useState<string | null>(null)
+  const [isImporting, setIsImporting] = useState(false)
 
-  useEffect(() => {
-    window.electron.ipcRenderer.invoke('get-settings').then((settings) => {
+  // Only the snapshot matters here - this view is the sole writer of these keys
+  useStoreSubscription<Record<string, any>, { key: string; value: unknown }>('settings', {
+    onSnapshot: (settings) => {
       if (settings.customInstructions) setCustomInstructions(settings.customInstructions)
-      if (settings.dictionaryEntries) setDictionaryEntries(settings.dictionaryEntries)
-    })
-  }, [])
+    },
+    onDelta: () => {}
+  })
+
+  useStoreSubscription<DictionaryEntry[], DictionaryChange>('dictionary', {
+    onSnapshot: (entries) => setDictionary(new Map(entries.map((e) => [e.key, e]))),
+    onDelta: (change) => {
+      setDictionary((prev) => {
+        const next = change.op === 'reset' ? new Map() : new Map(prev)
+        if (change.op === 'delete') {
+          change.keys.forEach((key) => next.delete(key))
+        } else {
+          change.entries.forEach((entry) => next.set(entry.key, entry))
+        }
+        return next
+      })
+    }
+  })
+
+  const visibleEntries = useMemo(() => {
+    const query = searchQuery.trim().toLowerCase()
+    const visible: DictionaryEntry[] = []
+    for (const entry of dictionary.values()) {
+      if (
+        !query ||
+        entry.key.includes(query) ||
+        entry.replacement.toLowerCase().includes(query)
+      ) {
+        visible.push(entry)
+        if (visible.length >= MAX_VISIBLE_ENTRIES) break
+      }
+    }
+    return visible
+  }, [dictionary, searchQuery])
 
   const updateSetting = (key: string, value: any) => {
     window.electron.ipcRenderer.invoke('update-setting', key, value)
@@ -26,23 +70,33 @@ function DictionaryView(): React.JSX.Element {
   const addEntry = () => {
     if (!newTerm.trim() || !newReplacement.trim()) return
 
-    const entry: DictionaryEntry = {
-      id: Date.now().toString(),
-      term: newTerm.trim(),
-      replacement: newReplacement.trim()
-    }
-
-    const updated = [...dictionaryEntries, entry]
-    setDictionaryEntries(updated)
-    updateSetting('dictionaryEntries', updated)
+    // The list updates from the dictionary subscription
+    window.electron.ipcRenderer.invoke('dictionary-add', newTerm.trim(), newReplacement.trim())
     setNewTerm('')
     setNewReplacement('')
   }
 
-  const removeEntry = (id: string) => {
-    const updated = dictionaryEntries.filter((e) => e.id !== id)
-    setDictionaryEntries(updated)
-    updateSetting('dictionaryEntries', updated)
+  const removeEntry = (key: string) => {
+    window.electron.ipcRenderer.invoke('dictionary-delete', key)
+  }
+
+  const importEntries = async () => {
+    setIsImporting(true)
+    setImportStatus(null)
+    try {
+      const result = await window.electron.ipcRenderer.invoke('dictionary-import')
+      if (!result) return
+      if (result.success) {
+        setImportStatus(
+          `Imported ${result.added} new and ${result.updated} updated entries` +
+            (result.skipped > 0 ? ` (${result.skipped} rows skipped)` : '')
+        )
+      } else {
+        setImportStatus(`Import failed: ${result.error}`)
+      }
+    } finally {
+      setIsImporting(false)
+    }
   }
 
   return (
@@ -56,7 +110,22 @@ function DictionaryView(): React.JSX.Element {
         <div className="space-y-8">
           {/* Dictionary Entries */}
           <div className="space-y-3">
-            <label className="block text-sm font-medium text-zinc-700">Dictionary Entries</label>
+            <div className="flex items-center justify-between">
+              <label className="block text-sm font-medium text-zinc-700">
+                Dictionary Entries
+                {dictionary.size > 0 && (
+                  <span className="ml-2 text-xs font-normal text-zinc-400">{dictionary.size}</span>
+                )}
+              </label>
+              <button
+                onClick={importEntries}
+                disabled={isImporting}
+                className="text-xs text-purple-600 hover:text-purple-700 disabled:text-purple-300 font-medium bg-purple-50 px-3 py-1.5 rounded-lg hover:bg-purple-100 transition-colors"
+              >
+                {isImporting ? 'Importing...' : 'Import CSV / TSV'}
+              </button>
+            </div>
+            {importStatus && <p className="text-xs text-zinc-500">{importStatus}</p>}
 
             {/* Add New Entry Form */}
             <div className="bg-purple-50 border border-purple-200 rounded-xl p-4 space-y-3">
@@ -102,11 +171,21 @@ function DictionaryView(): React.JSX.Element {
             </div>
 
             {/* Dictionary Entries List */}
-            {dictionaryEntries.length > 0 ? (
+            {dictionary.size > MAX_VISIBLE_ENTRIES && (
+              <input
+                type="text"
+                value={searchQuery}
+                onChange={(e) => setSearchQuery(e.target.value)}
+                placeholder={`Search ${dictionary.size} entries...`}
+                className="w-full mt-4 bg-white border border-zinc-200 rounded-lg px-3 py-2 text-sm focus:outline-none focus:border-purple-500 focus:ring-1 focus:ring-purple-500 transition-all"
+              />
+            )}
+
+            {dictionary.size > 0 ? (
               <div className="space-y-2 mt-4">
-                {dictionaryEntries.map((entry) => (
+                {visibleEntries.map((entry) => (
                   <div
-                    key={entry.id}
+                    key={entry.key}
                     className="flex items-center justify-between bg-white border border-zinc-200 rounded-lg px-4 py-3 hover:border-zinc-300 transition-colors group"
                   >
                     <div className="flex items-center gap-4 flex-1">
@@ -121,13 +200,18 @@ function DictionaryView(): React.JSX.Element {
                       </div>
                     </div>
                     <button
-                      onClick={() => removeEntry(entry.id)}
+                      onClick={() => removeEntry(entry.key)}
                       className="opacity-0 group-hover:opacity-100 text-red-500 hover:text-red-700 transition-all text-sm font-medium ml-4"
                     >
                       Remove
                     </button>
                   </div>
                 ))}
+                {visibleEntries.length === MAX_VISIBLE_ENTRIES && (
+                  <p className="text-center text-xs text-zinc-400 py-2">
+                    Showing the first {MAX_VISIBLE_ENTRIES} entries - search to find others
+                  </p>
+                )}
               </div>
             ) : (
               <div className="text-center py-8 text-zinc-400 text-sm">
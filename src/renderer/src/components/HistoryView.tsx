@@ -1,4 +1,5 @@
 import React, { useEffect, useState, useRef } from 'react'
+import { useStoreSubscription } from '../hooks/useStoreSubscription'
 
 interface HistoryItem {
   id: string
@@ -8,6 +9,11 @@ interface HistoryItem {
   wpm: number
 }
 
+type HistoryChange = { op: 'add'; item: HistoryItem } | { op: 'delete'; id: string }
+
+// Matches MAX_HISTORY_ENTRIES in src/main/history.ts
+const MAX_HISTORY_ENTRIES = 1000
+
 interface Stats {
   totalWords: number
   weeklyWords: number
@@ -21,17 +27,29 @@ function HistoryView(): React.JSX.Element {
   const [copiedId, setCopiedId] = useState<string | null>(null)
   const menuRef = useRef<HTMLDivElement>(null)
 
-  useEffect(() => {
-    const loadData = async () => {
-      const historyData = await window.electron.ipcRenderer.invoke('get-history')
-      const statsData = await window.electron.ipcRenderer.invoke('get-stats')
-      setHistory(historyData)
-      setStats(statsData)
+  // Pushed from main only when an entry is added or deleted - no polling
+  useStoreSubscription<HistoryItem[], HistoryChange>('history', {
+    onSnapshot: setHistory,
+    onDelta: (change) => {
+      setHistory((prev) => {
+        switch (change.op) {
+          case 'add':
+            return prev.some((h) => h.id === change.item.id)
+              ? prev
+              : [change.item, ...prev].slice(0, MAX_HISTORY_ENTRIES)
+          case 'delete':
+            return prev.filter((h) => h.id !== change.id)
+        }
+      })
     }
-    loadData()
+  })
 
-    const interval = setInterval(loadData, 5000)
+  useStoreSubscription<Stats, Stats>('stats', {
+    onSnapshot: setStats,
+    onDelta: setStats
+  })
 
+  useEffect(() => {
     // Close menu when clicking outside
     const handleClickOutside = (event: MouseEvent) => {
       if (menuRef.current && !menuRef.current.contains(event.target as Node)) {
@@ -41,7 +59,6 @@ function HistoryView(): React.JSX.Element {
     document.addEventListener('mousedown', handleClickOutside)
 
     return () => {
-      clearInterval(interval)
       document.removeEventListener('mousedown', handleClickOutside)
     }
   }, [])
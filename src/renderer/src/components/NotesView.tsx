@@ -1,5 +1,6 @@
 import React, { useEffect, useState } from 'react'
 import { useRecorder } from '../hooks/useRecorder'
+import { useStoreSubscription } from '../hooks/useStoreSubscription'
 
 interface NoteItem {
   id: string
@@ -7,6 +8,11 @@ interface NoteItem {
   timestamp: number
 }
 
+type NotesChange =
+  | { op: 'add'; item: NoteItem }
+  | { op: 'update'; item: NoteItem }
+  | { op: 'delete'; id: string }
+
 function NotesView(): React.JSX.Element {
   const [notes, setNotes] = useState<NoteItem[]>([])
   const [inputValue, setInputValue] = useState('')
@@ -24,11 +30,32 @@ function NotesView(): React.JSX.Element {
   // Recording State
   const { isRecording, startRecording, stopRecording } = useRecorder()
   const [isTranscribing, setIsTranscribing] = useState(false)
+  // Speaker labels need decoded PCM (the native Opus decoder)
+  const [speakerLabels, setSpeakerLabels] = useState(true)
 
   useEffect(() => {
-    loadNotes()
+    window.electron.ipcRenderer
+      .invoke('get-native-capabilities')
+      .then((capabilities) => setSpeakerLabels(capabilities.opus))
   }, [])
 
+  // Snapshot once, then apply pushed changes (no full reload after each edit)
+  useStoreSubscription<NoteItem[], NotesChange>('notes', {
+    onSnapshot: setNotes,
+    onDelta: (change) => {
+      setNotes((prev) => {
+        switch (change.op) {
+          case 'add':
+            return prev.some((n) => n.id === change.item.id) ? prev : [change.item, ...prev]
+          case 'update':
+            return prev.map((n) => (n.id === change.item.id ? change.item : n))
+          case 'delete':
+            return prev.filter((n) => n.id !== change.id)
+        }
+      })
+    }
+  })
+
   const toggleRecording = async () => {
       if (isRecording) {
           const blob = await stopRecording()
@@ -38,7 +65,9 @@ function NotesView(): React.JSX.Element {
                   const buffer = await blob.arrayBuffer()
                   const text = await window.electron.ipcRenderer.invoke('transcribe-buffer', buffer)
                   if (text) {
-                      setInputValue(prev => prev + (prev ? ' ' : '') + text)
+                      // Speaker-labeled transcripts come as paragraphs; keep them apart
+                      const separator = text.includes('\n') ? '\n\n' : ' '
+                      setInputValue(prev => prev + (prev ? separator : '') + text)
                   }
               } catch (error) {
                   console.error("Transcription failed", error)
@@ -51,25 +80,18 @@ function NotesView(): React.JSX.Element {
       }
   }
 
-  const loadNotes = async () => {
-    const data = await window.electron.ipcRenderer.invoke('get-notes')
-    setNotes(data)
-  }
-
   const handleKeyDown = async (e: React.KeyboardEvent<HTMLTextAreaElement>) => {
     if (e.key === 'Enter' && !e.shiftKey) {
       e.preventDefault()
       if (inputValue.trim()) {
         await window.electron.ipcRenderer.invoke('add-note', inputValue)
         setInputValue('')
-        loadNotes()
       }
     }
   }
 
   const handleDelete = async (id: string) => {
     await window.electron.ipcRenderer.invoke('delete-note', id)
-    loadNotes()
   }
 
   const startEditing = (note: NoteItem) => {
@@ -87,7 +109,6 @@ function NotesView(): React.JSX.Element {
         await window.electron.ipcRenderer.invoke('update-note', id, editContent)
         setEditingId(null)
         setEditContent('')
-        loadNotes()
     }
   }
 
@@ -126,6 +147,7 @@ function NotesView(): React.JSX.Element {
           <button 
             onClick={toggleRecording}
             disabled={isTranscribing}
+            title={speakerLabels ? 'Dictate a note' : 'Dictate a note (speaker labels need the native audio decoder)'}
             className={`absolute right-4 bottom-4 p-3 rounded-full transition-all text-white ${isRecording ? 'bg-red-500 hover:bg-red-600 animate-pulse' : isTranscribing ? 'bg-blue-500 cursor-wait' : 'bg-zinc-800 hover:bg-zinc-700'}`}
           >
             {isTranscribing ? (
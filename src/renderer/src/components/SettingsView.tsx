@@ -1,4 +1,6 @@
 import React, { useEffect, useState } from 'react'
+import { useStoreSubscription } from '../hooks/useStoreSubscription'
+import DiagnosticsPanel from './DiagnosticsPanel'
 
 function SettingsView(): React.JSX.Element {
   const [startOnLogin, setStartOnLogin] = useState(false)
@@ -32,6 +34,18 @@ function SettingsView(): React.JSX.Element {
   // Transcription mode state
   const [transcriptionMode, setTranscriptionMode] = useState<'cloud' | 'local'>('cloud')
   const [localModel, setLocalModel] = useState<string>('base')
+  const [localEngine, setLocalEngine] = useState<'shared' | 'embedded'>('shared')
+
+  // End-to-end latency target; 0 turns off automatic degradation
+  const [latencyTargetMs, setLatencyTargetMs] = useState<number>(1500)
+
+  // Main-process capture (only offered when the native module supports it)
+  const [captureBackend, setCaptureBackend] = useState<'renderer' | 'native'>('renderer')
+  const [nativeCaptureBackends, setNativeCaptureBackends] = useState<string[]>([])
+
+  // Hands-free activation (needs native capture and a keyword model)
+  const [wakeWord, setWakeWord] = useState(false)
+  const [wakeWordStatus, setWakeWordStatus] = useState({ supported: false, modelFound: false })
 
   // Helper function to update settings
   const updateSetting = (key: string, value: unknown): void => {
@@ -59,16 +73,26 @@ function SettingsView(): React.JSX.Element {
     return map[keycode] || `Key Code: ${keycode}`
   }
 
-  useEffect(() => {
-    window.electron.ipcRenderer.invoke('get-settings').then((settings) => {
-      if (settings.startOnLogin !== undefined) setStartOnLogin(settings.startOnLogin)
-      if (settings.triggerMode) setTriggerMode(settings.triggerMode)
-      if (settings.hotkey) setHotkey(settings.hotkey)
-      if (settings.holdKey) setHoldKey(settings.holdKey)
-      if (settings.transcriptionMode) setTranscriptionMode(settings.transcriptionMode)
-      if (settings.localModel) setLocalModel(settings.localModel)
-    })
+  // Settings can also change from the tray menu - keep the view in sync via deltas
+  const applySettings = (settings: Record<string, any>): void => {
+    if (settings.startOnLogin !== undefined) setStartOnLogin(settings.startOnLogin)
+    if (settings.triggerMode) setTriggerMode(settings.triggerMode)
+    if (settings.hotkey) setHotkey(settings.hotkey)
+    if (settings.holdKey) setHoldKey(settings.holdKey)
+    if (settings.transcriptionMode) setTranscriptionMode(settings.transcriptionMode)
+    if (settings.localModel) setLocalModel(settings.localModel)
+    if (settings.localEngine) setLocalEngine(settings.localEngine)
+    if (settings.captureBackend) setCaptureBackend(settings.captureBackend)
+    if (typeof settings.latencyTargetMs === 'number') setLatencyTargetMs(settings.latencyTargetMs)
+    if (settings.wakeWord !== undefined) setWakeWord(settings.wakeWord)
+  }
+
+  useStoreSubscription<Record<string, any>, { key: string; value: unknown }>('settings', {
+    onSnapshot: applySettings,
+    onDelta: ({ key, value }) => applySettings({ [key]: value })
+  })
 
+  useEffect(() => {
     const handleKeyRecorded = (_: any, keycode: number) => {
       setHoldKey(keycode)
       setIsRecordingHoldKey(false)
@@ -77,6 +101,11 @@ function SettingsView(): React.JSX.Element {
 
     window.electron.ipcRenderer.on('key-recorded', handleKeyRecorded)
 
+    window.electron.ipcRenderer
+      .invoke('get-native-capabilities')
+      .then((capabilities) => setNativeCaptureBackends(capabilities.capture))
+    window.electron.ipcRenderer.invoke('get-wake-word-status').then(setWakeWordStatus)
+
     return () => {
       window.electron.ipcRenderer.removeAllListeners('key-recorded')
     }
@@ -340,7 +369,7 @@ function SettingsView(): React.JSX.Element {
       if (result.success) {
         setKeyMessage({
           type: 'success',
-          text: 'Encryption key imported successfully! Your data will now be decrypted with this key.'
+          text: 'Encryption key imported successfully! Your existing data is being re-encrypted with this key in the background.'
         })
         setTimeout(() => setKeyMessage(null), 5000)
       } else {
@@ -555,11 +584,109 @@ function SettingsView(): React.JSX.Element {
                     Note: Models will be downloaded automatically on first use. Larger models
                     provide better accuracy but take longer to process.
                   </div>
+                  <label className="flex items-start cursor-pointer pt-2">
+                    <input
+                      type="checkbox"
+                      className="mt-1 mr-3"
+                      checked={localEngine === 'shared'}
+                      onChange={(e) => {
+                        const value = e.target.checked ? 'shared' : 'embedded'
+                        setLocalEngine(value)
+                        updateSetting('localEngine', value)
+                      }}
+                    />
+                    <div>
+                      <div className="text-sm font-medium text-zinc-700">Share the loaded model</div>
+                      <div className="text-xs text-zinc-500">
+                        One background service keeps the model in memory for every window and app
+                        instance, and stops after a few minutes without clients.
+                      </div>
+                    </div>
+                  </label>
                 </div>
               )}
             </div>
           </section>
 
+          {/* Responsiveness */}
+          <section className="space-y-6">
+            <h2 className="text-lg font-semibold text-zinc-900 border-b border-zinc-100 pb-2">
+              Responsiveness
+            </h2>
+            <label className="block">
+              <span className="text-sm font-medium text-zinc-700">Latency target:</span>
+              <select
+                className="mt-1 block w-full px-3 py-2 bg-white border border-zinc-300 rounded-md shadow-sm focus:outline-none focus:ring-indigo-500 focus:border-indigo-500"
+                value={latencyTargetMs}
+                onChange={(e) => {
+                  const value = Number(e.target.value)
+                  setLatencyTargetMs(value)
+                  updateSetting('latencyTargetMs', value)
+                }}
+              >
+                <option value={1000}>1 second</option>
+                <option value={1500}>1.5 seconds - Recommended</option>
+                <option value={2500}>2.5 seconds</option>
+                <option value={0}>Off - always full quality</option>
+              </select>
+            </label>
+            <div className="text-xs text-zinc-500">
+              When dictations keep taking longer than this, short texts skip formatting, a
+              smaller local model is used and the recording tail is shortened, until things
+              speed up again.
+            </div>
+          </section>
+
+          {/* Microphone Capture */}
+          {nativeCaptureBackends.length > 0 && (
+            <section className="space-y-6">
+              <h2 className="text-lg font-semibold text-zinc-900 border-b border-zinc-100 pb-2">
+                Microphone Capture
+              </h2>
+              <label className="flex items-start cursor-pointer">
+                <input
+                  type="checkbox"
+                  className="mt-1 mr-3"
+                  checked={captureBackend === 'native'}
+                  onChange={(e) => {
+                    const value = e.target.checked ? 'native' : 'renderer'
+                    setCaptureBackend(value)
+                    updateSetting('captureBackend', value)
+                  }}
+                />
+                <div>
+                  <div className="font-medium text-zinc-900">Low-latency system capture</div>
+                  <div className="text-sm text-zinc-500">
+                    Records directly through {nativeCaptureBackends.join(' / ')} as soon as the
+                    shortcut is pressed, instead of through the pill window.
+                  </div>
+                </div>
+              </label>
+              {wakeWordStatus.supported && (
+                <label className="flex items-start cursor-pointer">
+                  <input
+                    type="checkbox"
+                    className="mt-1 mr-3"
+                    checked={wakeWord}
+                    disabled={!wakeWordStatus.modelFound}
+                    onChange={(e) => {
+                      setWakeWord(e.target.checked)
+                      updateSetting('wakeWord', e.target.checked)
+                    }}
+                  />
+                  <div>
+                    <div className="font-medium text-zinc-900">Start with your voice</div>
+                    <div className="text-sm text-zinc-500">
+                      {wakeWordStatus.modelFound
+                        ? 'Keeps the microphone open and starts a dictation when you say the wake phrase. Recognition runs on this computer; the dictation ends when you stop talking.'
+                        : 'Needs a keyword model (wake-word.kws) in the models folder of the app data directory.'}
+                    </div>
+                  </div>
+                </label>
+              )}
+            </section>
+          )}
+
           {/* Encryption Key Backup */}
           <section className="space-y-6">
             <h2 className="text-lg font-semibold text-zinc-900 border-b border-zinc-100 pb-2">
@@ -607,6 +734,14 @@ function SettingsView(): React.JSX.Element {
               )}
             </div>
           </section>
+
+          {/* Diagnostics */}
+          <section className="space-y-6">
+            <h2 className="text-lg font-semibold text-zinc-900 border-b border-zinc-100 pb-2">
+              Diagnostics
+            </h2>
+            <DiagnosticsPanel />
+          </section>
         </div>
       </div>
     </div>
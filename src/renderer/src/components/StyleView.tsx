@@ -3,6 +3,7 @@ import React, { useEffect, useState } from 'react'
 function StyleView(): React.JSX.Element {
   const [style, setStyle] = useState('smart')
   const [language, setLanguage] = useState('auto')
+  const [formattingRouting, setFormattingRouting] = useState<'auto' | 'large'>('auto')
 
   useEffect(() => {
     window.electron.ipcRenderer.invoke('get-settings').then((settings) => {
@@ -21,6 +22,7 @@ function StyleView(): React.JSX.Element {
         setStyle(currentStyle || 'smart')
       }
       if (settings.language) setLanguage(settings.language)
+      if (settings.formattingRouting) setFormattingRouting(settings.formattingRouting)
     })
   }, [])
 
@@ -77,6 +79,27 @@ function StyleView(): React.JSX.Element {
                 </button>
               ))}
             </div>
+            {style === 'smart' && (
+              <label className="flex items-start cursor-pointer pt-2">
+                <input
+                  type="checkbox"
+                  className="mt-1 mr-3"
+                  checked={formattingRouting === 'auto'}
+                  onChange={(e) => {
+                    const value = e.target.checked ? 'auto' : 'large'
+                    setFormattingRouting(value)
+                    updateSetting('formattingRouting', value)
+                  }}
+                />
+                <div>
+                  <div className="text-sm font-medium text-zinc-900">Fast formatting for short dictations</div>
+                  <div className="text-xs text-zinc-500">
+                    Short, plain sentences use a smaller, quicker model. Long dictations, lists,
+                    emails and custom instructions always use the full model.
+                  </div>
+                </div>
+              </label>
+            )}
           </div>
 
           {/* Language Selector */}
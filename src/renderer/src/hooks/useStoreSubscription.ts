@@ -0,0 +1,81 @@
+import { useEffect, useRef } from 'react'
+
+type StoreAPI = Window['api']
+type StoreTopic = Parameters<StoreAPI['subscribe']>[0]
+
+export interface StoreHandlers<S, D> {
+  onSnapshot: (snapshot: S) => void
+  onDelta: (delta: D) => void
+}
+
+/**
+ * Subscribe to a main-process store for the lifetime of the component
+ * The snapshot arrives once, then only deltas are pushed when the store changes
+ * Deltas are applied in sequence order; a missing sequence number triggers a resync
+ */
+export const useStoreSubscription = <S, D>(topic: StoreTopic, handlers: StoreHandlers<S, D>): void => {
+  // Keep the latest handlers without re-subscribing on every render
+  const handlersRef = useRef(handlers)
+  handlersRef.current = handlers
+
+  useEffect(() => {
+    let subscriptionId: number | null = null
+    let cancelled = false
+    // Sequence of the last applied change, null while waiting for a snapshot
+    let lastSeq: number | null = null
+    // Deltas that race a snapshot are replayed on top of it (deltas are idempotent)
+    let pending: { seq: number; delta: D }[] = []
+
+    const applyDelta = (delta: D, seq: number): void => {
+      if (lastSeq === null) {
+        pending.push({ seq, delta })
+        return
+      }
+      if (seq <= lastSeq) return // Already part of the snapshot
+      if (seq !== lastSeq + 1) {
+        console.warn(`[Store] ${topic} missed changes ${lastSeq + 1}-${seq - 1}, resyncing`)
+        resync()
+        return
+      }
+      lastSeq = seq
+      handlersRef.current.onDelta(delta)
+    }
+
+    const applySnapshot = (seq: number, snapshot: S): void => {
+      if (cancelled) return
+      handlersRef.current.onSnapshot(snapshot)
+      lastSeq = seq
+      const replay = pending.sort((a, b) => a.seq - b.seq)
+      pending = []
+      for (const { seq: deltaSeq, delta } of replay) {
+        applyDelta(delta, deltaSeq)
+        if (lastSeq === null) break // Replay hit a gap and started another resync
+      }
+    }
+
+    const resync = (): void => {
+      lastSeq = null
+      pending = []
+      window.api
+        .snapshot(topic)
+        .then(({ seq, snapshot }) => applySnapshot(seq, snapshot as S))
+        .catch((error) => console.error(`[Store] ${topic} resync failed:`, error))
+    }
+
+    window.api
+      .subscribe(topic, (delta, seq) => applyDelta(delta as D, seq))
+      .then(({ id, seq, snapshot }) => {
+        if (cancelled) {
+          window.api.unsubscribe(id)
+          return
+        }
+        subscriptionId = id
+        applySnapshot(seq, snapshot as S)
+      })
+
+    return (): void => {
+      cancelled = true
+      if (subscriptionId !== null) window.api.unsubscribe(subscriptionId)
+    }
+  }, [topic])
+}
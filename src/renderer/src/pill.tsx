@@ -0,0 +1,11 @@
+import './assets/pill.css'
+
+import { StrictMode } from 'react'
+import { createRoot } from 'react-dom/client'
+import FlowPill from './FlowPill'
+
+createRoot(document.getElementById('root')!).render(
+  <StrictMode>
+    <FlowPill />
+  </StrictMode>
+)
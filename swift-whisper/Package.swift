@@ -18,9 +18,11 @@ let package = Package(
         .package(url: "https://github.com/argmaxinc/WhisperKit.git", from: "0.7.0")
     ],
     targets: [
+        // C shim for shm_open (variadic, so not callable from Swift)
+        .target(name: "CShm"),
         .executableTarget(
             name: "WisprWhisper",
-            dependencies: ["WhisperKit"]
+            dependencies: ["WhisperKit", "CShm"]
         ),
     ]
 )
@@ -0,0 +1,8 @@
+#include "cshm.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+int wispr_shm_open_readonly(const char *name) {
+    return shm_open(name, O_RDONLY);
+}
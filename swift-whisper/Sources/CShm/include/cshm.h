@@ -0,0 +1,7 @@
+#ifndef CSHM_H
+#define CSHM_H
+
+// shm_open is variadic in C and can't be called from Swift directly
+int wispr_shm_open_readonly(const char *name);
+
+#endif
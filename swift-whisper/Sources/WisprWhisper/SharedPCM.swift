@@ -0,0 +1,47 @@
+import Foundation
+import CShm
+
+/// Reads 16-bit mono PCM that the Electron side placed in a POSIX shared-memory
+/// region (see src/main/pcm-slab.ts). Only the descriptor crosses stdin; the region
+/// stays owned by the writer, which reuses the range once we answer the request
+enum SharedPCM {
+    struct Descriptor {
+        let name: String
+        let offset: Int // Bytes
+        let samples: Int
+        let sampleRate: Int
+    }
+
+    static func read(_ descriptor: Descriptor) throws -> [Float] {
+        let fd = wispr_shm_open_readonly(descriptor.name)
+        guard fd >= 0 else {
+            throw error("shm_open(\(descriptor.name)) failed: \(String(cString: strerror(errno)))")
+        }
+        defer { close(fd) }
+
+        var info = stat()
+        let byteCount = descriptor.samples * MemoryLayout<Int16>.size
+        guard fstat(fd, &info) == 0,
+              descriptor.offset >= 0, descriptor.samples > 0,
+              descriptor.offset + byteCount <= Int(info.st_size) else {
+            throw error("PCM descriptor is outside the shared region")
+        }
+
+        let mapLength = descriptor.offset + byteCount
+        guard let base = mmap(nil, mapLength, PROT_READ, MAP_SHARED, fd, 0), base != MAP_FAILED else {
+            throw error("mmap failed: \(String(cString: strerror(errno)))")
+        }
+        defer { munmap(base, mapLength) }
+
+        // WhisperKit takes Float samples in -1...1 - this conversion is the only copy
+        let pcm = UnsafeBufferPointer(
+            start: base.advanced(by: descriptor.offset).assumingMemoryBound(to: Int16.self),
+            count: descriptor.samples
+        )
+        return pcm.map { Float($0) / 32768.0 }
+    }
+
+    private static func error(_ message: String) -> NSError {
+        NSError(domain: "SharedPCM", code: 1, userInfo: [NSLocalizedDescriptionKey: message])
+    }
+}
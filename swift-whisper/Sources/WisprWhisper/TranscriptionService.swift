@@ -125,16 +125,40 @@ public class TranscriptionService {
         // Performance optimizations:
         // - temperatureFallbackCount: 1 (reduce temperature retries for faster processing)
         // - skipSpecialTokens: true (faster decoding)
-        let options = DecodingOptions(
+        let result = try await whisperKit.transcribe(
+            audioPath: audioFilePath,
+            decodeOptions: decodingOptions(language: language)
+        )
+        return try combineSegments(result)
+    }
+
+    /// Transcribe 16kHz mono samples already in memory (shared-memory requests)
+    public func transcribe(audioArray: [Float], language: String? = nil) async throws -> String {
+        guard let whisperKit = whisperKit else {
+            throw NSError(
+                domain: "TranscriptionService",
+                code: 1,
+                userInfo: [NSLocalizedDescriptionKey: "WhisperKit not initialized"]
+            )
+        }
+
+        fputs("[WhisperKit] Transcribing \(audioArray.count) samples from shared memory\n", stderr)
+        let result = try await whisperKit.transcribe(
+            audioArray: audioArray,
+            decodeOptions: decodingOptions(language: language)
+        )
+        return try combineSegments(result)
+    }
+
+    private func decodingOptions(language: String?) -> DecodingOptions {
+        return DecodingOptions(
             language: language,
             temperatureFallbackCount: 1,
             skipSpecialTokens: true
         )
-        let result = try await whisperKit.transcribe(
-            audioPath: audioFilePath,
-            decodeOptions: options
-        )
+    }
 
+    private func combineSegments(_ result: [TranscriptionResult]) throws -> String {
         // Extract text from result - result is array of TranscriptionResult
         guard !result.isEmpty else {
             throw NSError(
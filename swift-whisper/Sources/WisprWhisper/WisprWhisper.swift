@@ -113,8 +113,8 @@ struct WhisperCLI {
 
         print("[WhisperDaemon] Model loaded and ready. Waiting for transcription requests...", to: &standardError)
 
-        // Print ready signal to stdout
-        printJSON(["status": "ready", "model": modelName])
+        // Print ready signal to stdout ("features" lets the app know what requests we take)
+        printJSON(["status": "ready", "model": modelName, "features": ["pcm-shm"]])
 
         // Read from stdin line by line
         while let line = readLine() {
@@ -125,33 +125,62 @@ struct WhisperCLI {
                 break
             }
 
-            // Parse JSON request: {"audioFile": "path", "language": "en"}
+            // Parse JSON request, either
+            //   {"id": "...", "audioFile": "path", "language": "en"}
+            //   {"id": "...", "shm": "/name", "offset": 0, "samples": 16000, "sampleRate": 16000, "language": "en"}
             guard let data = trimmed.data(using: .utf8),
-                  let json = try? JSONSerialization.jsonObject(with: data) as? [String: String],
-                  let audioFile = json["audioFile"] else {
+                  let json = try? JSONSerialization.jsonObject(with: data) as? [String: Any],
+                  json["audioFile"] is String || json["shm"] is String else {
                 printError("Invalid request format. Expected JSON: {\"audioFile\": \"path\", \"language\": \"en\"}")
                 continue
             }
 
-            let language = json["language"]
+            let language = json["language"] as? String
 
-            do {
-                let transcription = try await service.transcribe(
-                    audioFilePath: audioFile,
-                    language: language
-                )
+            // Echo the request identity so the app can match replies to jobs
+            var identity: [String: Any] = [:]
+            if let id = json["id"] { identity["id"] = id }
+            if let audioFile = json["audioFile"] { identity["audioFile"] = audioFile }
 
-                let result: [String: Any] = [
+            do {
+                let transcription: String
+                if let shm = json["shm"] as? String {
+                    let descriptor = SharedPCM.Descriptor(
+                        name: shm,
+                        offset: json["offset"] as? Int ?? 0,
+                        samples: json["samples"] as? Int ?? 0,
+                        sampleRate: json["sampleRate"] as? Int ?? 16000
+                    )
+                    guard descriptor.sampleRate == 16000 else {
+                        throw NSError(
+                            domain: "WhisperDaemon",
+                            code: 1,
+                            userInfo: [NSLocalizedDescriptionKey: "Shared PCM must be 16kHz, got \(descriptor.sampleRate)"]
+                        )
+                    }
+                    transcription = try await service.transcribe(
+                        audioArray: try SharedPCM.read(descriptor),
+                        language: language
+                    )
+                } else {
+                    transcription = try await service.transcribe(
+                        audioFilePath: json["audioFile"] as! String,
+                        language: language
+                    )
+                }
+
+                var result: [String: Any] = [
                     "success": true,
-                    "transcription": transcription,
-                    "audioFile": audioFile
+                    "transcription": transcription
                 ]
+                result.merge(identity) { current, _ in current }
                 printJSON(result)
             } catch {
-                let errorResult: [String: Any] = [
+                var errorResult: [String: Any] = [
                     "success": false,
                     "error": error.localizedDescription
                 ]
+                errorResult.merge(identity) { current, _ in current }
                 printJSON(errorResult)
             }
         }
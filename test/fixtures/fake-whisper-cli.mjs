@@ -0,0 +1,21 @@
+#!/usr/bin/env node
+// Stand-in for `whisper-cli daemon <model>` (whisper-daemon.test.ts)
+// Reports ready straight away and answers each job after JOB_MS with "<model>:<file or region>"
+const JOB_MS = 200
+const model = process.argv[3]
+
+console.log(JSON.stringify({ status: 'ready', model, features: ['pcm-shm'] }))
+
+let pending = ''
+process.stdin.on('data', (data) => {
+  pending += data
+  let newline
+  while ((newline = pending.indexOf('\n')) >= 0) {
+    const line = pending.slice(0, newline)
+    pending = pending.slice(newline + 1)
+    if (line === 'quit') process.exit(0)
+    const job = JSON.parse(line)
+    const transcription = `${model}:${job.audioFile ?? job.shm}`
+    setTimeout(() => console.log(JSON.stringify({ success: true, id: job.id, transcription })), JOB_MS)
+  }
+})
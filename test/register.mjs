@@ -0,0 +1,5 @@
+// Preloaded by `npm test` (node --import) so node:test can run the TypeScript sources
+// directly - see resolve-hooks.mjs
+import { register } from 'node:module'
+
+register('./resolve-hooks.mjs', import.meta.url)
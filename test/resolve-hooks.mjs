@@ -0,0 +1,13 @@
+import { existsSync } from 'node:fs'
+import { fileURLToPath } from 'node:url'
+
+// The sources import their siblings without an extension (electron-vite resolves them
+// when bundling); under plain Node a relative import from a .ts file tries `.ts` first
+export async function resolve(specifier, context, nextResolve) {
+  const relative = specifier.startsWith('./') || specifier.startsWith('../')
+  if (relative && context.parentURL?.endsWith('.ts') && !/\.[cm]?[jt]sx?$/.test(specifier)) {
+    const url = new URL(`${specifier}.ts`, context.parentURL)
+    if (existsSync(fileURLToPath(url))) return nextResolve(url.href, context)
+  }
+  return nextResolve(specifier, context)
+}